@@ -49,6 +49,42 @@
 
 
 static int callbackQueueSize = 2000;
+static int callbackBatchSize = 1;
+
+/* Queue engines, selected by callbackSetQueueEngine() before callbackInit() */
+enum cbEngine_t {
+    cbEngineRing,   /* one locked epicsRingPointer shared by all workers */
+    cbEngineSteal,  /* lock-free queue per worker, idle workers steal */
+};
+
+static int callbackEngine = cbEngineRing;
+static const char * const engineName[] = {"ring", "steal"};
+
+/* Bounded lock-free MPMC queue, one per worker in the "steal" engine.
+ * Each cell carries a sequence number which equals its position while
+ * free, and position+1 once a callback has been published into it.
+ * The capacity is a power of 2 no smaller than callbackQueueSize, and the
+ * total number of queued callbacks is limited to callbackQueueSize by
+ * cbQueueSet.nQueued, so a push never finds its target queue full.
+ */
+typedef struct cbCell {
+    size_t seq;
+    epicsCallback *pcallback;
+} cbCell;
+
+typedef struct cbDeque {
+    size_t head;    /* next position to pop, use atomic */
+    size_t tail;    /* next position to push, use atomic */
+    size_t mask;
+    cbCell *cells;
+} cbDeque;
+
+typedef struct cbWorker {
+    struct cbQueueSet *set;
+    int index;
+    cbDeque deque;  /* only used by the "steal" engine */
+    epicsCallback **batch;  /* only used in batch mode */
+} cbWorker;
 
 typedef struct cbQueueSet {
     epicsEventId semWakeUp;
@@ -59,6 +95,13 @@ typedef struct cbQueueSet {
     int threadsConfigured;
     int threadsRunning;
     epicsThreadId *threads;
+    cbWorker *workers;
+    int steal;      /* engine of this set is cbEngineSteal */
+    int nQueued;    /* "steal" engine: callbacks in all worker queues, use atomic */
+    int maxQueued;  /* "steal" engine: high-water mark of nQueued, use atomic */
+    int nextWorker; /* "steal" engine: round-robin push target, use atomic */
+    int batchSize;  /* batch mode if > 1 */
+    int sleeping;   /* batch mode: workers about to wait, use atomic */
 } cbQueueSet;
 
 static cbQueueSet callbackQueue[NUM_CALLBACK_PRIORITIES];
@@ -95,7 +138,6 @@ static unsigned int threadPriority[NUM_CALLBACK_PRIORITIES] = {
     epicsThreadPriorityScanLow + 4,
     epicsThreadPriorityScanHigh + 1
 };
-static int priorityValue[NUM_CALLBACK_PRIORITIES] = {0, 1, 2};
 
 
 int callbackSetQueueSize(int size)
@@ -108,6 +150,39 @@ int callbackSetQueueSize(int size)
     return 0;
 }
 
+int callbackSetBatchSize(int size)
+{
+    if (epicsAtomicGetIntT(&cbState)!=cbInit) {
+        fprintf(stderr, "Callback system already initialized\n");
+        return -1;
+    }
+    callbackBatchSize = size > 1 ? size : 1;
+    return 0;
+}
+
+int callbackSetQueueEngine(const char *engine)
+{
+    int i;
+
+    if (epicsAtomicGetIntT(&cbState)!=cbInit) {
+        fprintf(stderr, "Callback system already initialized\n");
+        return -1;
+    }
+    if (!engine || !*engine) {
+        callbackEngine = cbEngineRing;
+        return 0;
+    }
+    for (i = 0; i < (int)NELEMENTS(engineName); i++) {
+        if (epicsStrCaseCmp(engine, engineName[i]) == 0) {
+            callbackEngine = i;
+            return 0;
+        }
+    }
+    fprintf(stderr, "callbackSetQueueEngine: "
+        "Unknown engine \"%s\", expected \"ring\" or \"steal\"\n", engine);
+    return -1;
+}
+
 int callbackQueueStatus(const int reset, callbackQueueStats *result)
 {
     int ret;
@@ -116,10 +191,16 @@ int callbackQueueStatus(const int reset, callbackQueueStats *result)
         int prio;
         result->size = callbackQueueSize;
         for(prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
-            epicsRingPointerId qId = callbackQueue[prio].queue;
-            result->numUsed[prio] = epicsRingPointerGetUsed(qId);
-            result->maxUsed[prio] = epicsRingPointerGetHighWaterMark(qId);
-            result->numOverflow[prio] = epicsAtomicGetIntT(&callbackQueue[prio].queueOverflows);
+            cbQueueSet *mySet = &callbackQueue[prio];
+            if (mySet->steal) {
+                result->numUsed[prio] = epicsAtomicGetIntT(&mySet->nQueued);
+                result->maxUsed[prio] = epicsAtomicGetIntT(&mySet->maxQueued);
+            } else {
+                epicsRingPointerId qId = mySet->queue;
+                result->numUsed[prio] = epicsRingPointerGetUsed(qId);
+                result->maxUsed[prio] = epicsRingPointerGetHighWaterMark(qId);
+            }
+            result->numOverflow[prio] = epicsAtomicGetIntT(&mySet->queueOverflows);
         }
         ret = 0;
     } else {
@@ -128,7 +209,12 @@ int callbackQueueStatus(const int reset, callbackQueueStats *result)
     if (reset) {
         int prio;
         for(prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
-            epicsRingPointerResetHighWaterMark(callbackQueue[prio].queue);
+            cbQueueSet *mySet = &callbackQueue[prio];
+            if (mySet->steal)
+                epicsAtomicSetIntT(&mySet->maxQueued,
+                    epicsAtomicGetIntT(&mySet->nQueued));
+            else
+                epicsRingPointerResetHighWaterMark(mySet->queue);
         }
     }
     return ret;
@@ -203,25 +289,174 @@ found:
     return 0;
 }
 
+static int cbDequeInit(cbDeque *pdeque, int size)
+{
+    size_t capacity = 2;
+    size_t i;
+
+    while (capacity < (size_t)size)
+        capacity <<= 1;
+    pdeque->cells = calloc(capacity, sizeof(*pdeque->cells));
+    if (!pdeque->cells)
+        return -1;
+    for (i = 0; i < capacity; i++)
+        pdeque->cells[i].seq = i;
+    pdeque->mask = capacity - 1;
+    pdeque->head = pdeque->tail = 0;
+    return 0;
+}
+
+/* May be called from interrupt context */
+static int cbDequePush(cbDeque *pdeque, epicsCallback *pcallback)
+{
+    size_t pos = epicsAtomicGetSizeT(&pdeque->tail);
+
+    for (;;) {
+        cbCell *pcell = &pdeque->cells[pos & pdeque->mask];
+        size_t seq = epicsAtomicGetSizeT(&pcell->seq);
+        ptrdiff_t diff = (ptrdiff_t)(seq - pos);
+
+        if (diff == 0) {
+            size_t old = epicsAtomicCmpAndSwapSizeT(&pdeque->tail, pos, pos + 1);
+            if (old == pos) {
+                pcell->pcallback = pcallback;
+                epicsAtomicWriteMemoryBarrier();
+                epicsAtomicSetSizeT(&pcell->seq, pos + 1);
+                return 1;
+            }
+            pos = old;
+        } else if (diff < 0) {
+            return 0;   /* full */
+        } else {
+            pos = epicsAtomicGetSizeT(&pdeque->tail);
+        }
+    }
+}
+
+static epicsCallback* cbDequePop(cbDeque *pdeque)
+{
+    size_t pos = epicsAtomicGetSizeT(&pdeque->head);
+
+    for (;;) {
+        cbCell *pcell = &pdeque->cells[pos & pdeque->mask];
+        size_t seq = epicsAtomicGetSizeT(&pcell->seq);
+        ptrdiff_t diff = (ptrdiff_t)(seq - (pos + 1));
+
+        if (diff == 0) {
+            size_t old = epicsAtomicCmpAndSwapSizeT(&pdeque->head, pos, pos + 1);
+            if (old == pos) {
+                epicsCallback *pcallback = pcell->pcallback;
+                epicsAtomicWriteMemoryBarrier();
+                epicsAtomicSetSizeT(&pcell->seq, pos + pdeque->mask + 1);
+                return pcallback;
+            }
+            pos = old;
+        } else if (diff < 0) {
+            return NULL;    /* empty */
+        } else {
+            pos = epicsAtomicGetSizeT(&pdeque->head);
+        }
+    }
+}
+
+/* Take from our own queue first, then steal from the other workers */
+static epicsCallback* cbWorkerTake(cbWorker *self)
+{
+    cbQueueSet *mySet = self->set;
+    int n = mySet->threadsConfigured;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        cbWorker *victim = &mySet->workers[(self->index + i) % n];
+        epicsCallback *pcallback = cbDequePop(&victim->deque);
+
+        if (pcallback) {
+            epicsAtomicDecrIntT(&mySet->nQueued);
+            return pcallback;
+        }
+    }
+    return NULL;
+}
+
+static epicsCallback* cbTake(cbWorker *self)
+{
+    cbQueueSet *mySet = self->set;
+
+    if (mySet->steal)
+        return cbWorkerTake(self);
+    return (epicsCallback *)epicsRingPointerPop(mySet->queue);
+}
+
+static int cbIsEmpty(cbQueueSet *mySet)
+{
+    if (mySet->steal)
+        return epicsAtomicGetIntT(&mySet->nQueued) <= 0;
+    return epicsRingPointerIsEmpty(mySet->queue);
+}
+
+/* Batch mode: take up to batchSize callbacks per wake-up and run them.
+ * A worker announces itself in mySet->sleeping before checking the queue
+ * one last time and waiting, which lets callbackRequest() skip signalling
+ * semWakeUp while all workers are busy.
+ */
+static void cbRunBatch(cbWorker *self)
+{
+    cbQueueSet *mySet = self->set;
+    int n = 0;
+    int i;
+
+    while (n < mySet->batchSize && (self->batch[n] = cbTake(self)))
+        n++;
+
+    if (n == 0) {
+        epicsAtomicIncrIntT(&mySet->sleeping);
+        if (cbIsEmpty(mySet))
+            epicsEventMustWait(mySet->semWakeUp);
+        epicsAtomicDecrIntT(&mySet->sleeping);
+        return;
+    }
+
+    if (!cbIsEmpty(mySet) && epicsAtomicGetIntT(&mySet->sleeping))
+        epicsEventMustTrigger(mySet->semWakeUp);
+    mySet->queueOverflow = FALSE;
+    for (i = 0; i < n; i++)
+        (*self->batch[i]->callback)(self->batch[i]);
+}
+
 static void callbackTask(void *arg)
 {
-    int prio = *(int*)arg;
-    cbQueueSet *mySet = &callbackQueue[prio];
+    cbWorker *self = (cbWorker*)arg;
+    cbQueueSet *mySet = self->set;
 
     taskwdInsert(0, NULL, NULL);
     epicsEventSignal(startStopEvent);
 
     while(!epicsAtomicGetIntT(&mySet->shutdown)) {
-        void *ptr;
-        if (epicsRingPointerIsEmpty(mySet->queue))
-            epicsEventMustWait(mySet->semWakeUp);
-
-        while ((ptr = epicsRingPointerPop(mySet->queue))) {
-            epicsCallback *pcallback = (epicsCallback *)ptr;
-            if(!epicsRingPointerIsEmpty(mySet->queue))
+        if (mySet->batchSize > 1) {
+            cbRunBatch(self);
+        } else if (mySet->steal) {
+            epicsCallback *pcallback = cbWorkerTake(self);
+
+            if (!pcallback) {
+                epicsEventMustWait(mySet->semWakeUp);
+                continue;
+            }
+            if (epicsAtomicGetIntT(&mySet->nQueued) > 0)
                 epicsEventMustTrigger(mySet->semWakeUp);
             mySet->queueOverflow = FALSE;
             (*pcallback->callback)(pcallback);
+        } else {
+            void *ptr;
+            if (epicsRingPointerIsEmpty(mySet->queue))
+                epicsEventMustWait(mySet->semWakeUp);
+
+            while ((ptr = epicsRingPointerPop(mySet->queue))) {
+                epicsCallback *pcallback = (epicsCallback *)ptr;
+                if(!epicsRingPointerIsEmpty(mySet->queue))
+                    epicsEventMustTrigger(mySet->semWakeUp);
+                mySet->queueOverflow = FALSE;
+                (*pcallback->callback)(pcallback);
+            }
         }
     }
 
@@ -265,12 +500,20 @@ void callbackCleanup(void)
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
         cbQueueSet *mySet = &callbackQueue[i];
+        int j;
 
         assert(epicsAtomicGetIntT(&mySet->threadsRunning)==0);
         epicsEventDestroy(mySet->semWakeUp);
         mySet->semWakeUp = NULL;
-        epicsRingPointerDelete(mySet->queue);
+        if (mySet->queue)
+            epicsRingPointerDelete(mySet->queue);
         mySet->queue = NULL;
+        for (j = 0; mySet->workers && j < mySet->threadsConfigured; j++) {
+            free(mySet->workers[j].deque.cells);
+            free(mySet->workers[j].batch);
+        }
+        free(mySet->workers);
+        mySet->workers = NULL;
         free(mySet->threads);
         mySet->threads = NULL;
     }
@@ -299,10 +542,6 @@ void callbackInit(void)
         epicsThreadId tid;
 
         callbackQueue[i].semWakeUp = epicsEventMustCreate(epicsEventEmpty);
-        callbackQueue[i].queue = epicsRingPointerLockedCreate(callbackQueueSize);
-        if (callbackQueue[i].queue == 0)
-            cantProceed("epicsRingPointerLockedCreate failed for %s\n",
-                threadNamePrefix[i]);
         callbackQueue[i].queueOverflow = FALSE;
 
         if (callbackQueue[i].threadsConfigured == 0)
@@ -311,6 +550,31 @@ void callbackInit(void)
         callbackQueue[i].threads = callocMustSucceed(callbackQueue[i].threadsConfigured,
                                                      sizeof(*callbackQueue[i].threads),
                                                      "callbackInit");
+        callbackQueue[i].workers = callocMustSucceed(callbackQueue[i].threadsConfigured,
+                                                     sizeof(*callbackQueue[i].workers),
+                                                     "callbackInit");
+        for (j = 0; j < callbackQueue[i].threadsConfigured; j++) {
+            cbWorker *pworker = &callbackQueue[i].workers[j];
+            pworker->set = &callbackQueue[i];
+            pworker->index = j;
+            if (callbackBatchSize > 1)
+                pworker->batch = callocMustSucceed(callbackBatchSize,
+                    sizeof(*pworker->batch), "callbackInit");
+            if (callbackEngine == cbEngineSteal &&
+                cbDequeInit(&pworker->deque, callbackQueueSize))
+                cantProceed("Failed to allocate callback queue for %s\n",
+                    threadNamePrefix[i]);
+        }
+
+        callbackQueue[i].batchSize = callbackBatchSize;
+        if (callbackEngine == cbEngineSteal) {
+            callbackQueue[i].steal = TRUE;
+        } else {
+            callbackQueue[i].queue = epicsRingPointerLockedCreate(callbackQueueSize);
+            if (callbackQueue[i].queue == 0)
+                cantProceed("epicsRingPointerLockedCreate failed for %s\n",
+                    threadNamePrefix[i]);
+        }
 
         for (j = 0; j < callbackQueue[i].threadsConfigured; j++) {
             epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
@@ -322,7 +586,7 @@ void callbackInit(void)
             else
                 strcpy(threadName, threadNamePrefix[i]);
             callbackQueue[i].threads[j] = tid = epicsThreadCreateOpt(threadName,
-                (EPICSTHREADFUNC)callbackTask, &priorityValue[i], &opts);
+                (EPICSTHREADFUNC)callbackTask, &callbackQueue[i].workers[j], &opts);
             if (tid == 0) {
                 cantProceed("Failed to spawn callback thread %s\n", threadName);
             } else {
@@ -354,13 +618,35 @@ int callbackRequest(epicsCallback *pcallback)
         return S_db_badChoice;
     }
     mySet = &callbackQueue[priority];
-    if (!mySet->queue) {
+    if (mySet->steal ? !mySet->workers : !mySet->queue) {
         epicsInterruptContextMessage("callbackRequest: " ERL_ERROR " Callbacks not initialized\n");
         return S_db_notInit;
     }
     if (mySet->queueOverflow) return S_db_bufFull;
 
-    pushOK = epicsRingPointerPush(mySet->queue, pcallback);
+    if (mySet->steal) {
+        int nQueued = epicsAtomicIncrIntT(&mySet->nQueued);
+
+        pushOK = nQueued <= callbackQueueSize;
+        if (pushOK) {
+            int n = mySet->threadsConfigured;
+            unsigned next = (unsigned)epicsAtomicIncrIntT(&mySet->nextWorker);
+            int maxQueued;
+            int i;
+
+            for (i = 0, pushOK = 0; i < n && !pushOK; i++)
+                pushOK = cbDequePush(&mySet->workers[(next + i) % n].deque,
+                    pcallback);
+
+            while ((maxQueued = epicsAtomicGetIntT(&mySet->maxQueued)) < nQueued &&
+                epicsAtomicCmpAndSwapIntT(&mySet->maxQueued, maxQueued,
+                    nQueued) != maxQueued);
+        }
+        if (!pushOK)
+            epicsAtomicDecrIntT(&mySet->nQueued);
+    } else {
+        pushOK = epicsRingPointerPush(mySet->queue, pcallback);
+    }
 
     if (!pushOK) {
         epicsInterruptContextMessage(fullMessage[priority]);
@@ -368,6 +654,12 @@ int callbackRequest(epicsCallback *pcallback)
         epicsAtomicIncrIntT(&mySet->queueOverflows);
         return S_db_bufFull;
     }
+    /* In batch mode an awake worker will find this request before it
+     * sleeps.  The atomic add is a full barrier, ordering the push above
+     * before the read of the sleeper count.
+     */
+    if (mySet->batchSize > 1 && !epicsAtomicAddIntT(&mySet->sleeping, 0))
+        return 0;
     epicsEventSignal(mySet->semWakeUp);
     return 0;
 }
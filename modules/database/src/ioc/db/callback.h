@@ -83,6 +83,8 @@ DBCORE_API void callbackCancelDelayed(epicsCallback *pcallback);
 DBCORE_API void callbackRequestProcessCallbackDelayed(
     epicsCallback *pCallback, int Priority, void *pRec, double seconds);
 DBCORE_API int callbackSetQueueSize(int size);
+DBCORE_API int callbackSetQueueEngine(const char *engine);
+DBCORE_API int callbackSetBatchSize(int size);
 DBCORE_API int callbackQueueStatus(const int reset, callbackQueueStats *result);
 DBCORE_API void callbackQueueShow(const int reset);
 DBCORE_API int callbackParallelThreads(int count, const char *prio);
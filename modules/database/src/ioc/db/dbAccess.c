@@ -18,6 +18,8 @@
  *                       Ralph Lange <Ralph.Lange@bessy.de>
  */
 
+#define EPICS_PRIVATE_API
+
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -41,8 +43,10 @@
 #include "dbAddr.h"
 #include "dbBase.h"
 #include "dbBkpt.h"
+#include "dbChannel.h"
 #include "dbCommonPvt.h"
 #include "dbConvertFast.h"
+#include "dbConvertFastPvt.h"
 #include "dbConvert.h"
 #include "dbEvent.h"
 #include "db_field_log.h"
@@ -604,8 +608,10 @@ long dbProcess(dbCommon *precord)
     if (*ptrace)
         printf("%s: dbProcess of '%s'\n", context, precord->name);
 
-    /* process record */
+    /* process record, collecting its monitor posts if enabled */
+    db_post_batch_begin(precord);
     status = prset->process(precord);
+    db_post_batch_end(precord);
 
     /* Print record's fields if PRINT_MASK set in breakpoint field */
     if (lset_stack_count != 0) {
@@ -661,14 +667,7 @@ long dbNameToAddr(const char *pname, DBADDR *paddr)
     if (!pname || !*pname || !pdbbase)
         return S_db_notFound;
 
-    dbInitEntry(pdbbase, &dbEntry);
-    status = dbFindRecordPart(&dbEntry, &pname);
-    if (status) goto finish;
-
-    if (*pname == '.') ++pname;
-    status = dbFindFieldPart(&dbEntry, &pname);
-    if (status == S_dbLib_fieldNotFound)
-        status = dbGetAttributePart(&dbEntry, &pname);
+    status = dbChannelNameLookup(&dbEntry, &pname);
     if (status) goto finish;
 
     status = dbEntryToAddr(&dbEntry, paddr);
@@ -890,12 +889,49 @@ static long getAttrValue(DBADDR *paddr, short dbrType,
     return 0;
 }
 
+typedef struct {
+    DBADDR *paddr;
+    short dbrType;
+    void *pbuffer;
+    long *options;
+    long *nRequest;
+    long optionsIn;
+    long nRequestIn;
+} getFieldArgs;
+
+/* dbScanLockRead() callback, may be repeated */
+static long getFieldRead(void *raw)
+{
+    getFieldArgs *pargs = raw;
+
+    if (pargs->options)
+        *pargs->options = pargs->optionsIn;
+    if (pargs->nRequest)
+        *pargs->nRequest = pargs->nRequestIn;
+    return dbGet(pargs->paddr, pargs->dbrType, pargs->pbuffer,
+        pargs->options, pargs->nRequest, NULL);
+}
+
 long dbGetField(DBADDR *paddr,short dbrType,
     void *pbuffer, long *options, long *nRequest, void *pflin)
 {
     dbCommon *precord = paddr->precord;
     long status = 0;
 
+    if (dbLockCanReadOptimistic(paddr, dbrType, options ? *options : 0,
+            pflin)) {
+        getFieldArgs args;
+
+        args.paddr = paddr;
+        args.dbrType = dbrType;
+        args.pbuffer = pbuffer;
+        args.options = options;
+        args.nRequest = nRequest;
+        args.optionsIn = options ? *options : 0;
+        args.nRequestIn = nRequest ? *nRequest : 0;
+        return dbScanLockRead(precord, &getFieldRead, &args);
+    }
+
     dbScanLock(precord);
     status = dbGet(paddr, dbrType, pbuffer, options, nRequest, pflin);
     dbScanUnlock(precord);
@@ -967,8 +1003,8 @@ long dbGet(DBADDR *paddr, short dbrType,
         }
 
         if (!dbfl_has_copy(pfl)) {
-            status = dbFastGetConvertRoutine[field_type][dbrType]
-                (paddr->pfield, pbuf, paddr);
+            status = dbFastGetConvert(field_type, dbrType,
+                paddr->pfield, pbuf, paddr);
         } else {
             DBADDR localAddr = *paddr; /* Structure copy */
 
@@ -982,8 +1018,8 @@ long dbGet(DBADDR *paddr, short dbrType,
             /* not used by dbFastConvert: */
             localAddr.no_elements = pfl->no_elements;
             localAddr.pfield = dbfl_pfield(pfl);
-            status = dbFastGetConvertRoutine[field_type][dbrType]
-                (localAddr.pfield, pbuf, &localAddr);
+            status = dbFastGetConvert(field_type, dbrType,
+                localAddr.pfield, pbuf, &localAddr);
         }
     } else {
         long n;
@@ -1366,7 +1402,7 @@ long dbPut(DBADDR *paddr, short dbrType,
         if (nRequest < 1) {
             recGblSetSevr(precord, LINK_ALARM, INVALID_ALARM);
         } else {
-            status = dbFastPutConvertRoutine[dbrType][field_type](pbuffer,
+            status = dbFastPutConvert(dbrType, field_type, pbuffer,
                 paddr->pfield, paddr);
             nRequest = 1;
         }
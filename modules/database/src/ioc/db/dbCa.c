@@ -25,8 +25,10 @@
 #include "epicsAssert.h"
 #include "epicsEvent.h"
 #include "epicsExit.h"
+#include "epicsExport.h"
 #include "epicsMutex.h"
 #include "epicsPrint.h"
+#include "epicsStdio.h"
 #include "epicsString.h"
 #include "epicsThread.h"
 #include "epicsAtomic.h"
@@ -61,19 +63,51 @@
 extern void dbServiceIOInit();
 extern int dbServiceIsolate;
 
-static ELLLIST workList = ELLLIST_INIT;    /* Work list for dbCaTask */
-static epicsMutexId workListLock; /*Mutual exclusions semaphores for workList*/
-static epicsEventId workListEvent; /*wakeup event for dbCaTask*/
-static int removesOutstanding = 0;
+/* Each dbCaTask worker has its own CA client context and work list.
+ * CA links are assigned to a worker by a hash of their PV name.
+ */
+typedef struct dbCaWorker {
+    ELLLIST         workList;       /* Work list for dbCaTask */
+    epicsMutexId    workListLock;   /* Guards workList */
+    epicsEventId    workListEvent;  /* wakeup event for dbCaTask */
+    epicsEventId    startStopEvent;
+    epicsThreadId   tid;
+    struct ca_client_context *context;
+    int             removesOutstanding;
+    int             chanCount;
+    /* The following are for batching, see below */
+    epicsUInt64     batchStart;     /* guarded by workListLock */
+    unsigned long   batchActions;
+    size_t          batchBytes;
+    dbCaFlushStats  flushStats;     /* guarded by workListLock */
+} dbCaWorker;
+
+int dbCaWorkers = 1;
+epicsExportAddress(int, dbCaWorkers);
+#define dbCaWorkersMax 64
+
+static dbCaWorker *workers;
+static int nWorkers;
 #define removesOutstandingWarning 10000
 
+/* Batching of CA requests.  With dbCaFlushDelay > 0 dbCaTask holds the
+ * requests it has issued for up to that many microseconds after the first
+ * of them was queued, or until about dbCaFlushBytes have accumulated,
+ * before calling ca_flush_io().  libca still sends any circuit whose
+ * buffer fills up.
+ */
+int dbCaFlushDelay = 0;
+epicsExportAddress(int, dbCaFlushDelay);
+int dbCaFlushBytes = 0;
+epicsExportAddress(int, dbCaFlushBytes);
+
+#define CA_MSG_HEADER_SIZE 16 /* sizeof(caHdr) */
+
 static volatile enum dbCaCtl_t {
     ctlInit, ctlRun, ctlPause, ctlExit
 } dbCaCtl;
-static epicsEventId startStopEvent;
-static epicsThreadId dbCaWorker;
 
-struct ca_client_context * dbCaClientContext;
+struct ca_client_context * dbCaClientContext; /* of the first worker */
 
 /* Forward declarations */
 static void dbCaTask(void *);
@@ -84,15 +118,13 @@ static lset dbCa_lset;
     errlogPrintf("%s has DB CA link to %s\n",\
         pcaLink->plink->precord->name, pcaLink->pvname)
 
-static int dbca_chan_count;
-
 /* caLink locking
  *
  * Lock ordering:
  *  dbScanLock -> caLink.lock -> workListLock
  *
  * workListLock:
- *   Guards access to workList.
+ *   Guards access to the workList of one worker.
  *
  * dbScanLock:
  *   All dbCa* functions operating on a single link may only be called when
@@ -110,12 +142,12 @@ static int dbca_chan_count;
  * caLink.lock:
  *   Guards the caLink structure (but not the struct DBLINK)
  *
- * The dbCaTask only locks caLink, and must not lock the record (a violation of lock order).
+ * A dbCaTask only locks caLink, and must not lock the record (a violation of lock order).
  *
  * During link modification or IOC shutdown the pca->plink pointer (guarded by caLink.lock)
  * is used as a flag to indicate that a link is no longer active.
  *
- * References to the struct caLink are owned by the dbCaTask, and any scanOnceCallback()
+ * References to the struct caLink are owned by its dbCaTask, and any scanOnceCallback()
  * which is in progress.
  *
  * The libca and scanOnceCallback callbacks take no action if pca->plink==NULL.
@@ -130,9 +162,10 @@ static int dbca_chan_count;
 
 static void addAction(caLink *pca, short link_action)
 {
+    dbCaWorker *pw = pca->worker;
     int callAdd;
 
-    epicsMutexMustLock(workListLock);
+    epicsMutexMustLock(pw->workListLock);
     callAdd = (pca->link_action == 0);
     if (pca->link_action & CA_CLEAR_CHANNEL) {
         errlogPrintf("dbCa::addAction %d with CA_CLEAR_CHANNEL set\n",
@@ -141,22 +174,118 @@ static void addAction(caLink *pca, short link_action)
         link_action = 0;
     }
     if (link_action & CA_CLEAR_CHANNEL) {
-        if (++removesOutstanding >= removesOutstandingWarning) {
+        if (++pw->removesOutstanding >= removesOutstandingWarning) {
             errlogPrintf("dbCa::addAction pausing, %d channels to clear\n",
-                removesOutstanding);
+                pw->removesOutstanding);
         }
-        while (removesOutstanding >= removesOutstandingWarning) {
-            epicsMutexUnlock(workListLock);
+        while (pw->removesOutstanding >= removesOutstandingWarning) {
+            epicsMutexUnlock(pw->workListLock);
             epicsThreadSleep(1.0);
-            epicsMutexMustLock(workListLock);
+            epicsMutexMustLock(pw->workListLock);
         }
     }
     pca->link_action |= link_action;
     if (callAdd)
-        ellAdd(&workList, &pca->node);
-    epicsMutexUnlock(workListLock);
+        ellAdd(&pw->workList, &pca->node);
+    if (!pw->batchStart)
+        pw->batchStart = epicsMonotonicGet();
+    epicsMutexUnlock(pw->workListLock);
     if (callAdd)
-        epicsEventSignal(workListEvent);
+        epicsEventSignal(pw->workListEvent);
+}
+
+static void flushBatch(dbCaWorker *pw)
+{
+    dbCaFlushStats *pstats = &pw->flushStats;
+    epicsUInt64 now;
+
+    SEVCHK(ca_flush_io(), "dbCaTask");
+
+    now = epicsMonotonicGet();
+    epicsMutexMustLock(pw->workListLock);
+    if (pw->batchActions) {
+        double latency = (now - pw->batchStart) * 1e-9;
+
+        pstats->nFlush++;
+        pstats->nActions += pw->batchActions;
+        pstats->nBytes += pw->batchBytes;
+        if (pstats->maxActions < pw->batchActions)
+            pstats->maxActions = pw->batchActions;
+        if (pstats->maxBytes < pw->batchBytes)
+            pstats->maxBytes = pw->batchBytes;
+        pstats->latencyTotal += latency;
+        if (pstats->latencyMax < latency)
+            pstats->latencyMax = latency;
+    }
+    /* Anything still queued starts the next batch now */
+    pw->batchStart = ellCount(&pw->workList) ? now : 0;
+    epicsMutexUnlock(pw->workListLock);
+    pw->batchActions = 0;
+    pw->batchBytes = 0;
+}
+
+/* Seconds until the current batch must be flushed */
+static double batchWait(dbCaWorker *pw)
+{
+    epicsUInt64 start;
+    double age;
+
+    epicsMutexMustLock(pw->workListLock);
+    start = pw->batchStart;
+    epicsMutexUnlock(pw->workListLock);
+
+    age = (epicsMonotonicGet() - start) * 1e-9;
+    return dbCaFlushDelay * 1e-6 - age;
+}
+
+static void batchAdd(dbCaWorker *pw, size_t nBytes)
+{
+    /* A flush for an earlier action of this link may have ended the batch */
+    epicsMutexMustLock(pw->workListLock);
+    if (!pw->batchStart)
+        pw->batchStart = epicsMonotonicGet();
+    epicsMutexUnlock(pw->workListLock);
+    pw->batchActions++;
+    pw->batchBytes += CA_MSG_HEADER_SIZE + nBytes;
+    if (dbCaFlushBytes > 0 && pw->batchBytes >= (size_t) dbCaFlushBytes)
+        flushBatch(pw);
+}
+
+int dbCaGetWorkerCount(void)
+{
+    return nWorkers;
+}
+
+struct ca_client_context * dbCaGetWorkerContext(int worker)
+{
+    return worker >= 0 && worker < nWorkers ? workers[worker].context : NULL;
+}
+
+void dbCaGetFlushStats(int worker, dbCaFlushStats *pstats)
+{
+    int i;
+
+    memset(pstats, 0, sizeof(*pstats));
+    for (i = 0; i < nWorkers; i++) {
+        dbCaWorker *pw = &workers[i];
+        dbCaFlushStats *pws = &pw->flushStats;
+
+        if (worker >= 0 && worker != i)
+            continue;
+        epicsMutexMustLock(pw->workListLock);
+        pstats->nFlush += pws->nFlush;
+        pstats->nActions += pws->nActions;
+        pstats->nBytes += pws->nBytes;
+        if (pstats->maxActions < pws->maxActions)
+            pstats->maxActions = pws->maxActions;
+        if (pstats->maxBytes < pws->maxBytes)
+            pstats->maxBytes = pws->maxBytes;
+        pstats->latencyTotal += pws->latencyTotal;
+        if (pstats->latencyMax < pws->latencyMax)
+            pstats->latencyMax = pws->latencyMax;
+        epicsMutexUnlock(pw->workListLock);
+        pstats->nChannels += epicsAtomicGetIntT(&pw->chanCount);
+    }
 }
 
 static void caLinkInc(caLink *pca)
@@ -178,7 +307,7 @@ static void caLinkDec(caLink *pca)
 
     if (pca->chid) {
         ca_clear_channel(pca->chid);
-        --dbca_chan_count;
+        epicsAtomicDecrIntT(&pca->worker->chanCount);
     }
     callback = pca->putCallback;
     if (callback) {
@@ -263,10 +392,20 @@ void testdbCaWaitForUpdateCount(DBLINK *plink, unsigned long cnt)
     testdbCaWaitForEvent(plink, cnt, testEventCount);
 }
 
-/* Block until worker thread has processed all previously queued actions.
+static void dbCaSyncWorker(dbCaWorker *pw);
+
+/* Block until worker threads have processed all previously queued actions.
  * Does not prevent additional actions from being queued.
  */
 void dbCaSync(void)
+{
+    int i;
+
+    for (i = 0; i < nWorkers; i++)
+        dbCaSyncWorker(&workers[i]);
+}
+
+static void dbCaSyncWorker(dbCaWorker *pw)
 {
     epicsEventId wake;
     caLink templink;
@@ -277,6 +416,7 @@ void dbCaSync(void)
      */
     memset(&templink, 0, sizeof(templink));
     templink.refcount = 1;
+    templink.worker = pw;
 
     wake = epicsEventMustCreate(epicsEventEmpty);
     templink.lock = epicsMutexMustCreate();
@@ -290,8 +430,8 @@ void dbCaSync(void)
      * we cycle through workListLock to ensure worker call to
      * epicsEventMustTrigger() returns before we destroy the event.
      */
-    epicsMutexMustLock(workListLock);
-    epicsMutexUnlock(workListLock);
+    epicsMutexMustLock(pw->workListLock);
+    epicsMutexUnlock(pw->workListLock);
 
     assert(templink.refcount==1);
 
@@ -309,17 +449,24 @@ void dbCaCallbackProcess(void *userPvt)
 void dbCaShutdown(void)
 {
     enum dbCaCtl_t cur = dbCaCtl;
+    int i;
+
     assert(cur == ctlRun || cur == ctlPause);
     dbCaCtl = ctlExit;
-    epicsEventSignal(workListEvent);
-    epicsEventMustWait(startStopEvent);
-    if(dbCaWorker)
-        epicsThreadMustJoin(dbCaWorker);
+    for (i = 0; i < nWorkers; i++)
+        epicsEventSignal(workers[i].workListEvent);
+    for (i = 0; i < nWorkers; i++) {
+        epicsEventMustWait(workers[i].startStopEvent);
+        if (workers[i].tid)
+            epicsThreadMustJoin(workers[i].tid);
+        workers[i].tid = NULL;
+    }
 }
 
 static void dbCaLinkInitImpl(int isolate)
 {
     epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+    int i, n = dbCaWorkers;
 
     opts.stackSize = epicsThreadGetStackSize(epicsThreadStackBig);
     opts.priority = epicsThreadPriorityMedium;
@@ -328,18 +475,42 @@ static void dbCaLinkInitImpl(int isolate)
     dbServiceIsolate = isolate;
     dbServiceIOInit();
 
-    if (!workListLock)
-        workListLock = epicsMutexMustCreate();
-    if (!workListEvent)
-        workListEvent = epicsEventMustCreate(epicsEventEmpty);
-
-    if(!startStopEvent)
-        startStopEvent = epicsEventMustCreate(epicsEventEmpty);
+    if (n < 1)
+        n = 1;
+    else if (n > dbCaWorkersMax)
+        n = dbCaWorkersMax;
+
+    if (n != nWorkers) {
+        /* Any previous workers have been shut down */
+        for (i = 0; i < nWorkers; i++) {
+            epicsMutexDestroy(workers[i].workListLock);
+            epicsEventDestroy(workers[i].workListEvent);
+            epicsEventDestroy(workers[i].startStopEvent);
+        }
+        free(workers);
+        workers = dbCalloc(n, sizeof(dbCaWorker));
+        for (i = 0; i < n; i++) {
+            workers[i].workListLock = epicsMutexMustCreate();
+            workers[i].workListEvent = epicsEventMustCreate(epicsEventEmpty);
+            workers[i].startStopEvent = epicsEventMustCreate(epicsEventEmpty);
+        }
+        nWorkers = n;
+    }
     dbCaCtl = ctlPause;
 
-    dbCaWorker = epicsThreadCreateOpt("dbCaLink", dbCaTask, NULL, &opts);
-    /* wait for worker to startup and initialize dbCaClientContext */
-    epicsEventMustWait(startStopEvent);
+    for (i = 0; i < nWorkers; i++) {
+        char name[20];
+
+        if (i)
+            epicsSnprintf(name, sizeof(name), "dbCaLink%d", i);
+        else
+            strcpy(name, "dbCaLink");
+        workers[i].tid = epicsThreadCreateOpt(name, dbCaTask, &workers[i],
+            &opts);
+        /* wait for worker to startup and initialize its context */
+        epicsEventMustWait(workers[i].startStopEvent);
+    }
+    dbCaClientContext = workers[0].context;
 }
 
 void dbCaLinkInitIsolated(void)
@@ -352,11 +523,19 @@ void dbCaLinkInit(void)
     dbCaLinkInitImpl(0);
 }
 
+static void signalWorkers(void)
+{
+    int i;
+
+    for (i = 0; i < nWorkers; i++)
+        epicsEventSignal(workers[i].workListEvent);
+}
+
 void dbCaRun(void)
 {
     if (dbCaCtl == ctlPause) {
         dbCaCtl = ctlRun;
-        epicsEventSignal(workListEvent);
+        signalWorkers();
     }
 }
 
@@ -364,7 +543,7 @@ void dbCaPause(void)
 {
     if (dbCaCtl == ctlRun) {
         dbCaCtl = ctlPause;
-        epicsEventSignal(workListEvent);
+        signalWorkers();
     }
 }
 
@@ -380,6 +559,7 @@ void dbCaAddLinkCallback(struct link *plink,
     pca->lock = epicsMutexMustCreate();
     pca->plink = plink;
     pca->pvname = epicsStrDup(plink->value.pv_link.pvname);
+    pca->worker = &workers[epicsStrHash(pca->pvname, 0) % nWorkers];
     pca->connect = connect;
     pca->monitor = monitor;
     pca->userPvt = userPvt;
@@ -1116,33 +1296,45 @@ static void getAttribEventCallback(struct event_handler_args arg)
 
 static void dbCaTask(void *arg)
 {
+    dbCaWorker *pw = arg;
     epicsEventId requestSync = NULL;
     taskwdInsert(0, NULL, NULL);
     SEVCHK(ca_context_create(ca_enable_preemptive_callback),
         "dbCaTask calling ca_context_create");
-    dbCaClientContext = ca_current_context ();
+    pw->context = ca_current_context ();
     SEVCHK(ca_add_exception_event(exceptionCallback,NULL),
         "ca_add_exception_event");
-    epicsEventSignal(startStopEvent);
+    epicsEventSignal(pw->startStopEvent);
 
     /* channel access event loop */
     while (TRUE){
+        int synced = FALSE;
+
         do {
-            epicsEventMustWait(workListEvent);
+            if (pw->batchActions && dbCaFlushDelay > 0) {
+                double wait = batchWait(pw);
+
+                if (wait <= 0.0 ||
+                    epicsEventWaitWithTimeout(pw->workListEvent, wait) ==
+                        epicsEventWaitTimeout)
+                    flushBatch(pw);
+            }
+            else
+                epicsEventMustWait(pw->workListEvent);
         } while (dbCaCtl == ctlPause);
         while (TRUE) { /* process all requests in workList*/
             caLink *pca;
             short  link_action;
             int    status;
 
-            epicsMutexMustLock(workListLock);
-            if (!(pca = (caLink *)ellGet(&workList))){  /* Take off list head */
+            epicsMutexMustLock(pw->workListLock);
+            if (!(pca = (caLink *)ellGet(&pw->workList))){  /* Take off list head */
                 if(requestSync) {
                     /* dbCaSync() requires workListLock to be held here */
                     epicsEventMustTrigger(requestSync);
                     requestSync = NULL;
                 }
-                epicsMutexUnlock(workListLock);
+                epicsMutexUnlock(pw->workListLock);
                 if (dbCaCtl == ctlExit) goto shutdown;
                 break; /* workList is empty */
             }
@@ -1152,10 +1344,12 @@ static void dbCaTask(void *arg)
                 requestSync = pca->userPvt;
             }
             pca->link_action = 0;
-            if (link_action & CA_CLEAR_CHANNEL) --removesOutstanding;
-            epicsMutexUnlock(workListLock);         /* Give back immediately */
-            if (link_action&CA_SYNC)
+            if (link_action & CA_CLEAR_CHANNEL) --pw->removesOutstanding;
+            epicsMutexUnlock(pw->workListLock);         /* Give back immediately */
+            if (link_action&CA_SYNC) {
+                synced = TRUE;
                 continue;
+            }
             if (link_action & CA_CLEAR_CHANNEL) {   /* This must be first */
                 caLinkDec(pca);
                 /* No alarm is raised. Since link is changing so what? */
@@ -1165,13 +1359,14 @@ static void dbCaTask(void *arg)
                 status = ca_create_channel(
                       pca->pvname,connectionCallback,(void *)pca,
                       CA_PRIORITY_DB_LINKS, &(pca->chid));
+                batchAdd(pw, strlen(pca->pvname) + 1);
                 if (status != ECA_NORMAL) {
                     errlogPrintf("dbCaTask ca_create_channel %s\n",
                         ca_message(status));
                     printLinks(pca);
                     continue;
                 }
-                dbca_chan_count++;
+                epicsAtomicIncrIntT(&pw->chanCount);
                 status = ca_replace_access_rights_event(pca->chid,
                     accessRightsCallback);
                 if (status != ECA_NORMAL) {
@@ -1201,6 +1396,8 @@ static void dbCaTask(void *arg)
                         ca_message(status));
                     printLinks(pca);
                 }
+                else
+                    batchAdd(pw, dbr_size_n(pca->dbrType, pca->putnelements));
                 epicsMutexMustLock(pca->lock);
                 if (status == ECA_NORMAL) pca->newOutNative = FALSE;
                 epicsMutexUnlock(pca->lock);
@@ -1224,6 +1421,8 @@ static void dbCaTask(void *arg)
                         ca_message(status));
                     printLinks(pca);
                 }
+                else
+                    batchAdd(pw, MAX_STRING_SIZE);
                 epicsMutexMustLock(pca->lock);
                 if (status == ECA_NORMAL) pca->newOutString = FALSE;
                 epicsMutexUnlock(pca->lock);
@@ -1233,6 +1432,7 @@ static void dbCaTask(void *arg)
             if (link_action & CA_GET_ATTRIBUTES) {
                 status = ca_get_callback(DBR_CTRL_DOUBLE,
                     pca->chid, getAttribEventCallback, pca);
+                batchAdd(pw, 0);
                 if (status != ECA_NORMAL) {
                     errlogPrintf("dbCaTask ca_get_callback %s\n",
                         ca_message(status));
@@ -1251,6 +1451,7 @@ static void dbCaTask(void *arg)
                     0, /* dynamic size */
                     pca->chid, eventCallback, pca, 0.0, 0.0, 0.0,
                     &pca->evidNative);
+                batchAdd(pw, CA_MSG_HEADER_SIZE);
                 if (status != ECA_NORMAL) {
                     errlogPrintf("dbCaTask ca_add_array_event %s\n",
                         ca_message(status));
@@ -1264,6 +1465,7 @@ static void dbCaTask(void *arg)
                 status = ca_add_array_event(DBR_TIME_STRING, 1,
                     pca->chid, eventCallback, pca, 0.0, 0.0, 0.0,
                     &pca->evidString);
+                batchAdd(pw, CA_MSG_HEADER_SIZE);
                 if (status != ECA_NORMAL) {
                     errlogPrintf("dbCaTask ca_add_array_event %s\n",
                         ca_message(status));
@@ -1271,13 +1473,16 @@ static void dbCaTask(void *arg)
                 }
             }
         }
-        SEVCHK(ca_flush_io(), "dbCaTask");
+        if (dbCaFlushDelay <= 0 || synced || !pw->batchActions)
+            flushBatch(pw);
     }
 shutdown:
+    flushBatch(pw);
     taskwdRemove(0);
-    if (dbca_chan_count == 0)
+    if (epicsAtomicGetIntT(&pw->chanCount) == 0)
         ca_context_destroy();
     else
-        fprintf(stderr, "dbCa: chan_count = %d at shutdown\n", dbca_chan_count);
-    epicsEventSignal(startStopEvent);
+        fprintf(stderr, "dbCa: chan_count = %d at shutdown\n",
+            epicsAtomicGetIntT(&pw->chanCount));
+    epicsEventSignal(pw->startStopEvent);
 }
@@ -47,6 +47,13 @@ DBCORE_API long dbCaPutLink(struct link *plink,short dbrType,
 
 extern struct ca_client_context * dbCaClientContext;
 
+/* Number of dbCaLink worker threads, read at iocInit */
+DBCORE_API extern int dbCaWorkers;
+/* Hold CA requests this many microseconds before flushing, 0 disables */
+DBCORE_API extern int dbCaFlushDelay;
+/* Flush when about this many bytes of requests are pending, 0 disables */
+DBCORE_API extern int dbCaFlushBytes;
+
 #ifdef EPICS_DBCA_PRIVATE_API
 /* Wait CA link work queue to become empty.  eg. after from dbPut() to OUT */
 DBCORE_API void dbCaSync(void);
@@ -35,10 +35,13 @@
 #define CA_PUT          0x1
 #define CA_PUT_CALLBACK 0x2
 
+struct dbCaWorker;
+
 typedef struct caLink
 {
     ELLNODE         node;
     int             refcount;
+    struct dbCaWorker *worker;
     epicsMutexId    lock;
     struct link     *plink;
     char            *pvname;
@@ -96,4 +99,21 @@ typedef struct caLink
     unsigned long   nUpdate;
 }caLink;
 
+/* Flush statistics of the dbCaTask workers, for dbcar */
+typedef struct dbCaFlushStats {
+    int             nChannels;  /* CA channels created */
+    unsigned long   nFlush;     /* Flushes with requests pending */
+    unsigned long   nActions;   /* Requests flushed */
+    unsigned long   maxActions; /* Largest batch */
+    epicsUInt64     nBytes;     /* Estimated bytes flushed */
+    size_t          maxBytes;
+    double          latencyTotal; /* Seconds from queueing to flush */
+    double          latencyMax;
+} dbCaFlushStats;
+
+DBCORE_API int dbCaGetWorkerCount(void);
+DBCORE_API struct ca_client_context * dbCaGetWorkerContext(int worker);
+/* worker < 0 sums the statistics of all workers */
+DBCORE_API void dbCaGetFlushStats(int worker, dbCaFlushStats *pstats);
+
 #endif /* INC_dbCaPvt_H */
@@ -67,6 +67,8 @@ long dbcar(char *precordname, int level)
     unsigned long       nDisconnect=0;
     unsigned long       nNoWrite=0;
     caLink              *pca;
+    dbCaFlushStats      flushStats;
+    int                 nWorkers;
     int                 j;
 
     if (!precordname || precordname[0] == '\0' || !strcmp(precordname, "*")) {
@@ -150,12 +152,42 @@ done:
            nconnected, (ncalinks - nconnected));
     printf("    %d can't read, %d can't write.",
            noReadAccess, noWriteAccess);
-    printf("  (%lu disconnects, %lu writes prohibited)\n\n",
+    printf("  (%lu disconnects, %lu writes prohibited)\n",
            nDisconnect, nNoWrite);
+    nWorkers = dbCaGetWorkerCount();
+    for (j = -1; j < nWorkers; j++) {
+        dbCaGetFlushStats(j, &flushStats);
+        if (j < 0) {
+            if (nWorkers > 1)
+                printf("    %d workers, %d channels\n",
+                       nWorkers, flushStats.nChannels);
+        }
+        else if (level > 0 && nWorkers > 1)
+            printf("  worker %d: %d channels\n", j, flushStats.nChannels);
+        else
+            break;
+        if (flushStats.nFlush) {
+            printf("    %lu flushes of %.1f requests, %.0f bytes on average"
+                   " (max %lu, %lu)\n",
+                   flushStats.nFlush,
+                   (double) flushStats.nActions / flushStats.nFlush,
+                   (double) flushStats.nBytes / flushStats.nFlush,
+                   flushStats.maxActions, (unsigned long) flushStats.maxBytes);
+            printf("    flush latency %.3f ms average, %.3f ms max\n",
+                   flushStats.latencyTotal * 1e3 / flushStats.nFlush,
+                   flushStats.latencyMax * 1e3);
+        }
+    }
+    printf("\n");
     dbFinishEntry(pdbentry);
 
-    if ( level > 2  && dbCaClientContext != 0 ) {
-        ca_context_status ( dbCaClientContext, level - 2 );
+    if ( level > 2 ) {
+        for (j = 0; j < nWorkers; j++) {
+            struct ca_client_context *context = dbCaGetWorkerContext(j);
+
+            if (context)
+                ca_context_status ( context, level - 2 );
+        }
     }
 
     return(0);
@@ -22,8 +22,10 @@
 
 #include "cantProceed.h"
 #include "epicsAssert.h"
+#include "epicsAtomic.h"
 #include "epicsString.h"
 #include "epicsStdio.h"
+#include "epicsMutex.h"
 #include "errlog.h"
 #include "freeList.h"
 #include "gpHash.h"
@@ -36,10 +38,13 @@
 #include "dbEvent.h"
 #include "dbLock.h"
 #include "dbStaticLib.h"
+#include "dbStaticPvt.h"
+#include "iocInit.h"
 #include "link.h"
 #include "recSup.h"
 #include "special.h"
 #include "alarm.h"
+#include "epicsExport.h"
 
 typedef struct parseContext {
     dbChannel *chan;
@@ -52,8 +57,79 @@ typedef struct parseContext {
 static void *dbChannelFreeList;
 static void *chFilterFreeList;
 
+/* Cache of pvNameLookup() results, including names that were not found.
+ * It is only used while the IOC is built, when records can't be added or
+ * removed, and holds at most dbChannelLookupCacheSize names.  Names are
+ * spread over LOOKUP_STRIPES independently locked parts by their hash.
+ * When the cache is full, adding a name evicts the oldest one in its part.
+ */
+int dbChannelLookupCacheSize = 0;
+epicsExportAddress(int, dbChannelLookupCacheSize);
+
+#define LOOKUP_STRIPES 16
+
+typedef struct lookupEntry {
+    ELLNODE node;
+    long status;
+    size_t nameLen;             /* Characters used by the lookup */
+    dbRecordType *precordType;
+    dbRecordNode *precnode;
+    dbFldDes *pflddes;
+    void *pfield;
+    short indfield;
+    char name[1];
+} lookupEntry;
+
+typedef struct lookupStripe {
+    epicsMutexId lock;
+    struct gphPvt *table;
+    ELLLIST entries;            /* Oldest first */
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+} lookupStripe;
+
+static struct {
+    int count;                  /* Names in all stripes */
+    lookupStripe stripe[LOOKUP_STRIPES];
+} lookupCache;
+
+static lookupStripe * lookupCacheStripe(const char *name)
+{
+    return &lookupCache.stripe[epicsStrHash(name, 0) % LOOKUP_STRIPES];
+}
+
+/* caller must lock pst->lock */
+static void lookupStripeClear(lookupStripe *pst)
+{
+    if (pst->table) {
+        gphFreeMem(pst->table);
+        pst->table = NULL;
+    }
+    epicsAtomicAddIntT(&lookupCache.count, -ellCount(&pst->entries));
+    ellFree(&pst->entries);
+}
+
+static void lookupCacheClear(int resetStats)
+{
+    int i;
+
+    for (i = 0; i < LOOKUP_STRIPES; i++) {
+        lookupStripe *pst = &lookupCache.stripe[i];
+
+        if (!pst->lock)
+            continue;
+        epicsMutexMustLock(pst->lock);
+        lookupStripeClear(pst);
+        if (resetStats)
+            pst->hits = pst->misses = pst->evictions = 0;
+        epicsMutexUnlock(pst->lock);
+    }
+}
+
 void dbChannelExit(void)
 {
+    lookupCacheClear(0);
     freeListCleanup(dbChannelFreeList);
     freeListCleanup(chFilterFreeList);
     dbChannelFreeList = chFilterFreeList = NULL;
@@ -61,6 +137,14 @@ void dbChannelExit(void)
 
 void dbChannelInit (void)
 {
+    int i;
+
+    for (i = 0; i < LOOKUP_STRIPES; i++) {
+        if (!lookupCache.stripe[i].lock)
+            lookupCache.stripe[i].lock = epicsMutexMustCreate();
+    }
+    lookupCacheClear(1);
+
     if(dbChannelFreeList)
         return;
 
@@ -308,7 +392,7 @@ static long chf_parse(dbChannel *chan, const char **pjson)
     return status;
 }
 
-static long pvNameLookup(DBENTRY *pdbe, const char **ppname)
+static long pvNameLookupDb(DBENTRY *pdbe, const char **ppname)
 {
     long status;
 
@@ -328,6 +412,159 @@ static long pvNameLookup(DBENTRY *pdbe, const char **ppname)
     return status;
 }
 
+static int lookupCacheUsable(void)
+{
+    return lookupCache.stripe[0].lock && dbChannelLookupCacheSize > 0 &&
+        getIocState() != iocVoid;
+}
+
+/* caller must lock pst->lock */
+static void lookupStripeEvict(lookupStripe *pst)
+{
+    lookupEntry *pe = (lookupEntry *) ellGet(&pst->entries);
+
+    gphDelete(pst->table, pe->name, &lookupCache);
+    free(pe);
+    epicsAtomicDecrIntT(&lookupCache.count);
+    pst->evictions++;
+}
+
+static void lookupCacheAdd(lookupStripe *pst, const char *name,
+    const DBENTRY *pdbe, size_t nameLen, long status)
+{
+    size_t len = strlen(name);
+    lookupEntry *pe;
+    GPHENTRY *pgph;
+
+    pe = malloc(sizeof(lookupEntry) + len);
+    if (!pe)
+        return;
+    strcpy(pe->name, name);
+    pe->status = status;
+    pe->nameLen = nameLen;
+    pe->precordType = pdbe->precordType;
+    pe->precnode = pdbe->precnode;
+    pe->pflddes = pdbe->pflddes;
+    pe->pfield = pdbe->pfield;
+    pe->indfield = pdbe->indfield;
+
+    epicsMutexMustLock(pst->lock);
+    if (!pst->table) {
+        int tableSize = 256;
+
+        while (tableSize * LOOKUP_STRIPES < dbChannelLookupCacheSize &&
+               tableSize < 65536)
+            tableSize <<= 1;
+        gphInitPvt(&pst->table, tableSize);
+    }
+
+    pgph = gphAdd(pst->table, pe->name, &lookupCache);
+    if (!pgph) {
+        /* Added by another thread meanwhile */
+        free(pe);
+        goto done;
+    }
+    pgph->userPvt = pe;
+    ellAdd(&pst->entries, &pe->node);
+
+    /* Make room by evicting from this stripe only */
+    if (epicsAtomicIncrIntT(&lookupCache.count) > dbChannelLookupCacheSize)
+        lookupStripeEvict(pst);
+done:
+    epicsMutexUnlock(pst->lock);
+}
+
+/* Find the record and field parts of a channel name, through the cache */
+static long pvNameLookup(DBENTRY *pdbe, const char **ppname)
+{
+    const char *name = *ppname;
+    lookupStripe *pst;
+    long status;
+
+    if (!lookupCacheUsable())
+        return pvNameLookupDb(pdbe, ppname);
+
+    /* Most names which aren't here never get as far as the cache */
+    if (!dbPvdMayContain(pdbbase, name, strcspn(name, "."))) {
+        dbInitEntry(pdbbase, pdbe);
+        return S_dbLib_recNotFound;
+    }
+
+    pst = lookupCacheStripe(name);
+    epicsMutexMustLock(pst->lock);
+    if (pst->table) {
+        GPHENTRY *pgph = gphFind(pst->table, name, &lookupCache);
+
+        if (pgph) {
+            lookupEntry *pe = pgph->userPvt;
+
+            dbInitEntry(pdbbase, pdbe);
+            pdbe->precordType = pe->precordType;
+            pdbe->precnode = pe->precnode;
+            pdbe->pflddes = pe->pflddes;
+            pdbe->pfield = pe->pfield;
+            pdbe->indfield = pe->indfield;
+            *ppname = name + pe->nameLen;
+            status = pe->status;
+            pst->hits++;
+            epicsMutexUnlock(pst->lock);
+            return status;
+        }
+    }
+    pst->misses++;
+    epicsMutexUnlock(pst->lock);
+
+    status = pvNameLookupDb(pdbe, ppname);
+    lookupCacheAdd(pst, name, pdbe, *ppname - name, status);
+    return status;
+}
+
+long dbChannelNameLookup(DBENTRY *pdbe, const char **ppname)
+{
+    return pvNameLookup(pdbe, ppname);
+}
+
+static void lookupCacheCounts(unsigned long *phits, unsigned long *pmisses,
+    unsigned long *pevictions, int reset)
+{
+    int i;
+
+    *phits = *pmisses = *pevictions = 0;
+    for (i = 0; i < LOOKUP_STRIPES; i++) {
+        lookupStripe *pst = &lookupCache.stripe[i];
+
+        if (!pst->lock)
+            continue;
+        epicsMutexMustLock(pst->lock);
+        *phits += pst->hits;
+        *pmisses += pst->misses;
+        *pevictions += pst->evictions;
+        if (reset)
+            pst->hits = pst->misses = pst->evictions = 0;
+        epicsMutexUnlock(pst->lock);
+    }
+}
+
+void dbChannelLookupCacheStats(unsigned long *phits, unsigned long *pmisses,
+    int *pcount)
+{
+    unsigned long evictions;
+
+    lookupCacheCounts(phits, pmisses, &evictions, 0);
+    *pcount = epicsAtomicGetIntT(&lookupCache.count);
+}
+
+void dbChannelLookupCacheShow(int reset)
+{
+    unsigned long hits, misses, evictions;
+
+    lookupCacheCounts(&hits, &misses, &evictions, reset);
+    printf("Channel name lookup cache: %d of %d names\n",
+        epicsAtomicGetIntT(&lookupCache.count), dbChannelLookupCacheSize);
+    printf("  %lu hits, %lu misses, %lu evictions\n",
+        hits, misses, evictions);
+}
+
 long dbChannelTest(const char *name)
 {
     DBENTRY dbEntry;
@@ -633,13 +870,7 @@ long dbChannelGet(dbChannel *chan, short type, void *pbuffer,
 long dbChannelGetField(dbChannel *chan, short dbrType, void *pbuffer,
         long *options, long *nRequest, void *pfl)
 {
-    dbCommon *precord = chan->addr.precord;
-    long status = 0;
-
-    dbScanLock(precord);
-    status = dbChannelGet(chan, dbrType, pbuffer, options, nRequest, pfl);
-    dbScanUnlock(precord);
-    return status;
+    return dbGetField(&chan->addr, dbrType, pbuffer, options, nRequest, pfl);
 }
 
 /* Only use dbChannelPut() if the record is already locked.
@@ -54,7 +54,7 @@ struct evSubscrip {
     void              * user_arg;
     /* associated queue, may be shared with other evSubscrip */
     struct event_que  * ev_que;
-    /* NULL if !npend.  if npend!=0, pointer to last event added to event_que::valque */
+    /* NULL if !npend.  if npend!=0, pointer to last event added to event_que::ring */
     db_field_log     ** pLastLog;
     /* n times this event is on the queue */
     unsigned long       npend;
@@ -64,10 +64,12 @@ struct evSubscrip {
     unsigned char       select;
     /* if set, subscription will yield dbfl_type_val */
     char                useValque;
-    /* event_task is handling this subscription */
-    char                callBackInProgress;
+    /* n events of this subscription taken by event_task but not yet delivered */
+    unsigned char       callBackInProgress;
     /* this node added to dbCommon::mlis */
     char                enabled;
+    /* node in the subscriber list of this field in dbCommonPvt::midx */
+    ELLNODE             fieldNode;
 };
 #endif
 
@@ -340,6 +342,28 @@ struct chFilter {
 struct dbCommon;
 struct dbFldDes;
 
+/** \brief Size limit of the channel name lookup cache.
+ *
+ * While the IOC is built, dbChannelTest() and dbChannelCreate() remember up
+ * to this many record and field lookups, including names that were not
+ * found.  Zero disables the cache.
+ */
+DBCORE_API extern int dbChannelLookupCacheSize;
+
+/** \brief Print the size and hit rate of the channel name lookup cache.
+ *
+ * \param reset Non-zero to reset the counters after printing them.
+ */
+DBCORE_API void dbChannelLookupCacheShow(int reset);
+
+#ifdef EPICS_PRIVATE_API
+struct dbEntry;
+/* Record and field part of a name, as used by dbNameToAddr() */
+DBCORE_API long dbChannelNameLookup(struct dbEntry *pdbe, const char **ppname);
+DBCORE_API void dbChannelLookupCacheStats(unsigned long *phits,
+    unsigned long *pmisses, int *pcount);
+#endif
+
 /** \brief Initialize the dbChannel subsystem. */
 DBCORE_API void dbChannelInit(void);
 
@@ -6,6 +6,7 @@
 #include "dbCommon.h"
 
 struct epicsThreadOSD;
+struct evFieldIndex;
 
 /** Base internal additional information for every record
  */
@@ -15,6 +16,9 @@ typedef struct dbCommonPvt {
     /* Thread which is currently processing this record */
     struct epicsThreadOSD* procThread;
 
+    /* Enabled monitor subscriptions by field, private to dbEvent */
+    struct evFieldIndex *midx;
+
     struct dbCommon common;
 } dbCommonPvt;
 
@@ -60,22 +60,38 @@ static void copyNoConvert(const void *pfrom,
 #define COPYNOCONVERT(N, FROM, TO, NREQ, NO_ELEM, OFFSET) \
     copyNoConvert(FROM, TO, (N)*(NREQ), (N)*(NO_ELEM), (N)*(OFFSET))
 
+/* Array conversions are done as at most two contiguous runs, before and
+ * after the wrap point of a circular buffer.  Simple loops like these are
+ * vectorized by the compiler for the target instruction set.
+ */
+#define CONVERT_RUN(typea, typeb, PSRC, PDST, N) \
+{ \
+    const typea *psrc_ = (PSRC); \
+    typeb *pdst_ = (PDST); \
+    long i_, n_ = (N); \
+    \
+    for (i_ = 0; i_ < n_; i_++) \
+        pdst_[i_] = (typeb) psrc_[i_]; \
+}
+
 #define GET(typea, typeb) (const dbAddr *paddr, \
     void *pto, long nRequest, long no_elements, long offset) \
 { \
-    typea *psrc = (typea *) paddr->pfield; \
+    const typea *psrc = (const typea *) paddr->pfield; \
     typeb *pdst = (typeb *) pto; \
+    long nwrap = no_elements - offset; \
     \
     if (nRequest==1 && offset==0) { \
         *pdst = (typeb) *psrc; \
         return 0; \
     } \
-    psrc += offset; \
-    while (nRequest--) { \
-        *pdst++ = (typeb) *psrc++; \
-        if (++offset == no_elements) \
-            psrc = (typea *) paddr->pfield; \
+    if (nwrap > 0 && nwrap < nRequest) { \
+        CONVERT_RUN(typea, typeb, psrc + offset, pdst, nwrap); \
+        pdst += nwrap; \
+        nRequest -= nwrap; \
+        offset = 0; \
     } \
+    CONVERT_RUN(typea, typeb, psrc + offset, pdst, nRequest); \
     return 0; \
 }
 
@@ -98,17 +114,19 @@ static void copyNoConvert(const void *pfrom,
 { \
     const typea *psrc = (const typea *) pfrom; \
     typeb *pdst = (typeb *) paddr->pfield; \
+    long nwrap = no_elements - offset; \
     \
     if (nRequest==1 && offset==0) { \
         *pdst = (typeb) *psrc; \
         return 0; \
     } \
-    pdst += offset; \
-    while (nRequest--) { \
-        *pdst++ = (typeb) *psrc++; \
-        if (++offset == no_elements) \
-            pdst = (typeb *) paddr->pfield; \
+    if (nwrap > 0 && nwrap < nRequest) { \
+        CONVERT_RUN(typea, typeb, psrc, pdst + offset, nwrap); \
+        psrc += nwrap; \
+        nRequest -= nwrap; \
+        offset = 0; \
     } \
+    CONVERT_RUN(typea, typeb, psrc, pdst + offset, nRequest); \
     return 0; \
 }
 
@@ -0,0 +1,111 @@
+/*************************************************************************\
+* Copyright (c) 2026 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* SPDX-License-Identifier: EPICS
+* EPICS Base is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+#ifndef INCdbConvertFastPvth
+#define INCdbConvertFastPvth
+
+#include <compilerDependencies.h>
+#include "epicsTypes.h"
+#include "dbFldTypes.h"
+#include "dbConvertFast.h"
+
+struct dbAddr;
+
+typedef long (*FASTCONVERTFUNC)(const void *from, void *to,
+    const struct dbAddr *paddr);
+
+/* Scalar conversions through dbFastGetConvertRoutine[][] and
+ * dbFastPutConvertRoutine[][] with the most common cases done inline:
+ * copies between identical numeric types, and numeric types to or from
+ * DBR_DOUBLE.  Results are identical to the table routines.
+ */
+
+static EPICS_ALWAYS_INLINE
+long dbFastGetConvert(short dbfType, short dbrType, const void *from,
+    void *to, const struct dbAddr *paddr)
+{
+    if (dbrType == DBR_DOUBLE) {
+        epicsFloat64 *pdst = (epicsFloat64 *) to;
+
+        switch (dbfType) {
+        case DBF_CHAR:   *pdst = *(const epicsInt8 *) from;    return 0;
+        case DBF_UCHAR:  *pdst = *(const epicsUInt8 *) from;   return 0;
+        case DBF_SHORT:  *pdst = *(const epicsInt16 *) from;   return 0;
+        case DBF_USHORT: *pdst = *(const epicsUInt16 *) from;  return 0;
+        case DBF_LONG:   *pdst = *(const epicsInt32 *) from;   return 0;
+        case DBF_ULONG:  *pdst = *(const epicsUInt32 *) from;  return 0;
+        case DBF_INT64:  *pdst = (epicsFloat64) *(const epicsInt64 *) from;
+                                                               return 0;
+        case DBF_UINT64: *pdst = (epicsFloat64) *(const epicsUInt64 *) from;
+                                                               return 0;
+        case DBF_FLOAT:  *pdst = *(const epicsFloat32 *) from; return 0;
+        case DBF_DOUBLE: *pdst = *(const epicsFloat64 *) from; return 0;
+        case DBF_ENUM:
+        case DBF_MENU:
+        case DBF_DEVICE: *pdst = *(const epicsEnum16 *) from;  return 0;
+        }
+    }
+    else if (dbrType == dbfType) {
+        switch (dbfType) {
+        case DBF_CHAR:
+            *(epicsInt8 *) to = *(const epicsInt8 *) from;       return 0;
+        case DBF_UCHAR:
+            *(epicsUInt8 *) to = *(const epicsUInt8 *) from;     return 0;
+        case DBF_SHORT:
+            *(epicsInt16 *) to = *(const epicsInt16 *) from;     return 0;
+        case DBF_USHORT:
+            *(epicsUInt16 *) to = *(const epicsUInt16 *) from;   return 0;
+        case DBF_LONG:
+            *(epicsInt32 *) to = *(const epicsInt32 *) from;     return 0;
+        case DBF_ULONG:
+            *(epicsUInt32 *) to = *(const epicsUInt32 *) from;   return 0;
+        case DBF_INT64:
+            *(epicsInt64 *) to = *(const epicsInt64 *) from;     return 0;
+        case DBF_UINT64:
+            *(epicsUInt64 *) to = *(const epicsUInt64 *) from;   return 0;
+        case DBF_FLOAT:
+            *(epicsFloat32 *) to = *(const epicsFloat32 *) from; return 0;
+        case DBF_ENUM:
+            *(epicsEnum16 *) to = *(const epicsEnum16 *) from;   return 0;
+        }
+    }
+    return ((FASTCONVERTFUNC) dbFastGetConvertRoutine[dbfType][dbrType])
+        (from, to, paddr);
+}
+
+static EPICS_ALWAYS_INLINE
+long dbFastPutConvert(short dbrType, short dbfType, const void *from,
+    void *to, const struct dbAddr *paddr)
+{
+    if (dbrType == DBR_DOUBLE) {
+        epicsFloat64 src = *(const epicsFloat64 *) from;
+
+        /* DBF_FLOAT needs epicsConvertDoubleToFloat(), use the table */
+        switch (dbfType) {
+        case DBF_CHAR:   *(epicsInt8 *) to = (epicsInt8) src;     return 0;
+        case DBF_UCHAR:  *(epicsUInt8 *) to = (epicsUInt8) src;   return 0;
+        case DBF_SHORT:  *(epicsInt16 *) to = (epicsInt16) src;   return 0;
+        case DBF_USHORT: *(epicsUInt16 *) to = (epicsUInt16) src; return 0;
+        case DBF_LONG:   *(epicsInt32 *) to = (epicsInt32) src;   return 0;
+        case DBF_ULONG:  *(epicsUInt32 *) to = (epicsUInt32) src; return 0;
+        case DBF_INT64:  *(epicsInt64 *) to = (epicsInt64) src;   return 0;
+        case DBF_UINT64: *(epicsUInt64 *) to = (epicsUInt64) src; return 0;
+        case DBF_DOUBLE: *(epicsFloat64 *) to = src;              return 0;
+        case DBF_ENUM:
+        case DBF_MENU:
+        case DBF_DEVICE: *(epicsEnum16 *) to = (epicsEnum16) src; return 0;
+        }
+    }
+    else if (dbrType == dbfType) {
+        return dbFastGetConvert(dbfType, dbrType, from, to, paddr);
+    }
+    return ((FASTCONVERTFUNC) dbFastPutConvertRoutine[dbrType][dbfType])
+        (from, to, paddr);
+}
+
+#endif /* INCdbConvertFastPvth */
@@ -58,6 +58,7 @@
 #include "dbBkpt.h"
 #include "dbCommonPvt.h"
 #include "dbConvertFast.h"
+#include "dbConvertFastPvt.h"
 #include "dbConvert.h"
 #include "db_field_log.h"
 #include "db_access_routines.h"
@@ -83,7 +84,51 @@ static lset dbDb_lset;
 
 static long processTarget(dbCommon *psrc, dbCommon *pdst);
 
-#define linkChannel(plink) ((dbChannel *) (plink)->value.pv_link.pvt)
+/* A DB link's pv_link.pvt points to its plan, which holds the target
+ * channel and everything dbDbGetValue() and dbDbPutValue() would otherwise
+ * re-derive from it on every call.  Plans are built when the link is
+ * created and freed when it is removed, which is also the only time the
+ * link's lock set gets split; DB links always share their target's lock
+ * set, so that needs no flag here.
+ */
+typedef struct dbDbLinkPlan {
+    dbChannel *chan;
+    short dbfType;      /* Field type, DBF_MENU and DBF_DEVICE not mapped */
+    char scalar;        /* Single element, no filters, not SPC_DBADDR */
+    char putDirect;     /* Scalar without special processing on put */
+    char isValue;       /* Target field is the VAL field */
+    char postValue;     /* Puts post DBE_VALUE|DBE_LOG, cf. dbPut() */
+    char prop;          /* Puts post DBE_PROPERTY */
+} dbDbLinkPlan;
+
+#define linkPlan(plink) ((dbDbLinkPlan *) (plink)->value.pv_link.pvt)
+#define linkChannel(plink) (linkPlan(plink)->chan)
+
+static dbDbLinkPlan * makePlan(dbChannel *chan)
+{
+    dbDbLinkPlan *plan = callocMustSucceed(1, sizeof(*plan), "makePlan");
+    dbFldDes *pfldDes = dbChannelFldDes(chan);
+
+    plan->chan = chan;
+    plan->dbfType = dbChannelFieldType(chan);
+    plan->scalar = dbChannelFinalElements(chan) == 1 &&
+        dbChannelElements(chan) == 1 &&
+        plan->dbfType <= DBF_DEVICE &&
+        dbChannelSpecial(chan) != SPC_DBADDR &&
+        dbChannelSpecial(chan) != SPC_ATTRIBUTE &&
+        pfldDes->special != SPC_DBADDR &&
+        ellCount(&chan->filters) == 0;
+    plan->putDirect = plan->scalar && dbChannelSpecial(chan) == 0;
+    plan->isValue = dbIsValueField(pfldDes);
+    plan->postValue = !(plan->isValue && pfldDes->process_passive);
+    plan->prop = pfldDes->prop;
+    return plan;
+}
+
+dbChannel * dbDbLinkChannel(const struct link *plink)
+{
+    return plink->type == DB_LINK ? linkChannel(plink) : NULL;
+}
 
 long dbDbInitLink(struct link *plink, short dbfType)
 {
@@ -102,7 +147,7 @@ long dbDbInitLink(struct link *plink, short dbfType)
 
     plink->lset = &dbDb_lset;
     plink->type = DB_LINK;
-    plink->value.pv_link.pvt = chan;
+    plink->value.pv_link.pvt = makePlan(chan);
     ellAdd(&precord->bklnk, &plink->value.pv_link.backlinknode);
     /* merging into the same lockset is deferred to the caller.
      * cf. initPVLinks()
@@ -117,7 +162,7 @@ void dbDbAddLink(struct dbLocker *locker, struct link *plink, short dbfType,
 {
     plink->lset = &dbDb_lset;
     plink->type = DB_LINK;
-    plink->value.pv_link.pvt = chan;
+    plink->value.pv_link.pvt = makePlan(chan);
     ellAdd(&dbChannelRecord(chan)->bklnk, &plink->value.pv_link.backlinknode);
 
     /* target record is already locked in dbPutFieldLink() */
@@ -126,7 +171,8 @@ void dbDbAddLink(struct dbLocker *locker, struct link *plink, short dbfType,
 
 static void dbDbRemoveLink(struct dbLocker *locker, struct link *plink)
 {
-    dbChannel *chan = linkChannel(plink);
+    dbDbLinkPlan *plan = linkPlan(plink);
+    dbChannel *chan = plan->chan;
     dbCommon *precord = dbChannelRecord(chan);
 
     plink->type = PV_LINK;
@@ -141,6 +187,7 @@ static void dbDbRemoveLink(struct dbLocker *locker, struct link *plink)
         dbLockSetSplit(locker, plink->precord, precord);
     }
     dbChannelDelete(chan);
+    free(plan);
 }
 
 static int dbDbIsConnected(const struct link *plink)
@@ -165,7 +212,8 @@ static long dbDbGetValue(struct link *plink, short dbrType, void *pbuffer,
         long *pnRequest)
 {
     struct pv_link *ppv_link = &plink->value.pv_link;
-    dbChannel *chan = linkChannel(plink);
+    dbDbLinkPlan *plan = linkPlan(plink);
+    dbChannel *chan = plan->chan;
     DBADDR *paddr = &chan->addr;
     dbCommon *precord = plink->precord;
     db_field_log *pfl = NULL;
@@ -178,34 +226,21 @@ static long dbDbGetValue(struct link *plink, short dbrType, void *pbuffer,
             return status;
     }
 
-    if (ppv_link->getCvt && ppv_link->lastGetdbrType == dbrType)
-    {
-        /* shortcut: scalar with known conversion, no filter */
-        status = ppv_link->getCvt(dbChannelField(chan), pbuffer, paddr);
-    }
-    else if (dbChannelFinalElements(chan) == 1 && (!pnRequest || *pnRequest == 1)
-                && dbChannelSpecial(chan) != SPC_DBADDR
-                && dbChannelSpecial(chan) != SPC_ATTRIBUTE
-                && ellCount(&chan->filters) == 0)
+    if (plan->scalar && dbrType >= DBR_STRING && dbrType <= DBR_ENUM)
     {
-        /* Simple scalar w/o filters, so *Final* type has no additional information.
-         * Needed to correctly handle DBF_MENU fields, which become DBF_ENUM during
-         * probe of dbChannelOpen().
+        /* Simple scalar w/o filters, so *Final* type has no additional
+         * information.  plan->dbfType is needed to correctly handle
+         * DBF_MENU fields, which become DBF_ENUM during probe of
+         * dbChannelOpen().
          */
-        unsigned short dbfType = dbChannelFieldType(chan);
-
-        if (dbrType < 0 || dbrType > DBR_ENUM || dbfType > DBF_DEVICE)
-            return S_db_badDbrtype;
-
-        ppv_link->getCvt = dbFastGetConvertRoutine[dbfType][dbrType];
-        ppv_link->lastGetdbrType = dbrType;
-        status = ppv_link->getCvt(dbChannelField(chan), pbuffer, paddr);
+        if (pnRequest)
+            *pnRequest = 1;
+        status = dbFastGetConvert(plan->dbfType, dbrType,
+            dbChannelField(chan), pbuffer, paddr);
     }
     else
     {
         /* filter, array, or special */
-        ppv_link->getCvt = NULL;
-
         if (ellCount(&chan->filters)) {
             /* If filters are involved in a read, create field log and run filters */
             pfl = db_create_read_log(chan);
@@ -370,11 +405,30 @@ static long dbDbPutValue(struct link *plink, short dbrType,
         const void *pbuffer, long nRequest)
 {
     struct pv_link *ppv_link = &plink->value.pv_link;
-    dbChannel *chan = linkChannel(plink);
+    dbDbLinkPlan *plan = linkPlan(plink);
+    dbChannel *chan = plan->chan;
     struct dbCommon *psrce = plink->precord;
     DBADDR *paddr = &chan->addr;
     dbCommon *pdest = dbChannelRecord(chan);
-    long status = dbPut(paddr, dbrType, pbuffer, nRequest);
+    long status;
+
+    if (plan->putDirect && nRequest == 1 &&
+        dbrType >= DBR_STRING && dbrType <= DBR_ENUM) {
+        /* What dbPut() does for a scalar field without special */
+        status = dbFastPutConvert(dbrType, plan->dbfType, pbuffer,
+            dbChannelField(chan), paddr);
+        if (!status) {
+            if (plan->isValue)
+                pdest->udf = FALSE;
+            if (pdest->mlis.count && plan->postValue)
+                db_post_events(pdest, dbChannelField(chan),
+                    DBE_VALUE | DBE_LOG);
+            if (pdest->mlis.count && plan->prop)
+                db_post_events(pdest, NULL, DBE_PROPERTY);
+        }
+    }
+    else
+        status = dbPut(paddr, dbrType, pbuffer, nRequest);
 
     recGblInheritSevr(ppv_link->pvlMask & pvlOptMsMode, pdest, psrce->nsta,
         psrce->nsev);
@@ -28,6 +28,8 @@ struct dbLocker;
 DBCORE_API long dbDbInitLink(struct link *plink, short dbfType);
 DBCORE_API void dbDbAddLink(struct dbLocker *locker, struct link *plink,
     short dbfType, dbChannel *ptarget);
+/* Target channel of a DB_LINK, or NULL for other link types */
+DBCORE_API dbChannel * dbDbLinkChannel(const struct link *plink);
 
 #ifdef __cplusplus
 }
@@ -29,7 +29,9 @@
 #include "cantProceed.h"
 #include "dbDefs.h"
 #include "epicsAssert.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
+#include "epicsExit.h"
 #include "epicsMutex.h"
 #include "epicsThread.h"
 #include "errlog.h"
@@ -43,10 +45,13 @@
 #include "dbBase.h"
 #include "dbChannel.h"
 #include "dbCommon.h"
+#include "dbCommonPvt.h"
 #include "dbEvent.h"
+#include "dbExtractArray.h"
 #include "db_field_log.h"
 #include "dbFldTypes.h"
 #include "dbLock.h"
+#include "epicsExport.h"
 #include "link.h"
 #include "special.h"
 
@@ -60,6 +65,30 @@
 #define EVENTENTRIES    4      /* the number of que entries for each event */
 #define EVENTQUESIZE    (EVENTENTRIES  * EVENTSPERQUE)
 #define EVENTQEMPTY     ((struct evSubscrip *)NULL)
+#define EVENTBATCH      EVENTSPERQUE   /* max events delivered per lock */
+
+/* Default per-subscription depth for new event contexts.
+ * Zero selects the fixed size, chained queues above.
+ */
+int dbEventQueueDepth = 0;
+epicsExportAddress(int,dbEventQueueDepth);
+
+/* Collect the monitor posts of a record while it is processed,
+ * merging the masks of each field into one post at the end.
+ */
+int dbEventPostBatch = 0;
+epicsExportAddress(int,dbEventPostBatch);
+
+#define POSTBATCHSIZE   8       /* fields collected before posting early */
+
+/*
+ * One queued event.  The subscription and its value are kept
+ * side by side so that the reader touches a single cache line.
+ */
+struct event_entry {
+    struct evSubscrip       *pevent;
+    db_field_log            *pfl;
+};
 
 /*
  * really a ring buffer
@@ -68,14 +97,16 @@ struct event_que {
     /* lock writers to the ring buffer only */
     /* readers must never slow up writers */
     epicsMutexId            writelock;
-    db_field_log            *valque[EVENTQUESIZE];
-    struct evSubscrip       *evque[EVENTQUESIZE];
+    struct event_entry      *ring;          /* size entries */
     struct event_que        *nextque;       /* in case que quota exceeded */
     struct event_user       *evUser;        /* event user parent struct */
-    unsigned short          putix;
-    unsigned short          getix;
-    unsigned short          quota;          /* the number of assigned entries*/
-    unsigned short          nDuplicates;    /* N events duplicated on this q */
+    unsigned                size;
+    unsigned                putix;
+    unsigned                getix;
+    unsigned                quota;          /* the number of assigned entries*/
+    unsigned                nDuplicates;    /* N events duplicated on this q */
+    unsigned                maxUsed;        /* high-water mark of used entries */
+    unsigned long           nReplaced;      /* N events discarded by replacement */
     unsigned                possibleStall;
 };
 
@@ -91,9 +122,14 @@ struct event_user {
     EXTRALABORFUNC      *extralabor_sub;/* off load to event task */
     void                *extralabor_arg;/* parameter to above */
 
+    EVENTWAKEFUNC       *wake_sub;      /* polled, called instead of ppendsem */
+    void                *wake_arg;      /* parameter to above */
+
     epicsThreadId       taskid;         /* event handler task id */
+    epicsThreadId       worker;         /* thread of the latest event_serve() */
     epicsUInt32         pflush_seq;     /* worker cycle count for synchronization */
     unsigned            queovr;         /* event que overflow count */
+    unsigned            queueDepth;     /* entries per subscription, 0 for fixed queues */
     unsigned char       pendexit;       /* exit pend task */
     unsigned char       extra_labor;    /* if set call extra labor func */
     unsigned char       flowCtrlMode;   /* replace existing monitor */
@@ -107,14 +143,64 @@ typedef struct {
     epicsEventId wake;
 } event_waiter;
 
+/*
+ * Posts deferred while a record is processed.  dbProcess() can
+ * recurse through links, so each thread has a stack of these.
+ */
+typedef struct {
+    struct dbCommon     *prec;
+    unsigned            nPost;
+    struct {
+        void            *pField;
+        unsigned        caEventMask;
+    } post[POSTBATCHSIZE];
+} post_batch;
+
+typedef struct {
+    unsigned            depth;
+    unsigned            size;
+    post_batch          *batch;
+} post_batch_stack;
+
+/*
+ * Immutable copy of an array field, shared by the field logs
+ * of all the subscriptions updated by one db_post_events().
+ * Free'd when the last of them is deleted.
+ */
+typedef struct {
+    int                 refcount;
+    epicsFloat64        data[1];        /* aligned for any element type */
+} event_snapshot;
+
+/*
+ * Enabled subscriptions of one record field
+ */
+struct evFieldSubs {
+    const void          *pfield;
+    ELLLIST             subs;           /* evSubscrip::fieldNode */
+};
+
+/*
+ * Per record index of enabled subscriptions by field, so that posting
+ * one field visits only its own subscribers.  Sorted by field address.
+ * Space is reserved by db_add_event() so enabling never allocates.
+ * Protected by dbCommon::mlok.
+ */
+struct evFieldIndex {
+    unsigned            nReserved;      /* N subscriptions of this record */
+    unsigned            nFields;        /* N fields with enabled subscriptions */
+    unsigned            size;           /* allocated fields */
+    struct evFieldSubs  *fields;
+};
+
 /*
  * Reliable intertask communication requires copying the current value of the
  * channel for later queuing so 3 stepper motor steps of 10 each do not turn
  * into only 10 or 20 total steps part of the time.
  */
 
-#define RNGINC(OLD)\
-( (unsigned short) ( (OLD) >= (EVENTQUESIZE-1) ? 0 : (OLD)+1 ) )
+#define RNGINC(EV_QUE, OLD)\
+( (OLD) >= (EV_QUE)->size - 1u ? 0u : (OLD) + 1u )
 
 #define LOCKEVQUE(EV_QUE)   epicsMutexMustLock((EV_QUE)->writelock)
 #define UNLOCKEVQUE(EV_QUE) epicsMutexUnlock((EV_QUE)->writelock)
@@ -130,20 +216,87 @@ static char *EVENT_PEND_NAME = "eventTask";
 
 static epicsMutexId stopSync;
 
-/* unused space in queue (EVENTQUESIZE when empty) */
-static unsigned short ringSpace ( const struct event_que *pevq )
+static epicsThreadOnceId postBatchOnce = EPICS_THREAD_ONCE_INIT;
+static epicsThreadPrivateId postBatchId;
+
+static unsigned char event_serve ( struct event_user *evUser );
+static void event_free_queues ( struct event_user *evUser );
+
+/* unused space in queue (size when empty) */
+static unsigned ringSpace ( const struct event_que *pevq )
 {
-    if ( pevq->evque[pevq->putix] == EVENTQEMPTY ) {
+    if ( pevq->ring[pevq->putix].pevent == EVENTQEMPTY ) {
         if ( pevq->getix > pevq->putix ) {
-            return ( unsigned short ) ( pevq->getix - pevq->putix );
+            return pevq->getix - pevq->putix;
         }
         else {
-            return ( unsigned short ) ( ( EVENTQUESIZE + pevq->getix ) - pevq->putix );
+            return ( pevq->size + pevq->getix ) - pevq->putix;
         }
     }
     return 0;
 }
 
+/* entries reserved in the queue by each subscription */
+static unsigned ringQuota ( const struct event_que *pevq )
+{
+    return pevq->evUser->queueDepth ? pevq->evUser->queueDepth : EVENTENTRIES;
+}
+
+static int ringAlloc ( struct event_que *pevq, unsigned size )
+{
+    pevq->ring = (struct event_entry *) calloc ( size, sizeof ( *pevq->ring ) );
+    if ( ! pevq->ring ) {
+        return DB_EVENT_ERROR;
+    }
+    pevq->size = size;
+    return DB_EVENT_OK;
+}
+
+/* notify the event task, or whoever polls this context */
+static void event_wake ( struct event_user *evUser )
+{
+    if ( evUser->wake_sub ) {
+        ( *evUser->wake_sub ) ( evUser->wake_arg );
+    }
+    else {
+        epicsEventSignal ( evUser->ppendsem );
+    }
+}
+
+/*
+ * Grow the ring, preserving the order of queued events.
+ * Also moves the pLastLog of subscriptions with pending events.
+ * event queue lock _must_ be applied
+ */
+static int ringResize ( struct event_que *pevq, unsigned size )
+{
+    struct event_entry *ring;
+    unsigned nUsed = pevq->size - ringSpace ( pevq );
+    unsigned ix = pevq->getix;
+    unsigned i;
+
+    assert ( size > pevq->size );
+    ring = (struct event_entry *) calloc ( size, sizeof ( *ring ) );
+    if ( ! ring ) {
+        return DB_EVENT_ERROR;
+    }
+    for ( i = 0u; i < nUsed; i++ ) {
+        struct event_entry *pold = &pevq->ring[ix];
+
+        ring[i] = *pold;
+        if ( pold->pevent->pLastLog == &pold->pfl ) {
+            pold->pevent->pLastLog = &ring[i].pfl;
+        }
+        ix = RNGINC ( pevq, ix );
+    }
+    free ( pevq->ring );
+    pevq->ring = ring;
+    pevq->size = size;
+    pevq->getix = 0u;
+    pevq->putix = nUsed;
+    return DB_EVENT_OK;
+}
+
 int db_event_list ( const char *pname, unsigned level )
 {
     return dbel ( pname, level );
@@ -194,17 +347,19 @@ int dbel ( const char *pname, unsigned level )
             }
 
             if ( level > 1 ) {
-                unsigned nEntriesFree;
+                unsigned nEntriesFree, nEntries, maxUsed;
                 const void * taskId;
                 LOCKEVQUE(pevent->ev_que);
                 nEntriesFree = ringSpace ( pevent->ev_que );
+                nEntries = pevent->ev_que->size;
+                maxUsed = pevent->ev_que->maxUsed;
                 taskId = ( void * ) pevent->ev_que->evUser->taskid;
                 UNLOCKEVQUE(pevent->ev_que);
                 if ( nEntriesFree == 0u ) {
                     printf ( ", thread=%p, queue full",
                         (void *) taskId );
                 }
-                else if ( nEntriesFree == EVENTQUESIZE ) {
+                else if ( nEntriesFree == nEntries ) {
                     printf ( ", thread=%p, queue empty",
                         (void *) taskId );
                 }
@@ -212,10 +367,12 @@ int dbel ( const char *pname, unsigned level )
                     printf ( ", thread=%p, unused entries=%u",
                         (void *) taskId, nEntriesFree );
                 }
+                printf ( ", high-water=%u/%u", maxUsed, nEntries );
             }
 
             if ( level > 2 ) {
                 unsigned nDuplicates;
+                unsigned long nReplaced;
                 if ( pevent->nreplace ) {
                     printf (", discarded by replacement=%ld", pevent->nreplace);
                 }
@@ -224,7 +381,11 @@ int dbel ( const char *pname, unsigned level )
                 }
                 LOCKEVQUE(pevent->ev_que);
                 nDuplicates = pevent->ev_que->nDuplicates;
+                nReplaced = pevent->ev_que->nReplaced;
                 UNLOCKEVQUE(pevent->ev_que);
+                if ( nReplaced ) {
+                    printf (", queue discarded by replacement=%lu", nReplaced );
+                }
                 if  ( nDuplicates ) {
                     printf (", duplicate count =%u\n", nDuplicates );
                 }
@@ -248,6 +409,132 @@ int dbel ( const char *pname, unsigned level )
     return DB_EVENT_OK;
 }
 
+/*
+ * Find the subscribers of a field.  Sets *pPos to the position
+ * where the field belongs in the index.
+ */
+static struct evFieldSubs * fieldIndexFind ( const struct evFieldIndex *pidx,
+    const void *pfield, unsigned *pPos )
+{
+    unsigned lo = 0u, hi = pidx ? pidx->nFields : 0u;
+
+    while ( lo < hi ) {
+        unsigned mid = lo + ( hi - lo ) / 2u;
+        const char *pmid = pidx->fields[mid].pfield;
+
+        if ( pmid == (const char *) pfield ) {
+            lo = mid;
+            break;
+        }
+        if ( pmid < (const char *) pfield ) {
+            lo = mid + 1u;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    if ( pPos ) {
+        *pPos = lo;
+    }
+    if ( lo < hi ) {
+        return &pidx->fields[lo];
+    }
+    return NULL;
+}
+
+/* room for one more subscription, called by db_add_event() */
+static int fieldIndexReserve ( struct dbCommon *prec )
+{
+    dbCommonPvt * const ppvt = dbRec2Pvt ( prec );
+    struct evFieldIndex *pidx;
+    int status = DB_EVENT_OK;
+
+    LOCKREC (prec);
+    pidx = ppvt->midx;
+    if ( ! pidx ) {
+        pidx = (struct evFieldIndex *) calloc ( 1, sizeof ( *pidx ) );
+        ppvt->midx = pidx;
+    }
+    if ( ! pidx ) {
+        status = DB_EVENT_ERROR;
+    }
+    else if ( pidx->nReserved == pidx->size ) {
+        unsigned size = pidx->size ? 2u * pidx->size : 4u;
+        struct evFieldSubs *fields = (struct evFieldSubs *)
+            realloc ( pidx->fields, size * sizeof ( *fields ) );
+
+        if ( fields ) {
+            pidx->fields = fields;
+            pidx->size = size;
+        }
+        else {
+            status = DB_EVENT_ERROR;
+        }
+    }
+    if ( status == DB_EVENT_OK ) {
+        pidx->nReserved++;
+    }
+    else if ( pidx && ! pidx->nReserved ) {
+        free ( pidx );
+        ppvt->midx = NULL;
+    }
+    UNLOCKREC (prec);
+    return status;
+}
+
+static void fieldIndexRelease ( struct dbCommon *prec )
+{
+    dbCommonPvt * const ppvt = dbRec2Pvt ( prec );
+    struct evFieldIndex *pidx;
+
+    LOCKREC (prec);
+    pidx = ppvt->midx;
+    assert ( pidx && pidx->nReserved > 0u );
+    if ( --pidx->nReserved == 0u ) {
+        assert ( pidx->nFields == 0u );
+        free ( pidx->fields );
+        free ( pidx );
+        ppvt->midx = NULL;
+    }
+    UNLOCKREC (prec);
+}
+
+/* record lock _must_ be applied */
+static void fieldIndexAdd ( struct dbCommon *prec, struct evSubscrip *pevent )
+{
+    struct evFieldIndex * const pidx = dbRec2Pvt ( prec )->midx;
+    const void * const pfield = dbChannelField ( pevent->chan );
+    struct evFieldSubs *pfs;
+    unsigned pos;
+
+    pfs = fieldIndexFind ( pidx, pfield, &pos );
+    if ( ! pfs ) {
+        assert ( pidx->nFields < pidx->size );
+        pfs = &pidx->fields[pos];
+        memmove ( pfs + 1, pfs, ( pidx->nFields - pos ) * sizeof ( *pfs ) );
+        pidx->nFields++;
+        pfs->pfield = pfield;
+        ellInit ( &pfs->subs );
+    }
+    ellAdd ( &pfs->subs, &pevent->fieldNode );
+}
+
+/* record lock _must_ be applied */
+static void fieldIndexRemove ( struct dbCommon *prec, struct evSubscrip *pevent )
+{
+    struct evFieldIndex * const pidx = dbRec2Pvt ( prec )->midx;
+    struct evFieldSubs *pfs;
+    unsigned pos;
+
+    pfs = fieldIndexFind ( pidx, dbChannelField ( pevent->chan ), &pos );
+    assert ( pfs );
+    ellDelete ( &pfs->subs, &pevent->fieldNode );
+    if ( ellCount ( &pfs->subs ) == 0 ) {
+        pidx->nFields--;
+        memmove ( pfs, pfs + 1, ( pidx->nFields - pos ) * sizeof ( *pfs ) );
+    }
+}
+
 /*
  * DB_INIT_EVENT_FREELISTS()
  *
@@ -304,10 +591,13 @@ dbEventCtx db_init_events (void)
     /* Flag will be cleared when event task starts */
     evUser->pendexit = TRUE;
 
+    evUser->queueDepth = dbEventQueueDepth > 0 ? dbEventQueueDepth : 0;
     evUser->firstque.evUser = evUser;
     evUser->firstque.writelock = epicsMutexCreate();
     if (!evUser->firstque.writelock)
         goto fail;
+    if (ringAlloc(&evUser->firstque, EVENTQUESIZE))
+        goto fail;
 
     evUser->ppendsem = epicsEventCreate(epicsEventEmpty);
     if (!evUser->ppendsem)
@@ -331,10 +621,38 @@ fail:
         epicsEventDestroy (evUser->ppendsem);
     if(evUser->pexitsem)
         epicsEventDestroy (evUser->pexitsem);
+    free(evUser->firstque.ring);
     freeListFree(dbevEventUserFreeList,evUser);
     return NULL;
 }
 
+/*
+ * DB_EVENT_SET_QUEUE_DEPTH()
+ *
+ * Select the queue used by this context.  With a depth of zero all
+ * subscriptions share chained queues of fixed size.  Otherwise a single
+ * queue grows as subscriptions are added, reserving depth entries
+ * for each one, and only the values beyond that depth are replaced.
+ * Must be called before the first db_add_event() on this context.
+ */
+int db_event_set_queue_depth (dbEventCtx ctx, unsigned depth)
+{
+    struct event_user * const evUser = (struct event_user *) ctx;
+    int status = DB_EVENT_OK;
+
+    epicsMutexMustLock ( evUser->lock );
+    LOCKEVQUE ( &evUser->firstque );
+    if ( evUser->firstque.quota || evUser->firstque.nextque ) {
+        status = DB_EVENT_ERROR;
+    }
+    else {
+        evUser->queueDepth = depth;
+    }
+    UNLOCKEVQUE ( &evUser->firstque );
+    epicsMutexUnlock ( evUser->lock );
+    return status;
+}
+
 
 DBCORE_API void db_cleanup_events(void)
 {
@@ -373,7 +691,17 @@ void db_close_events (dbEventCtx ctx)
      * hazardous to the system's health.
      */
     epicsMutexMustLock ( evUser->lock );
-    if(!evUser->pendexit) { /* event task running */
+    if(!evUser->pendexit && evUser->wake_sub) { /* polled */
+        evUser->pendexit = TRUE;
+        epicsMutexUnlock ( evUser->lock );
+
+        /* last cycle, as the event task would, frees canceled subscriptions */
+        event_serve ( evUser );
+        event_free_queues ( evUser );
+
+        epicsMutexMustLock ( evUser->lock );
+    }
+    else if(!evUser->pendexit) { /* event task running */
         evUser->pendexit = TRUE;
         epicsMutexUnlock ( evUser->lock );
 
@@ -393,6 +721,7 @@ void db_close_events (dbEventCtx ctx)
     epicsEventDestroy(evUser->pexitsem);
     epicsEventDestroy(evUser->ppendsem);
     epicsMutexDestroy(evUser->lock);
+    free(evUser->firstque.ring);
 
     epicsMutexUnlock (stopSync);
 
@@ -414,6 +743,11 @@ static struct event_que * create_ev_que ( struct event_user * const evUser )
         freeListFree ( dbevEventQueueFreeList, ev_que );
         return NULL;
     }
+    if ( ringAlloc ( ev_que, EVENTQUESIZE ) ) {
+        epicsMutexDestroy ( ev_que->writelock );
+        freeListFree ( dbevEventQueueFreeList, ev_que );
+        return NULL;
+    }
     ev_que->evUser = evUser;
     return ev_que;
 }
@@ -441,11 +775,36 @@ dbEventSubscription db_add_event (
         return NULL;
     }
 
+    if ( fieldIndexReserve ( dbChannelRecord ( chan ) ) ) {
+        freeListFree ( dbevEventSubscriptionFreeList, pevent );
+        return NULL;
+    }
+
     /* find an event que block with enough quota */
     /* otherwise add a new one to the list */
     epicsMutexMustLock ( evUser->lock );
     ev_que = & evUser->firstque;
-    while ( TRUE ) {
+    if ( evUser->queueDepth ) {
+        /* grow the only queue, doubling to amortize the copy */
+        int success;
+        LOCKEVQUE ( ev_que );
+        success = ( ev_que->quota + evUser->queueDepth <= ev_que->size );
+        if ( ! success ) {
+            unsigned size = ev_que->size;
+            while ( size < ev_que->quota + evUser->queueDepth ) {
+                size *= 2u;
+            }
+            success = ( ringResize ( ev_que, size ) == DB_EVENT_OK );
+        }
+        if ( success ) {
+            ev_que->quota += evUser->queueDepth;
+        }
+        UNLOCKEVQUE ( ev_que );
+        if ( ! success ) {
+            ev_que = NULL;
+        }
+    }
+    else while ( TRUE ) {
         int success = 0;
         LOCKEVQUE ( ev_que );
         success = ( ev_que->quota < EVENTQUESIZE - EVENTENTRIES );
@@ -468,6 +827,7 @@ dbEventSubscription db_add_event (
     epicsMutexUnlock ( evUser->lock );
 
     if ( ! ev_que ) {
+        fieldIndexRelease ( dbChannelRecord ( chan ) );
         freeListFree ( dbevEventSubscriptionFreeList, pevent );
         return NULL;
     }
@@ -479,7 +839,7 @@ dbEventSubscription db_add_event (
     pevent->chan =      chan;
     pevent->select =    (unsigned char) select;
     pevent->pLastLog =  NULL; /* not yet in the queue */
-    pevent->callBackInProgress = FALSE;
+    pevent->callBackInProgress = 0u;
     pevent->enabled =   FALSE;
     pevent->ev_que =    ev_que;
 
@@ -511,6 +871,7 @@ void db_event_enable (dbEventSubscription event)
     LOCKREC (precord);
     if ( ! pevent->enabled ) {
         ellAdd (&precord->mlis, &pevent->node);
+        fieldIndexAdd (precord, pevent);
         pevent->enabled = TRUE;
     }
     UNLOCKREC (precord);
@@ -527,6 +888,7 @@ void db_event_disable (dbEventSubscription event)
     LOCKREC (precord);
     if ( pevent->enabled ) {
         ellDelete(&precord->mlis, &pevent->node);
+        fieldIndexRemove (precord, pevent);
         pevent->enabled = FALSE;
     }
     UNLOCKREC (precord);
@@ -538,12 +900,12 @@ void db_event_disable (dbEventSubscription event)
  * this nulls the entry in the queue, but doesn't delete the db_field_log chunk
  */
 static void event_remove ( struct event_que *ev_que,
-    unsigned short index, struct evSubscrip *placeHolder )
+    unsigned index, struct evSubscrip *placeHolder )
 {
-    struct evSubscrip * const pevent = ev_que->evque[index];
+    struct evSubscrip * const pevent = ev_que->ring[index].pevent;
 
-    ev_que->evque[index] = placeHolder;
-    ev_que->valque[index] = NULL;
+    ev_que->ring[index].pevent = placeHolder;
+    ev_que->ring[index].pfl = NULL;
     if ( pevent->npend == 1u ) {
         pevent->pLastLog = NULL;
     }
@@ -569,6 +931,7 @@ void db_cancel_event (dbEventSubscription event)
     char sync = 0;
 
     db_event_disable ( event );
+    fieldIndexRelease ( dbChannelRecord ( pevent->chan ) );
 
     LOCKEVQUE (que);
 
@@ -576,7 +939,7 @@ void db_cancel_event (dbEventSubscription event)
 
     if(pevent->callBackInProgress) {
         /* this event callback is pending or in-progress in event_task. */
-        if(pevent->ev_que->evUser->taskid != epicsThreadGetIdSelf())
+        if(pevent->ev_que->evUser->worker != epicsThreadGetIdSelf())
             sync = 1; /* concurrent to event_task, so wait */
 
     } else if(pevent->npend) {
@@ -585,7 +948,7 @@ void db_cancel_event (dbEventSubscription event)
     } else {
         /* no other references, cleanup now */
 
-        pevent->ev_que->quota -= EVENTENTRIES;
+        pevent->ev_que->quota -= ringQuota ( pevent->ev_que );
         freeListFree ( dbevEventSubscriptionFreeList, pevent );
     }
 
@@ -605,7 +968,7 @@ void db_cancel_event (dbEventSubscription event)
         do {
             epicsMutexUnlock( evUser->lock );
             /* ensure worker will cycle at least once */
-            epicsEventMustTrigger(evUser->ppendsem);
+            event_wake(evUser);
 
             if(wait.wake) {
                 epicsEventMustWait(wait.wake);
@@ -680,7 +1043,7 @@ int db_post_extra_labor (dbEventCtx ctx)
     epicsMutexUnlock ( evUser->lock );
 
     if ( doit ) {
-        epicsEventSignal(evUser->ppendsem);
+        event_wake(evUser);
     }
 
     return DB_EVENT_OK;
@@ -758,6 +1121,58 @@ db_field_log* db_create_read_log (struct dbChannel *chan)
     return pLog;
 }
 
+static void snapshotRelease ( db_field_log *pfl )
+{
+    event_snapshot *psnap = (event_snapshot *) pfl->u.r.pvt;
+
+    if ( ! epicsAtomicDecrIntT ( &psnap->refcount ) ) {
+        free ( psnap );
+    }
+}
+
+#define isSnapshot(PFL) ((PFL) && (PFL)->dtor == snapshotRelease)
+
+/* array subscriptions which may share a snapshot */
+static int snapshotEligible ( const struct evSubscrip *pevent )
+{
+    return ! pevent->useValque &&
+        dbChannelSpecial ( pevent->chan ) == SPC_DBADDR &&
+        dbChannelElements ( pevent->chan ) > 1;
+}
+
+/*
+ * Copy the current array value of a subscription's field.
+ * NOTE: This assumes that the db scan lock is already applied
+ */
+static event_snapshot * snapshotCreate ( struct dbChannel *chan, long *pnord )
+{
+    event_snapshot *psnap;
+    void *pfield = dbChannelField ( chan );
+    long nord = dbChannelElements ( chan );
+    long offset = 0;
+    size_t size;
+
+    dbChannelGetArrayInfo ( chan, &pfield, &nord, &offset );
+    if ( nord <= 0 ) {
+        return NULL;
+    }
+    size = (size_t) nord * dbChannelFieldSize ( chan );
+    psnap = (event_snapshot *) malloc ( offsetof ( event_snapshot, data ) + size );
+    if ( psnap ) {
+        /* reference held by the caller until all logs are created */
+        psnap->refcount = 1;
+        if ( offset == 0 ) {
+            memcpy ( psnap->data, pfield, size );
+        }
+        else {
+            dbExtractArray ( pfield, psnap->data, dbChannelFieldSize ( chan ),
+                nord, dbChannelElements ( chan ), offset, 1 );
+        }
+        *pnord = nord;
+    }
+    return psnap;
+}
+
 /*
  *  DB_QUEUE_EVENT_LOG()
  *
@@ -788,18 +1203,34 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
         return;
     }
 
+    /* likewise, an array snapshot on the queue is only
+     * replaced by a newer one, as the record's array would be
+     */
+    if (pevent->npend > 0u
+            && isSnapshot(*pevent->pLastLog)
+            && isSnapshot(pLog)) {
+        db_delete_field_log(*pevent->pLastLog);
+        *pevent->pLastLog = pLog;
+        UNLOCKEVQUE (ev_que);
+        return;
+    }
+
     /*
      * add to task local event que
      */
 
     /*
      * if an event is on the queue and one of
-     * {flowCtrlMode, not room for one more of each monitor attached}
+     * {flowCtrlMode, not room for one more of each monitor attached,
+     *  this monitor already has its depth of entries queued}
      * then replace the last event on the queue (for this monitor)
      */
     rngSpace = ringSpace ( ev_que );
     if ( pevent->npend>0u &&
-        (ev_que->evUser->flowCtrlMode || rngSpace<=EVENTSPERQUE) ) {
+        (ev_que->evUser->flowCtrlMode ||
+         (ev_que->evUser->queueDepth ?
+            pevent->npend >= ev_que->evUser->queueDepth || rngSpace==0u :
+            rngSpace<=EVENTSPERQUE)) ) {
         /*
          * replace last event if no space is left
          */
@@ -808,6 +1239,7 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
             *pevent->pLastLog = pLog;
         }
         pevent->nreplace++;
+        ev_que->nReplaced++;
         /*
          * the event task has already been notified about
          * this so we don't need to post the semaphore
@@ -819,10 +1251,12 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
      * Fill it in and advance the ring buffer.
      */
     else {
-        assert ( ev_que->evque[ev_que->putix] == EVENTQEMPTY );
-        ev_que->evque[ev_que->putix] = pevent;
-        ev_que->valque[ev_que->putix] = pLog;
-        pevent->pLastLog = &ev_que->valque[ev_que->putix];
+        struct event_entry *pentry = &ev_que->ring[ev_que->putix];
+
+        assert ( pentry->pevent == EVENTQEMPTY );
+        pentry->pevent = pevent;
+        pentry->pfl = pLog;
+        pevent->pLastLog = &pentry->pfl;
         if (pevent->npend>0u) {
             ev_que->nDuplicates++;
         }
@@ -831,13 +1265,16 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
          * if the ring buffer was empty before
          * adding this event
          */
-        if (rngSpace==EVENTQUESIZE) {
+        if (rngSpace==ev_que->size) {
             firstEventFlag = 1;
         }
         else {
             firstEventFlag = 0;
         }
-        ev_que->putix = RNGINC ( ev_que->putix );
+        if (ev_que->size - rngSpace + 1u > ev_que->maxUsed) {
+            ev_que->maxUsed = ev_que->size - rngSpace + 1u;
+        }
+        ev_que->putix = RNGINC ( ev_que, ev_que->putix );
     }
 
     UNLOCKEVQUE (ev_que);
@@ -852,7 +1289,214 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
         /*
          * notify the event handler
          */
-        epicsEventSignal(ev_que->evUser->ppendsem);
+        event_wake(ev_que->evUser);
+    }
+}
+
+/* record lock _must_ be applied */
+static void db_post_event_log (evSubscrip *pevent, unsigned caEventMask,
+    event_snapshot *psnap, long nord)
+{
+    db_field_log *pLog = db_create_event_log(pevent);
+    if(pLog) {
+        pLog->mask = caEventMask & pevent->select;
+        if (psnap && snapshotEligible(pevent)) {
+            epicsAtomicIncrIntT(&psnap->refcount);
+            pLog->u.r.field = psnap->data;
+            pLog->u.r.pvt = psnap;
+            pLog->dtor = snapshotRelease;
+            pLog->no_elements = nord;
+        }
+    }
+    pLog = dbChannelRunPreChain(pevent->chan, pLog);
+    if (pLog) db_queue_event_log(pevent, pLog);
+}
+
+/*
+ *  Post to the subscribers of a field (or all fields if pField==NULL)
+ *  record lock _must_ be applied
+ */
+static void db_post_events_locked (struct dbCommon *prec, void *pField,
+    unsigned caEventMask)
+{
+    struct evSubscrip *pevent;
+
+    /*
+     * Only send event msg if they are waiting on the field which
+     * changed or pval==NULL, and are waiting on matching event
+     */
+    if (pField) {
+        struct evFieldSubs *pfs = fieldIndexFind(dbRec2Pvt(prec)->midx,
+            pField, NULL);
+        event_snapshot *psnap = NULL;
+        long nord = 0;
+        ELLNODE *cur;
+
+        /*
+         * Copy an array once for all its subscribers when more than one
+         * would read it, or a filter on the queue reader would copy it.
+         */
+        if (pfs) {
+            struct dbChannel *chan = NULL;
+            unsigned nArray = 0u;
+
+            for (cur = ellFirst(&pfs->subs); cur; cur = ellNext(cur)) {
+                pevent = CONTAINER(cur, struct evSubscrip, fieldNode);
+                if ((caEventMask & pevent->select) && snapshotEligible(pevent)) {
+                    nArray++;
+                    if (ellCount(&pevent->chan->post_chain))
+                        nArray++;
+                    chan = pevent->chan;
+                }
+            }
+            if (nArray > 1u)
+                psnap = snapshotCreate(chan, &nord);
+        }
+
+        for (cur = pfs ? ellFirst(&pfs->subs) : NULL; cur; cur = ellNext(cur)) {
+            pevent = CONTAINER(cur, struct evSubscrip, fieldNode);
+            if (caEventMask & pevent->select)
+                db_post_event_log(pevent, caEventMask, psnap, nord);
+        }
+
+        if (psnap && !epicsAtomicDecrIntT(&psnap->refcount))
+            free(psnap);
+    }
+    else {
+        for (pevent = (struct evSubscrip *) prec->mlis.node.next;
+            pevent; pevent = (struct evSubscrip *) pevent->node.next){
+
+            if (caEventMask & pevent->select)
+                db_post_event_log(pevent, caEventMask, NULL, 0);
+        }
+    }
+}
+
+static void postBatchInit (void *unused)
+{
+    postBatchId = epicsThreadPrivateCreate ();
+}
+
+/* run by a thread which started a batch as it exits */
+static void postBatchFree (void *arg)
+{
+    post_batch_stack *pstack = (post_batch_stack *) arg;
+
+    epicsThreadPrivateSet ( postBatchId, NULL );
+    free ( pstack->batch );
+    free ( pstack );
+}
+
+/* this thread's batch for prec, if it is being processed */
+static post_batch * postBatchFind ( struct dbCommon *prec,
+    post_batch_stack **ppstack )
+{
+    post_batch_stack *pstack;
+    post_batch *pbatch;
+
+    /* only set once a thread has started a batch */
+    if ( ! postBatchId ) {
+        return NULL;
+    }
+    pstack = (post_batch_stack *) epicsThreadPrivateGet ( postBatchId );
+    if ( ! pstack || ! pstack->depth ) {
+        return NULL;
+    }
+    pbatch = &pstack->batch[pstack->depth - 1u];
+    if ( pbatch->prec != prec ) {
+        return NULL;
+    }
+    if ( ppstack ) {
+        *ppstack = pstack;
+    }
+    return pbatch;
+}
+
+static void postBatchPost ( post_batch *pbatch )
+{
+    struct dbCommon * const prec = pbatch->prec;
+    unsigned i;
+
+    if ( pbatch->nPost && prec->mlis.count ) {
+        LOCKREC (prec);
+        for ( i = 0u; i < pbatch->nPost; i++ ) {
+            db_post_events_locked ( prec, pbatch->post[i].pField,
+                pbatch->post[i].caEventMask );
+        }
+        UNLOCKREC (prec);
+    }
+    pbatch->nPost = 0u;
+}
+
+/*
+ *  DB_POST_BATCH_BEGIN()
+ *
+ *  Called by dbProcess() before the record is processed.
+ *  If dbEventPostBatch is set, db_post_events() for this record
+ *  merges the masks posted for each field until the batch ends
+ *  or is flushed.
+ */
+void db_post_batch_begin (struct dbCommon *prec)
+{
+    post_batch_stack *pstack;
+
+    if ( ! dbEventPostBatch ) {
+        return;
+    }
+    epicsThreadOnce ( &postBatchOnce, postBatchInit, NULL );
+    pstack = (post_batch_stack *) epicsThreadPrivateGet ( postBatchId );
+    if ( ! pstack ) {
+        pstack = (post_batch_stack *) calloc ( 1, sizeof ( *pstack ) );
+        if ( ! pstack ) {
+            return;
+        }
+        if ( epicsAtThreadExit ( postBatchFree, pstack ) ) {
+            free ( pstack );
+            return;
+        }
+        epicsThreadPrivateSet ( postBatchId, pstack );
+    }
+    if ( pstack->depth == pstack->size ) {
+        unsigned size = pstack->size ? 2u * pstack->size : 4u;
+        post_batch *batch = (post_batch *)
+            realloc ( pstack->batch, size * sizeof ( *batch ) );
+
+        if ( ! batch ) {
+            return;
+        }
+        pstack->batch = batch;
+        pstack->size = size;
+    }
+    pstack->batch[pstack->depth].prec = prec;
+    pstack->batch[pstack->depth].nPost = 0u;
+    pstack->depth++;
+}
+
+/*
+ *  DB_POST_BATCH_FLUSH()
+ *
+ *  Send the posts collected so far, called by recGblFwdLink()
+ */
+void db_post_batch_flush (struct dbCommon *prec)
+{
+    post_batch *pbatch = postBatchFind ( prec, NULL );
+
+    if ( pbatch ) {
+        postBatchPost ( pbatch );
+    }
+}
+
+/*
+ *  DB_POST_BATCH_END()
+ */
+void db_post_batch_end (struct dbCommon *prec)
+{
+    post_batch_stack *pstack;
+    post_batch *pbatch = postBatchFind ( prec, &pstack );
+
+    if ( pbatch ) {
+        postBatchPost ( pbatch );
+        pstack->depth--;
     }
 }
 
@@ -869,29 +1513,32 @@ unsigned int    caEventMask
 )
 {
     struct dbCommon   * const prec = (struct dbCommon *) pRecord;
-    struct evSubscrip *pevent;
+    post_batch *pbatch;
 
     if (prec->mlis.count == 0) return DB_EVENT_OK;       /* no monitors set */
 
-    LOCKREC (prec);
-
-    for (pevent = (struct evSubscrip *) prec->mlis.node.next;
-        pevent; pevent = (struct evSubscrip *) pevent->node.next){
+    if (dbEventPostBatch && (pbatch = postBatchFind(prec, NULL))) {
+        unsigned i;
 
-        /*
-         * Only send event msg if they are waiting on the field which
-         * changed or pval==NULL, and are waiting on matching event
-         */
-        if ( (dbChannelField(pevent->chan) == (void *)pField || pField==NULL) &&
-            (caEventMask & pevent->select)) {
-            db_field_log *pLog = db_create_event_log(pevent);
-            if(pLog)
-                pLog->mask = caEventMask & pevent->select;
-            pLog = dbChannelRunPreChain(pevent->chan, pLog);
-            if (pLog) db_queue_event_log(pevent, pLog);
+        for (i = 0u; i < pbatch->nPost; i++) {
+            if (pbatch->post[i].pField == pField)
+                break;
         }
+        if (i == pbatch->nPost) {
+            if (i == POSTBATCHSIZE) {
+                postBatchPost(pbatch);
+                i = 0u;
+            }
+            pbatch->post[i].pField = pField;
+            pbatch->post[i].caEventMask = 0u;
+            pbatch->nPost = i + 1u;
+        }
+        pbatch->post[i].caEventMask |= caEventMask;
+        return DB_EVENT_OK;
     }
 
+    LOCKREC (prec);
+    db_post_events_locked (prec, pField, caEventMask);
     UNLOCKREC (prec);
     return DB_EVENT_OK;
 
@@ -917,9 +1564,17 @@ void db_post_single_event (dbEventSubscription event)
 
 /*
  * EVENT_READ()
+ *
+ * Events are taken off the queue in batches, so the queue lock
+ * is applied twice per batch rather than twice per event.
  */
 static int event_read ( struct event_que *ev_que )
 {
+    struct {
+        struct evSubscrip   *pevent;
+        db_field_log        *pfl;
+        EVENTFUNC           *user_sub;
+    } batch[EVENTBATCH];
     int notifiedRemaining = 0;
 
     /*
@@ -938,20 +1593,30 @@ static int event_read ( struct event_que *ev_que )
         return DB_EVENT_OK;
     }
 
-    while ( ev_que->evque[ev_que->getix] != EVENTQEMPTY ) {
-        struct evSubscrip *pevent = ev_que->evque[ev_que->getix];
+    while ( ev_que->ring[ev_que->getix].pevent != EVENTQEMPTY ) {
+        unsigned nBatch = 0u, i;
         int eventsRemaining;
-        db_field_log *pfl = ev_que->valque[ev_que->getix];
 
         /*
          * Simple type values queued up for reliable interprocess
          * communication. (for other types they get whatever happens
          * to be there upon wakeup)
          */
+        do {
+            struct evSubscrip *pevent = ev_que->ring[ev_que->getix].pevent;
 
-        event_remove ( ev_que, ev_que->getix, EVENTQEMPTY );
-        ev_que->getix = RNGINC ( ev_que->getix );
-        eventsRemaining = ev_que->evque[ev_que->getix] != EVENTQEMPTY;
+            batch[nBatch].pevent = pevent;
+            batch[nBatch].pfl = ev_que->ring[ev_que->getix].pfl;
+            batch[nBatch].user_sub = pevent->user_sub;
+            /* subscription is not free'd until its whole batch is done */
+            pevent->callBackInProgress++;
+            nBatch++;
+
+            event_remove ( ev_que, ev_que->getix, EVENTQEMPTY );
+            ev_que->getix = RNGINC ( ev_que, ev_que->getix );
+        } while ( nBatch < EVENTBATCH &&
+                  ev_que->ring[ev_que->getix].pevent != EVENTQEMPTY );
+        eventsRemaining = ev_que->ring[ev_que->getix].pevent != EVENTQEMPTY;
 
         /*
          * Next event pointer can be used by event tasks to determine
@@ -963,33 +1628,44 @@ static int event_read ( struct event_que *ev_que )
          * record lock, and it is calling db_post_events() waiting
          * for the event queue lock (which this thread now has).
          */
-        if ( pevent->user_sub ) {
-            EVENTFUNC* user_sub = pevent->user_sub;
-            pevent->callBackInProgress = TRUE;
+        UNLOCKEVQUE (ev_que);
 
-            UNLOCKEVQUE (ev_que);
+        for ( i = 0u; i < nBatch; i++ ) {
+            struct evSubscrip *pevent = batch[i].pevent;
+            db_field_log *pfl = batch[i].pfl;
 
-            /* Run post-event-queue filter chain */
-            if (ellCount(&pevent->chan->post_chain)) {
-                pfl = dbChannelRunPostChain(pevent->chan, pfl);
-            }
-            if (pfl) {
-                /* Issue user callback */
-                ( *user_sub ) ( pevent->user_arg, pevent->chan,
-                                eventsRemaining, pfl );
-                notifiedRemaining = eventsRemaining;
+            /* an earlier callback of this batch may have canceled it */
+            if ( batch[i].user_sub && pevent->user_sub ) {
+                int remaining = eventsRemaining || i + 1u < nBatch;
+
+                /* Run post-event-queue filter chain */
+                if (ellCount(&pevent->chan->post_chain)) {
+                    pfl = dbChannelRunPostChain(pevent->chan, pfl);
+                }
+                if (pfl) {
+                    /* Issue user callback */
+                    ( *batch[i].user_sub ) ( pevent->user_arg, pevent->chan,
+                                             remaining, pfl );
+                    notifiedRemaining = remaining;
+                }
+                batch[i].pfl = pfl;
             }
+        }
 
-            LOCKEVQUE (ev_que);
+        LOCKEVQUE (ev_que);
 
-            pevent->callBackInProgress = FALSE;
-        }
-        /* callback may have called db_cancel_event(), so must check user_sub again */
-        if(!pevent->user_sub && !pevent->npend) {
-            pevent->ev_que->quota -= EVENTENTRIES;
-            freeListFree ( dbevEventSubscriptionFreeList, pevent );
+        for ( i = 0u; i < nBatch; i++ ) {
+            struct evSubscrip *pevent = batch[i].pevent;
+
+            pevent->callBackInProgress--;
+            /* callback may have called db_cancel_event(), so must check user_sub again */
+            if ( !pevent->user_sub && !pevent->npend &&
+                 !pevent->callBackInProgress ) {
+                pevent->ev_que->quota -= ringQuota ( pevent->ev_que );
+                freeListFree ( dbevEventSubscriptionFreeList, pevent );
+            }
+            db_delete_field_log(batch[i].pfl);
         }
-        db_delete_field_log(pfl);
     }
 
     if(notifiedRemaining && !ev_que->possibleStall) {
@@ -1002,83 +1678,101 @@ static int event_read ( struct event_que *ev_que )
     return DB_EVENT_OK;
 }
 
-static void event_task (void *pParm)
+/*
+ * One cycle of the worker: the extra labor, then the queued events.
+ * Returns the pendexit flag.
+ */
+static unsigned char event_serve ( struct event_user *evUser )
 {
-    struct event_user * const evUser = (struct event_user *) pParm;
     struct event_que * ev_que;
+    void (*pExtraLaborSub) (void *);
+    void *pExtraLaborArg;
     unsigned char pendexit;
 
-    /* init hook */
-    if (evUser->init_func) {
-        (*evUser->init_func)(evUser->init_func_arg);
+    /*
+     * check to see if the caller has offloaded
+     * labor to this task
+     */
+    epicsMutexMustLock ( evUser->lock );
+    evUser->worker = epicsThreadGetIdSelf();
+    evUser->extraLaborBusy = TRUE;
+    if ( evUser->extra_labor && evUser->extralabor_sub ) {
+        evUser->extra_labor = FALSE;
+        pExtraLaborSub = evUser->extralabor_sub;
+        pExtraLaborArg = evUser->extralabor_arg;
     }
+    else {
+        pExtraLaborSub = NULL;
+        pExtraLaborArg = NULL;
+    }
+    if ( pExtraLaborSub ) {
+        epicsMutexUnlock ( evUser->lock );
+        (*pExtraLaborSub)(pExtraLaborArg);
+        epicsMutexMustLock ( evUser->lock );
+    }
+    evUser->extraLaborBusy = FALSE;
 
-    taskwdInsert ( epicsThreadGetIdSelf(), NULL, NULL );
-
-    do {
-        void (*pExtraLaborSub) (void *);
-        void *pExtraLaborArg;
-        epicsEventMustWait(evUser->ppendsem);
-
-        /*
-         * check to see if the caller has offloaded
-         * labor to this task
-         */
+    for ( ev_que = &evUser->firstque; ev_que; ev_que = ev_que->nextque ) {
+        /* unlock during iteration is safe as event_que will not be free'd */
+        epicsMutexUnlock ( evUser->lock );
+        event_read (ev_que);
         epicsMutexMustLock ( evUser->lock );
-        evUser->extraLaborBusy = TRUE;
-        if ( evUser->extra_labor && evUser->extralabor_sub ) {
-            evUser->extra_labor = FALSE;
-            pExtraLaborSub = evUser->extralabor_sub;
-            pExtraLaborArg = evUser->extralabor_arg;
-        }
-        else {
-            pExtraLaborSub = NULL;
-            pExtraLaborArg = NULL;
-        }
-        if ( pExtraLaborSub ) {
-            epicsMutexUnlock ( evUser->lock );
-            (*pExtraLaborSub)(pExtraLaborArg);
-            epicsMutexMustLock ( evUser->lock );
+    }
+    pendexit = evUser->pendexit;
+
+    evUser->pflush_seq++;
+    if(ellCount(&evUser->waiters)) {
+        /* hold lock throughout to avoid race between event trigger and destroy */
+        ELLNODE *cur;
+        for(cur = ellFirst(&evUser->waiters); cur; cur = ellNext(cur)) {
+            event_waiter *w = CONTAINER(cur, event_waiter, node);
+            if(w->wake)
+                epicsEventMustTrigger(w->wake);
         }
-        evUser->extraLaborBusy = FALSE;
+    }
 
-        for ( ev_que = &evUser->firstque; ev_que; ev_que = ev_que->nextque ) {
-            /* unlock during iteration is safe as event_que will not be free'd */
-            epicsMutexUnlock ( evUser->lock );
-            event_read (ev_que);
-            epicsMutexMustLock ( evUser->lock );
-        }
-        pendexit = evUser->pendexit;
-
-        evUser->pflush_seq++;
-        if(ellCount(&evUser->waiters)) {
-            /* hold lock throughout to avoid race between event trigger and destroy */
-            ELLNODE *cur;
-            for(cur = ellFirst(&evUser->waiters); cur; cur = ellNext(cur)) {
-                event_waiter *w = CONTAINER(cur, event_waiter, node);
-                if(w->wake)
-                    epicsEventMustTrigger(w->wake);
-            }
-        }
+    epicsMutexUnlock ( evUser->lock );
 
-        epicsMutexUnlock ( evUser->lock );
+    return pendexit;
+}
 
-    } while( ! pendexit );
+static void event_free_queues ( struct event_user *evUser )
+{
+    struct event_que *ev_que, *nextque;
 
     epicsMutexDestroy(evUser->firstque.writelock);
+    free(evUser->firstque.ring);
+    evUser->firstque.ring = NULL;
+
+    ev_que = evUser->firstque.nextque;
+    while (ev_que) {
+        nextque = ev_que->nextque;
+        epicsMutexDestroy(ev_que->writelock);
+        free(ev_que->ring);
+        freeListFree(dbevEventQueueFreeList, ev_que);
+        ev_que = nextque;
+    }
+}
 
-    {
-        struct event_que    *nextque;
+static void event_task (void *pParm)
+{
+    struct event_user * const evUser = (struct event_user *) pParm;
+    unsigned char pendexit;
 
-        ev_que = evUser->firstque.nextque;
-        while (ev_que) {
-            nextque = ev_que->nextque;
-            epicsMutexDestroy(ev_que->writelock);
-            freeListFree(dbevEventQueueFreeList, ev_que);
-            ev_que = nextque;
-        }
+    /* init hook */
+    if (evUser->init_func) {
+        (*evUser->init_func)(evUser->init_func_arg);
     }
 
+    taskwdInsert ( epicsThreadGetIdSelf(), NULL, NULL );
+
+    do {
+        epicsEventMustWait(evUser->ppendsem);
+        pendexit = event_serve ( evUser );
+    } while( ! pendexit );
+
+    event_free_queues ( evUser );
+
     taskwdRemove(epicsThreadGetIdSelf());
 
     /* use stopSync to ensure pexitsem is not destroy'd
@@ -1111,9 +1805,10 @@ int db_start_events (
 
      /*
       * only one ca_pend_event thread may be
-      * started for each evUser
+      * started for each evUser, and none for
+      * one which is polled
       */
-     if (evUser->taskid) {
+     if (evUser->taskid || evUser->wake_sub) {
          epicsMutexUnlock ( evUser->lock );
          return DB_EVENT_OK;
      }
@@ -1134,6 +1829,45 @@ int db_start_events (
      return DB_EVENT_OK;
 }
 
+/*
+ * DB_START_EVENTS_POLLED()
+ *
+ * Like db_start_events(), but without a thread.  Instead wake(arg) is
+ * called whenever there is work, which the caller does by calling
+ * db_poll_events() from any one thread at a time.  wake() must not
+ * block, it may be called with database locks held.
+ */
+int db_start_events_polled (
+    dbEventCtx ctx, EVENTWAKEFUNC *wake, void *arg )
+{
+    struct event_user * const evUser = (struct event_user *) ctx;
+
+    epicsMutexMustLock ( evUser->lock );
+    if ( ! evUser->taskid && ! evUser->wake_sub ) {
+        evUser->wake_sub = wake;
+        evUser->wake_arg = arg;
+        evUser->pendexit = FALSE;
+    }
+    epicsMutexUnlock ( evUser->lock );
+    return DB_EVENT_OK;
+}
+
+/*
+ * DB_POLL_EVENTS()
+ *
+ * Run the extra labor and the event callbacks which are due, for a
+ * context started by db_start_events_polled().  Must not be called
+ * concurrently with itself or with db_close_events().
+ */
+void db_poll_events ( dbEventCtx ctx )
+{
+    struct event_user * const evUser = (struct event_user *) ctx;
+
+    if ( evUser->wake_sub ) {
+        event_serve ( evUser );
+    }
+}
+
 /*
  * db_event_change_priority()
  */
@@ -1141,7 +1875,10 @@ void db_event_change_priority ( dbEventCtx ctx,
                                         unsigned epicsPriority )
 {
     struct event_user * const evUser = ( struct event_user * ) ctx;
-    epicsThreadSetPriority ( evUser->taskid, epicsPriority );
+    /* a polled context runs at the priority of its caller */
+    if ( evUser->taskid ) {
+        epicsThreadSetPriority ( evUser->taskid, epicsPriority );
+    }
 }
 
 /*
@@ -1157,7 +1894,7 @@ void db_event_flow_ctrl_mode_on (dbEventCtx ctx)
     /*
      * notify the event handler task
      */
-    epicsEventSignal(evUser->ppendsem);
+    event_wake(evUser);
 }
 
 /*
@@ -1173,7 +1910,29 @@ void db_event_flow_ctrl_mode_off (dbEventCtx ctx)
     /*
      * notify the event handler task
      */
-    epicsEventSignal (evUser->ppendsem);
+    event_wake(evUser);
+}
+
+/*
+ * db_event_replaced()
+ *
+ * Number of updates for this context which were discarded
+ * because a newer value replaced them on the event queue
+ */
+unsigned long db_event_replaced (dbEventCtx ctx)
+{
+    struct event_user * const evUser = (struct event_user *) ctx;
+    struct event_que *ev_que;
+    unsigned long nReplaced = 0ul;
+
+    epicsMutexMustLock ( evUser->lock );
+    for ( ev_que = &evUser->firstque; ev_que; ev_que = ev_que->nextque ) {
+        LOCKEVQUE ( ev_que );
+        nReplaced += ev_que->nReplaced;
+        UNLOCKEVQUE ( ev_que );
+    }
+    epicsMutexUnlock ( evUser->lock );
+    return nReplaced;
 }
 
 /*
@@ -29,6 +29,7 @@ extern "C" {
 #endif
 
 struct dbChannel;
+struct dbCommon;
 struct db_field_log;
 struct evSubscrip;
 
@@ -41,14 +42,19 @@ DBCORE_API int db_post_events (
 
 typedef void * dbEventCtx;
 
+DBCORE_API extern int dbEventQueueDepth;
+DBCORE_API extern int dbEventPostBatch;
+
 typedef void EXTRALABORFUNC (void *extralabor_arg);
 DBCORE_API dbEventCtx db_init_events (void);
+DBCORE_API int db_event_set_queue_depth (dbEventCtx ctx, unsigned depth);
 DBCORE_API int db_start_events (
     dbEventCtx ctx, const char *taskname, void (*init_func)(void *),
     void *init_func_arg, unsigned osiPriority );
 DBCORE_API void db_close_events (dbEventCtx ctx);
 DBCORE_API void db_event_flow_ctrl_mode_on (dbEventCtx ctx);
 DBCORE_API void db_event_flow_ctrl_mode_off (dbEventCtx ctx);
+DBCORE_API unsigned long db_event_replaced (dbEventCtx ctx);
 DBCORE_API int db_add_extra_labor_event (
     dbEventCtx ctx, EXTRALABORFUNC *func, void *arg);
 DBCORE_API void db_flush_extra_labor_event (dbEventCtx);
@@ -58,6 +64,14 @@ DBCORE_API void db_event_change_priority ( dbEventCtx ctx, unsigned epicsPriorit
 #ifdef EPICS_PRIVATE_API
 DBCORE_API void db_cleanup_events(void);
 DBCORE_API void db_init_event_freelists (void);
+DBCORE_API void db_post_batch_begin (struct dbCommon *prec);
+DBCORE_API void db_post_batch_flush (struct dbCommon *prec);
+DBCORE_API void db_post_batch_end (struct dbCommon *prec);
+
+typedef void EVENTWAKEFUNC (void *wake_arg);
+DBCORE_API int db_start_events_polled (
+    dbEventCtx ctx, EVENTWAKEFUNC *wake, void *arg );
+DBCORE_API void db_poll_events (dbEventCtx ctx);
 #endif
 
 typedef void EVENTFUNC (void *user_arg, struct dbChannel *chan,
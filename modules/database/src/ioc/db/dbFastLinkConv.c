@@ -65,6 +65,16 @@
  *       i.e.: do not deal with array types.
  */
 
+/* Conversions between numeric types, which are plain C casts.
+ * dbConvertFastPvt.h performs the most common of these inline.
+ */
+#define FAST_CONVERT(typea, typeb) (const void *from, void *to, \
+    const dbAddr *paddr) \
+{ \
+    *(typeb *) to = (typeb) *(const typea *) from; \
+    return 0; \
+}
+
 /*
  *  A DB_LINK that is not initialized with recGblInitFastXXXLink()
  *     will have this conversion.
@@ -369,82 +379,17 @@ static long cvt_c_st(
      const dbAddr *paddr)
 { cvtCharToString(*from, to); return(0); }
 
-/* Convert Char to Char */
-static long cvt_c_c(
-     epicsInt8 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to Unsigned Char */
-static long cvt_c_uc(
-     epicsInt8 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to Short */
-static long cvt_c_s(
-     epicsInt8 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to Unsigned Short */
-static long cvt_c_us(
-     epicsInt8 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to Long */
-static long cvt_c_l(
-     epicsInt8 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to Unsigned Long */
-static long cvt_c_ul(
-     epicsInt8 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to Int64 */
-static long cvt_c_q(
-     epicsInt8 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to UInt64 */
-static long cvt_c_uq(
-     epicsInt8 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to Float */
-static long cvt_c_f(
-     epicsInt8 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to Double */
-static long cvt_c_d(
-     epicsInt8 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Char to Enumerated */
-static long cvt_c_e(
-     epicsInt8 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_c_c FAST_CONVERT(epicsInt8, epicsInt8)
+static long cvt_c_uc FAST_CONVERT(epicsInt8, epicsUInt8)
+static long cvt_c_s FAST_CONVERT(epicsInt8, epicsInt16)
+static long cvt_c_us FAST_CONVERT(epicsInt8, epicsUInt16)
+static long cvt_c_l FAST_CONVERT(epicsInt8, epicsInt32)
+static long cvt_c_ul FAST_CONVERT(epicsInt8, epicsUInt32)
+static long cvt_c_q FAST_CONVERT(epicsInt8, epicsInt64)
+static long cvt_c_uq FAST_CONVERT(epicsInt8, epicsUInt64)
+static long cvt_c_f FAST_CONVERT(epicsInt8, epicsFloat32)
+static long cvt_c_d FAST_CONVERT(epicsInt8, epicsFloat64)
+static long cvt_c_e FAST_CONVERT(epicsInt8, epicsEnum16)
 
 /* Convert Unsigned Char to String */
 static long cvt_uc_st(
@@ -453,82 +398,17 @@ static long cvt_uc_st(
      const dbAddr *paddr)
 { cvtUcharToString(*from, to); return(0); }
 
-/* Convert Unsigned Char to Char */
-static long cvt_uc_c(
-     epicsUInt8 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to Unsigned Char */
-static long cvt_uc_uc(
-     epicsUInt8 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to Short */
-static long cvt_uc_s(
-     epicsUInt8 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to Unsigned Short */
-static long cvt_uc_us(
-     epicsUInt8 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to Long */
-static long cvt_uc_l(
-     epicsUInt8 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to Unsigned Long */
-static long cvt_uc_ul(
-     epicsUInt8 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to Int64 */
-static long cvt_uc_q(
-     epicsUInt8 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to UInt64 */
-static long cvt_uc_uq(
-     epicsUInt8 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to Float */
-static long cvt_uc_f(
-     epicsUInt8 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to Double */
-static long cvt_uc_d(
-     epicsUInt8 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Char to Enumerated */
-static long cvt_uc_e(
-     epicsUInt8 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_uc_c FAST_CONVERT(epicsUInt8, epicsInt8)
+static long cvt_uc_uc FAST_CONVERT(epicsUInt8, epicsUInt8)
+static long cvt_uc_s FAST_CONVERT(epicsUInt8, epicsInt16)
+static long cvt_uc_us FAST_CONVERT(epicsUInt8, epicsUInt16)
+static long cvt_uc_l FAST_CONVERT(epicsUInt8, epicsInt32)
+static long cvt_uc_ul FAST_CONVERT(epicsUInt8, epicsUInt32)
+static long cvt_uc_q FAST_CONVERT(epicsUInt8, epicsInt64)
+static long cvt_uc_uq FAST_CONVERT(epicsUInt8, epicsUInt64)
+static long cvt_uc_f FAST_CONVERT(epicsUInt8, epicsFloat32)
+static long cvt_uc_d FAST_CONVERT(epicsUInt8, epicsFloat64)
+static long cvt_uc_e FAST_CONVERT(epicsUInt8, epicsEnum16)
 
 /* Convert Short to String */
 static long cvt_s_st(
@@ -537,82 +417,17 @@ static long cvt_s_st(
      const dbAddr *paddr)
 { cvtShortToString(*from, to); return(0); }
 
-/* Convert Short to Char */
-static long cvt_s_c(
-     epicsInt16 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsInt8)*from; return(0); }
-
-/* Convert Short to Unsigned Char */
-static long cvt_s_uc(
-     epicsInt16 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsUInt8)*from; return(0); }
-
-/* Convert Short to Short */
-static long cvt_s_s(
-     epicsInt16 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Short to Unsigned Short */
-static long cvt_s_us(
-     epicsInt16 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Short to Long */
-static long cvt_s_l(
-     epicsInt16 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Short to Unsigned Long */
-static long cvt_s_ul(
-     epicsInt16 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Short to Int64 */
-static long cvt_s_q(
-     epicsInt16 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Short to UInt64 */
-static long cvt_s_uq(
-     epicsInt16 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Short to Float */
-static long cvt_s_f(
-     epicsInt16 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Short to Double */
-static long cvt_s_d(
-     epicsInt16 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Short to Enumerated */
-static long cvt_s_e(
-     epicsInt16 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_s_c FAST_CONVERT(epicsInt16, epicsInt8)
+static long cvt_s_uc FAST_CONVERT(epicsInt16, epicsUInt8)
+static long cvt_s_s FAST_CONVERT(epicsInt16, epicsInt16)
+static long cvt_s_us FAST_CONVERT(epicsInt16, epicsUInt16)
+static long cvt_s_l FAST_CONVERT(epicsInt16, epicsInt32)
+static long cvt_s_ul FAST_CONVERT(epicsInt16, epicsUInt32)
+static long cvt_s_q FAST_CONVERT(epicsInt16, epicsInt64)
+static long cvt_s_uq FAST_CONVERT(epicsInt16, epicsUInt64)
+static long cvt_s_f FAST_CONVERT(epicsInt16, epicsFloat32)
+static long cvt_s_d FAST_CONVERT(epicsInt16, epicsFloat64)
+static long cvt_s_e FAST_CONVERT(epicsInt16, epicsEnum16)
 
 /* Convert Unsigned Short to String */
 static long cvt_us_st(
@@ -621,82 +436,17 @@ static long cvt_us_st(
      const dbAddr *paddr)
 { cvtUshortToString(*from, to); return(0); }
 
-/* Convert Unsigned Short to Char */
-static long cvt_us_c(
-     epicsUInt16 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsInt8)*from; return(0); }
-
-/* Convert Unsigned Short to Unsigned Char */
-static long cvt_us_uc(
-     epicsUInt16 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsUInt8)*from; return(0); }
-
-/* Convert Unsigned Short to Short */
-static long cvt_us_s(
-     epicsUInt16 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Short to Unsigned Short */
-static long cvt_us_us(
-     epicsUInt16 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Short to Long */
-static long cvt_us_l(
-     epicsUInt16 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Short to Unsigned Long */
-static long cvt_us_ul(
-     epicsUInt16 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Short to Int64 */
-static long cvt_us_q(
-     epicsUInt16 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Short to UInt64 */
-static long cvt_us_uq(
-     epicsUInt16 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Short to Float */
-static long cvt_us_f(
-     epicsUInt16 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Short to Double */
-static long cvt_us_d(
-     epicsUInt16 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Short to Enumerated */
-static long cvt_us_e(
-     epicsUInt16 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_us_c FAST_CONVERT(epicsUInt16, epicsInt8)
+static long cvt_us_uc FAST_CONVERT(epicsUInt16, epicsUInt8)
+static long cvt_us_s FAST_CONVERT(epicsUInt16, epicsInt16)
+static long cvt_us_us FAST_CONVERT(epicsUInt16, epicsUInt16)
+static long cvt_us_l FAST_CONVERT(epicsUInt16, epicsInt32)
+static long cvt_us_ul FAST_CONVERT(epicsUInt16, epicsUInt32)
+static long cvt_us_q FAST_CONVERT(epicsUInt16, epicsInt64)
+static long cvt_us_uq FAST_CONVERT(epicsUInt16, epicsUInt64)
+static long cvt_us_f FAST_CONVERT(epicsUInt16, epicsFloat32)
+static long cvt_us_d FAST_CONVERT(epicsUInt16, epicsFloat64)
+static long cvt_us_e FAST_CONVERT(epicsUInt16, epicsUInt16)
 
 /* Convert Long to String */
 static long cvt_l_st(
@@ -705,82 +455,17 @@ static long cvt_l_st(
      const dbAddr *paddr)
 { cvtLongToString(*from, to); return(0); }
 
-/* Convert Long to Char */
-static long cvt_l_c(
-     epicsInt32 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Long to Unsigned Char */
-static long cvt_l_uc(
-     epicsInt32 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Long to Short */
-static long cvt_l_s(
-     epicsInt32 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Long to Unsigned Short */
-static long cvt_l_us(
-     epicsInt32 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Long to Long */
-static long cvt_l_l(
-     epicsInt32 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Long to Unsigned Long */
-static long cvt_l_ul(
-     epicsInt32 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Long to Int64 */
-static long cvt_l_q(
-     epicsInt32 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Long to UInt64 */
-static long cvt_l_uq(
-     epicsInt32 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Long to Float */
-static long cvt_l_f(
-     epicsInt32 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=(epicsFloat32)*from; return(0); }
-
-/* Convert Long to Double */
-static long cvt_l_d(
-     epicsInt32 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Long to Enumerated */
-static long cvt_l_e(
-     epicsInt32 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_l_c FAST_CONVERT(epicsInt32, epicsInt8)
+static long cvt_l_uc FAST_CONVERT(epicsInt32, epicsUInt8)
+static long cvt_l_s FAST_CONVERT(epicsInt32, epicsInt16)
+static long cvt_l_us FAST_CONVERT(epicsInt32, epicsUInt16)
+static long cvt_l_l FAST_CONVERT(epicsInt32, epicsInt32)
+static long cvt_l_ul FAST_CONVERT(epicsInt32, epicsUInt32)
+static long cvt_l_q FAST_CONVERT(epicsInt32, epicsInt64)
+static long cvt_l_uq FAST_CONVERT(epicsInt32, epicsUInt64)
+static long cvt_l_f FAST_CONVERT(epicsInt32, epicsFloat32)
+static long cvt_l_d FAST_CONVERT(epicsInt32, epicsFloat64)
+static long cvt_l_e FAST_CONVERT(epicsInt32, epicsEnum16)
 
 /* Convert Unsigned Long to String */
 static long cvt_ul_st(
@@ -789,82 +474,17 @@ static long cvt_ul_st(
      const dbAddr *paddr)
 { cvtUlongToString(*from, to); return(0); }
 
-/* Convert Unsigned Long to Char */
-static long cvt_ul_c(
-     epicsUInt32 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Long to Unsigned Char */
-static long cvt_ul_uc(
-     epicsUInt32 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Long to Short */
-static long cvt_ul_s(
-     epicsUInt32 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Long to Unsigned Short */
-static long cvt_ul_us(
-     epicsUInt32 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Long to Long */
-static long cvt_ul_l(
-     epicsUInt32 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Long to Unsigned Long */
-static long cvt_ul_ul(
-     epicsUInt32 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Long to Int64 */
-static long cvt_ul_q(
-     epicsUInt32 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Long to UInt64 */
-static long cvt_ul_uq(
-     epicsUInt32 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Long to Float */
-static long cvt_ul_f(
-     epicsUInt32 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=(epicsFloat32)*from; return(0); }
-
-/* Convert Unsigned Long to Double */
-static long cvt_ul_d(
-     epicsUInt32 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Unsigned Long to Enumerated */
-static long cvt_ul_e(
-     epicsUInt32 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_ul_c FAST_CONVERT(epicsUInt32, epicsInt8)
+static long cvt_ul_uc FAST_CONVERT(epicsUInt32, epicsUInt8)
+static long cvt_ul_s FAST_CONVERT(epicsUInt32, epicsInt16)
+static long cvt_ul_us FAST_CONVERT(epicsUInt32, epicsUInt16)
+static long cvt_ul_l FAST_CONVERT(epicsUInt32, epicsInt32)
+static long cvt_ul_ul FAST_CONVERT(epicsUInt32, epicsUInt32)
+static long cvt_ul_q FAST_CONVERT(epicsUInt32, epicsInt64)
+static long cvt_ul_uq FAST_CONVERT(epicsUInt32, epicsUInt64)
+static long cvt_ul_f FAST_CONVERT(epicsUInt32, epicsFloat32)
+static long cvt_ul_d FAST_CONVERT(epicsUInt32, epicsFloat64)
+static long cvt_ul_e FAST_CONVERT(epicsUInt32, epicsEnum16)
 
 /* Convert Int64 to String */
 static long cvt_q_st(
@@ -873,82 +493,17 @@ static long cvt_q_st(
      const dbAddr *paddr)
 { cvtInt64ToString(*from, to); return(0); }
 
-/* Convert Int64 to Char */
-static long cvt_q_c(
-     epicsInt64 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to Unsigned Char */
-static long cvt_q_uc(
-     epicsInt64 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to Short */
-static long cvt_q_s(
-     epicsInt64 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to Unsigned Short */
-static long cvt_q_us(
-     epicsInt64 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to Long */
-static long cvt_q_l(
-     epicsInt64 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to Unsigned Long */
-static long cvt_q_ul(
-     epicsInt64 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to Int64 */
-static long cvt_q_q(
-     epicsInt64 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to UInt64 */
-static long cvt_q_uq(
-     epicsInt64 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to Float */
-static long cvt_q_f(
-     epicsInt64 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to Double */
-static long cvt_q_d(
-     epicsInt64 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Int64 to Enumerated */
-static long cvt_q_e(
-     epicsInt64 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_q_c FAST_CONVERT(epicsInt64, epicsInt8)
+static long cvt_q_uc FAST_CONVERT(epicsInt64, epicsUInt8)
+static long cvt_q_s FAST_CONVERT(epicsInt64, epicsInt16)
+static long cvt_q_us FAST_CONVERT(epicsInt64, epicsUInt16)
+static long cvt_q_l FAST_CONVERT(epicsInt64, epicsInt32)
+static long cvt_q_ul FAST_CONVERT(epicsInt64, epicsUInt32)
+static long cvt_q_q FAST_CONVERT(epicsInt64, epicsInt64)
+static long cvt_q_uq FAST_CONVERT(epicsInt64, epicsUInt64)
+static long cvt_q_f FAST_CONVERT(epicsInt64, epicsFloat32)
+static long cvt_q_d FAST_CONVERT(epicsInt64, epicsFloat64)
+static long cvt_q_e FAST_CONVERT(epicsInt64, epicsEnum16)
 
 /* Convert UInt64 to String */
 static long cvt_uq_st(
@@ -957,82 +512,17 @@ static long cvt_uq_st(
      const dbAddr *paddr)
 { cvtUInt64ToString(*from, to); return(0); }
 
-/* Convert UInt64 to Char */
-static long cvt_uq_c(
-     epicsUInt64 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to Unsigned Char */
-static long cvt_uq_uc(
-     epicsUInt64 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to Short */
-static long cvt_uq_s(
-     epicsUInt64 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to Unsigned Short */
-static long cvt_uq_us(
-     epicsUInt64 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to Long */
-static long cvt_uq_l(
-     epicsUInt64 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to Unsigned Long */
-static long cvt_uq_ul(
-     epicsUInt64 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to Int64 */
-static long cvt_uq_q(
-     epicsUInt64 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to UInt64 */
-static long cvt_uq_uq(
-     epicsUInt64 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to Float */
-static long cvt_uq_f(
-     epicsUInt64 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to Double */
-static long cvt_uq_d(
-     epicsUInt64 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert UInt64 to Enumerated */
-static long cvt_uq_e(
-     epicsUInt64 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_uq_c FAST_CONVERT(epicsUInt64, epicsInt8)
+static long cvt_uq_uc FAST_CONVERT(epicsUInt64, epicsUInt8)
+static long cvt_uq_s FAST_CONVERT(epicsUInt64, epicsInt16)
+static long cvt_uq_us FAST_CONVERT(epicsUInt64, epicsUInt16)
+static long cvt_uq_l FAST_CONVERT(epicsUInt64, epicsInt32)
+static long cvt_uq_ul FAST_CONVERT(epicsUInt64, epicsUInt32)
+static long cvt_uq_q FAST_CONVERT(epicsUInt64, epicsInt64)
+static long cvt_uq_uq FAST_CONVERT(epicsUInt64, epicsUInt64)
+static long cvt_uq_f FAST_CONVERT(epicsUInt64, epicsFloat32)
+static long cvt_uq_d FAST_CONVERT(epicsUInt64, epicsFloat64)
+static long cvt_uq_e FAST_CONVERT(epicsUInt64, epicsEnum16)
 
 /* Convert Float to String */
 static long cvt_f_st(
@@ -1052,82 +542,17 @@ static long cvt_f_st(
    return(status);
  }
 
-/* Convert Float to Char */
-static long cvt_f_c(
-     epicsFloat32 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsInt8)*from; return(0); }
-
-/* Convert Float to Unsigned Char */
-static long cvt_f_uc(
-     epicsFloat32 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsUInt8)*from; return(0); }
-
-/* Convert Float to Short */
-static long cvt_f_s(
-     epicsFloat32 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=(epicsInt16)*from; return(0); }
-
-/* Convert Float to Unsigned Short */
-static long cvt_f_us(
-     epicsFloat32 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=(epicsUInt16)*from; return(0); }
-
-/* Convert Float to Long */
-static long cvt_f_l(
-     epicsFloat32 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=(epicsInt32)*from; return(0); }
-
-/* Convert Float to Unsigned Long */
-static long cvt_f_ul(
-     epicsFloat32 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=(epicsUInt32)*from; return(0); }
-
-/* Convert Float to Int64 */
-static long cvt_f_q(
-     epicsFloat32 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Float to UInt64 */
-static long cvt_f_uq(
-     epicsFloat32 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Float to Float */
-static long cvt_f_f(
-     epicsFloat32 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Float to Double */
-static long cvt_f_d(
-     epicsFloat32 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Float to Enumerated */
-static long cvt_f_e(
-     epicsFloat32 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=(epicsEnum16)*from; return(0); }
+static long cvt_f_c FAST_CONVERT(epicsFloat32, epicsInt8)
+static long cvt_f_uc FAST_CONVERT(epicsFloat32, epicsUInt8)
+static long cvt_f_s FAST_CONVERT(epicsFloat32, epicsInt16)
+static long cvt_f_us FAST_CONVERT(epicsFloat32, epicsUInt16)
+static long cvt_f_l FAST_CONVERT(epicsFloat32, epicsInt32)
+static long cvt_f_ul FAST_CONVERT(epicsFloat32, epicsUInt32)
+static long cvt_f_q FAST_CONVERT(epicsFloat32, epicsInt64)
+static long cvt_f_uq FAST_CONVERT(epicsFloat32, epicsUInt64)
+static long cvt_f_f FAST_CONVERT(epicsFloat32, epicsFloat32)
+static long cvt_f_d FAST_CONVERT(epicsFloat32, epicsFloat64)
+static long cvt_f_e FAST_CONVERT(epicsFloat32, epicsEnum16)
 
 /* Convert Double to String */
 static long cvt_d_st(
@@ -1147,61 +572,14 @@ static long cvt_d_st(
    return(status);
  }
 
-/* Convert Double to Char */
-static long cvt_d_c(
-     epicsFloat64 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsInt8)*from; return(0); }
-
-/* Convert Double to Unsigned Char */
-static long cvt_d_uc(
-     epicsFloat64 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsUInt8)*from; return(0); }
-
-/* Convert Double to Short */
-static long cvt_d_s(
-     epicsFloat64 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=(epicsInt16)*from; return(0); }
-
-/* Convert Double to Unsigned Short */
-static long cvt_d_us(
-     epicsFloat64 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=(epicsUInt16)*from; return(0); }
-
-/* Convert Double to Long */
-static long cvt_d_l(
-     epicsFloat64 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Double to Unsigned Long */
-static long cvt_d_ul(
-     epicsFloat64 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Double to Int64 */
-static long cvt_d_q(
-     epicsFloat64 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Double to UInt64 */
-static long cvt_d_uq(
-     epicsFloat64 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_d_c FAST_CONVERT(epicsFloat64, epicsInt8)
+static long cvt_d_uc FAST_CONVERT(epicsFloat64, epicsUInt8)
+static long cvt_d_s FAST_CONVERT(epicsFloat64, epicsInt16)
+static long cvt_d_us FAST_CONVERT(epicsFloat64, epicsUInt16)
+static long cvt_d_l FAST_CONVERT(epicsFloat64, epicsInt32)
+static long cvt_d_ul FAST_CONVERT(epicsFloat64, epicsUInt32)
+static long cvt_d_q FAST_CONVERT(epicsFloat64, epicsInt64)
+static long cvt_d_uq FAST_CONVERT(epicsFloat64, epicsUInt64)
 
 /* Convert Double to Float */
 static long cvt_d_f(
@@ -1210,96 +588,19 @@ static long cvt_d_f(
      const dbAddr *paddr)
 { *to = epicsConvertDoubleToFloat(*from); return 0;}
 
-/* Convert Double to Double */
-static long cvt_d_d(
-     epicsFloat64 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Double to Enumerated */
-static long cvt_d_e(
-     epicsFloat64 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=(epicsEnum16)*from; return(0); }
-
-/* Convert Enumerated to Char */
-static long cvt_e_c(
-     epicsEnum16 *from,
-     epicsInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsInt8)*from; return(0); }
-
-/* Convert Enumerated to Unsigned Char */
-static long cvt_e_uc(
-     epicsEnum16 *from,
-     epicsUInt8 *to,
-     const dbAddr *paddr)
- { *to=(epicsUInt8)*from; return(0); }
-
-/* Convert Enumerated to Short */
-static long cvt_e_s(
-     epicsEnum16 *from,
-     epicsInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Enumerated to Unsigned Short */
-static long cvt_e_us(
-     epicsEnum16 *from,
-     epicsUInt16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Enumerated to Long */
-static long cvt_e_l(
-     epicsEnum16 *from,
-     epicsInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Enumerated to Unsigned Long */
-static long cvt_e_ul(
-     epicsEnum16 *from,
-     epicsUInt32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Enumerated to Int64 */
-static long cvt_e_q(
-     epicsEnum16 *from,
-     epicsInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Enumerated to UInt64 */
-static long cvt_e_uq(
-     epicsEnum16 *from,
-     epicsUInt64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Enumerated to Float */
-static long cvt_e_f(
-     epicsEnum16 *from,
-     epicsFloat32 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Enumerated to Double */
-static long cvt_e_d(
-     epicsEnum16 *from,
-     epicsFloat64 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
-
-/* Convert Enumerated to Enumerated */
-static long cvt_e_e(
-     epicsEnum16 *from,
-     epicsEnum16 *to,
-     const dbAddr *paddr)
- { *to=*from; return(0); }
+static long cvt_d_d FAST_CONVERT(epicsFloat64, epicsFloat64)
+static long cvt_d_e FAST_CONVERT(epicsFloat64, epicsEnum16)
+static long cvt_e_c FAST_CONVERT(epicsEnum16, epicsInt8)
+static long cvt_e_uc FAST_CONVERT(epicsEnum16, epicsUInt8)
+static long cvt_e_s FAST_CONVERT(epicsEnum16, epicsInt16)
+static long cvt_e_us FAST_CONVERT(epicsEnum16, epicsUInt16)
+static long cvt_e_l FAST_CONVERT(epicsEnum16, epicsInt32)
+static long cvt_e_ul FAST_CONVERT(epicsEnum16, epicsUInt32)
+static long cvt_e_q FAST_CONVERT(epicsEnum16, epicsInt64)
+static long cvt_e_uq FAST_CONVERT(epicsEnum16, epicsUInt64)
+static long cvt_e_f FAST_CONVERT(epicsEnum16, epicsFloat32)
+static long cvt_e_d FAST_CONVERT(epicsEnum16, epicsFloat64)
+static long cvt_e_e FAST_CONVERT(epicsEnum16, epicsEnum16)
 
 /* Convert Choices And Enumerated Types To String ... */
 
@@ -17,6 +17,7 @@
 #include "dbStaticPvt.h"
 #include "dbBkpt.h"
 #include "dbCaTest.h"
+#include "dbChannel.h"
 #include "dbEvent.h"
 #include "dbIocRegister.h"
 #include "dbJLink.h"
@@ -401,6 +402,21 @@ static const iocshFuncDef dblsrFuncDef = {"dblsr",2,dblsrArgs,
 static void dblsrCallFunc(const iocshArgBuf *args)
 { dblsr(args[0].sval,args[1].ival);}
 
+/* dblsc */
+static const iocshArg dblscArg0 = { "count",iocshArgInt};
+static const iocshArg dblscArg1 = { "interest level",iocshArgInt};
+static const iocshArg * const dblscArgs[2] = {&dblscArg0,&dblscArg1};
+static const iocshFuncDef dblscFuncDef = {"dblsc",2,dblscArgs,
+                                          "Database Lockset contention report.\n"
+                                          "Rank the lock sets by the time threads spent waiting to lock them.\n"
+                                          "Statistics are only collected while dbLockProfile is non-zero.\n"
+                                          "count          - Number of lock sets to show (default 10).\n"
+                                          "interest level 0 - Show lock set statistics only.\n"
+                                          "               1 - Also show the database links which merged each lock set.\n\n"
+                                          "Example: dblsc 5 1\n"};
+static void dblscCallFunc(const iocshArgBuf *args)
+{ dblsc(args[0].ival,args[1].ival);}
+
 /* dbLockShowLocked */
 static const iocshArg dbLockShowLockedArg0 = { "interest level",iocshArgInt};
 static const iocshArg * const dbLockShowLockedArgs[1] = {&dbLockShowLockedArg0};
@@ -437,6 +453,48 @@ static void scanOnceQueueShowCallFunc(const iocshArgBuf *args)
     scanOnceQueueShow(args[0].ival);
 }
 
+/* dbChannelLookupCacheShow */
+static const iocshArg dbChannelLookupCacheShowArg0 = { "reset",iocshArgInt};
+static const iocshArg * const dbChannelLookupCacheShowArgs[1] =
+    {&dbChannelLookupCacheShowArg0};
+static const iocshFuncDef dbChannelLookupCacheShowFuncDef = {"dbChannelLookupCacheShow",1,dbChannelLookupCacheShowArgs,
+                                                             "Show the number of names in the channel name lookup cache\n"
+                                                             "and its hits, misses and evictions.\n"
+                                                             "A non-zero reset clears the counters.\n"};
+static void dbChannelLookupCacheShowCallFunc(const iocshArgBuf *args)
+{
+    dbChannelLookupCacheShow(args[0].ival);
+}
+
+/* scanParallelThreads */
+static const iocshArg scanParallelThreadsArg0 = { "no of threads",iocshArgInt};
+static const iocshArg * const scanParallelThreadsArgs[1] =
+    {&scanParallelThreadsArg0};
+static const iocshFuncDef scanParallelThreadsFuncDef = {"scanParallelThreads",1,scanParallelThreadsArgs,
+                                                        "Process each periodic scan list on a pool of threads,\n"
+                                                        "partitioned by lock set.  0 (default) scans serially,\n"
+                                                        "a negative count is relative to the number of CPUs.\n"
+                                                        "Must be called before iocInit().\n"};
+static void scanParallelThreadsCallFunc(const iocshArgBuf *args)
+{
+    scanParallelThreads(args[0].ival);
+}
+
+/* scanPeriodSlices */
+static const iocshArg scanPeriodSlicesArg0 = { "period",iocshArgString};
+static const iocshArg scanPeriodSlicesArg1 = { "no of slices",iocshArgInt};
+static const iocshArg * const scanPeriodSlicesArgs[2] =
+    {&scanPeriodSlicesArg0,&scanPeriodSlicesArg1};
+static const iocshFuncDef scanPeriodSlicesFuncDef = {"scanPeriodSlices",2,scanPeriodSlicesArgs,
+                                                     "Spread the records of a periodic scan list over the period\n"
+                                                     "in slices, selected by a hash of each record name.\n"
+                                                     "period is a menuScan choice, or \"*\" for all periods.\n"
+                                                     "Must be called after dbLoadDatabase() and before iocInit().\n"};
+static void scanPeriodSlicesCallFunc(const iocshArgBuf *args)
+{
+    scanPeriodSlices(args[0].sval, args[1].ival);
+}
+
 /* scanppl */
 static const iocshArg scanpplArg0 = { "rate",iocshArgDouble};
 static const iocshArg * const scanpplArgs[1] = {&scanpplArg0};
@@ -482,6 +540,35 @@ static void callbackSetQueueSizeCallFunc(const iocshArgBuf *args)
     callbackSetQueueSize(args[0].ival);
 }
 
+/* callbackSetQueueEngine */
+static const iocshArg callbackSetQueueEngineArg0 = { "engine",iocshArgString};
+static const iocshArg * const callbackSetQueueEngineArgs[1] =
+    {&callbackSetQueueEngineArg0};
+static const iocshFuncDef callbackSetQueueEngineFuncDef = {"callbackSetQueueEngine",1,callbackSetQueueEngineArgs,
+                                                           "Select the queue used by callback workers.\n"
+                                                           "\"ring\" (default) shares one locked ring buffer per priority,\n"
+                                                           "\"steal\" gives each worker a lock-free queue and lets idle\n"
+                                                           "workers steal from busy ones.\n"
+                                                           "Must be called before iocInit().\n"};
+static void callbackSetQueueEngineCallFunc(const iocshArgBuf *args)
+{
+    callbackSetQueueEngine(args[0].sval);
+}
+
+/* callbackSetBatchSize */
+static const iocshArg callbackSetBatchSizeArg0 = { "size",iocshArgInt};
+static const iocshArg * const callbackSetBatchSizeArgs[1] =
+    {&callbackSetBatchSizeArg0};
+static const iocshFuncDef callbackSetBatchSizeFuncDef = {"callbackSetBatchSize",1,callbackSetBatchSizeArgs,
+                                                         "Let callback workers take up to size requests per wake-up,\n"
+                                                         "and only wake workers when none is already running.\n"
+                                                         "A size of 1 (default) disables batching.\n"
+                                                         "Must be called before iocInit().\n"};
+static void callbackSetBatchSizeCallFunc(const iocshArgBuf *args)
+{
+    callbackSetBatchSize(args[0].ival);
+}
+
 /* callbackQueueShow */
 static const iocshArg callbackQueueShowArg0 = { "reset", iocshArgInt};
 static const iocshArg * const callbackQueueShowArgs[1] =
@@ -605,16 +692,22 @@ void dbIocRegister(void)
     iocshRegister(&dbPutAttrFuncDef,dbPutAttrCallFunc);
     iocshRegister(&tpnFuncDef,tpnCallFunc);
     iocshRegister(&dblsrFuncDef,dblsrCallFunc);
+    iocshRegister(&dblscFuncDef,dblscCallFunc);
     iocshRegister(&dbLockShowLockedFuncDef,dbLockShowLockedCallFunc);
 
     iocshRegister(&scanOnceSetQueueSizeFuncDef,scanOnceSetQueueSizeCallFunc);
     iocshRegister(&scanOnceQueueShowFuncDef,scanOnceQueueShowCallFunc);
+    iocshRegister(&dbChannelLookupCacheShowFuncDef,dbChannelLookupCacheShowCallFunc);
+    iocshRegister(&scanParallelThreadsFuncDef,scanParallelThreadsCallFunc);
+    iocshRegister(&scanPeriodSlicesFuncDef,scanPeriodSlicesCallFunc);
     iocshRegister(&scanpplFuncDef,scanpplCallFunc);
     iocshRegister(&scanpelFuncDef,scanpelCallFunc);
     iocshRegister(&postEventFuncDef,postEventCallFunc);
     iocshRegister(&scanpiolFuncDef,scanpiolCallFunc);
 
     iocshRegister(&callbackSetQueueSizeFuncDef,callbackSetQueueSizeCallFunc);
+    iocshRegister(&callbackSetQueueEngineFuncDef,callbackSetQueueEngineCallFunc);
+    iocshRegister(&callbackSetBatchSizeFuncDef,callbackSetBatchSizeCallFunc);
     iocshRegister(&callbackQueueShowFuncDef,callbackQueueShowCallFunc);
     iocshRegister(&callbackParallelThreadsFuncDef,callbackParallelThreadsCallFunc);
 
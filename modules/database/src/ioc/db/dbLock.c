@@ -23,6 +23,7 @@
 #include "epicsSpin.h"
 #include "epicsStdio.h"
 #include "epicsThread.h"
+#include "epicsTime.h"
 #include "errMdef.h"
 
 #include "dbAccessDefs.h"
@@ -30,10 +31,14 @@
 #include "dbBase.h"
 #include "dbLink.h"
 #include "dbCommon.h"
+#include "dbChannel.h"
+#include "dbDbLink.h"
 #include "dbFldTypes.h"
 #include "dbLockPvt.h"
 #include "dbStaticLib.h"
 #include "link.h"
+#include "special.h"
+#include "epicsExport.h"
 
 typedef struct dbScanLockNode dbScanLockNode;
 
@@ -56,6 +61,17 @@ static epicsMutexId lockSetsGuard;
 static size_t recomputeCnt;
 #endif
 
+/* Collect lockSet contention statistics for dblsc() */
+int dbLockProfile = 0;
+epicsExportAddress(int,dbLockProfile);
+
+/* Try scalar dbGetField() without the lock, cf. dbScanLockRead() */
+int dbLockOptimisticGet = 0;
+epicsExportAddress(int,dbLockOptimisticGet);
+
+/* Optimistic reads to attempt before locking */
+#define LOCKREAD_TRIES 3
+
 /*private routines */
 static void dbLockOnce(void* ignore)
 {
@@ -116,6 +132,13 @@ unsigned long dbLockCountSets(void)
     return count;
 }
 
+static void freeMergeList(lockSet *ls)
+{
+    ELLNODE *cur;
+    while((cur=ellGet(&ls->mergeList))!=NULL)
+        free(CONTAINER(cur, lockSetLink, node));
+}
+
 /* caller must lock accessLock.*/
 void dbLockIncRef(lockSet* ls)
 {
@@ -148,6 +171,10 @@ void dbLockDecRef(lockSet *ls)
                     ls, ellCount(&ls->lockRecordList));
     }
 
+    freeMergeList(ls);
+    ls->holder = NULL;
+    memset(&ls->stats, 0, sizeof(ls->stats));
+
     epicsMutexUnlock(ls->lock);
 
     epicsMutexMustLock(lockSetsGuard);
@@ -181,9 +208,78 @@ unsigned long dbLockGetLockId(dbCommon *precord)
     return id;
 }
 
+/* Lock ls->lock.  When profiling, returns non-zero if another
+ * thread held the lock and adds the time spent waiting to *pwait.
+ */
+static int lockSetLock(lockSet *ls, epicsUInt64 *pwait)
+{
+    epicsUInt64 start;
+
+    if(!dbLockProfile) {
+        epicsMutexMustLock(ls->lock);
+        return 0;
+    }
+    if(epicsMutexTryLock(ls->lock)==epicsMutexLockOK)
+        return 0;
+
+    start = epicsMonotonicGet();
+    epicsMutexMustLock(ls->lock);
+    *pwait += epicsMonotonicGet() - start;
+    return 1;
+}
+
+/* Called with ls->lock held after each successful lockSetLock() */
+static void lockSetAcquired(lockSet *ls, dbCommon *prec,
+                            int contended, epicsUInt64 wait)
+{
+    if(ls->depth++)
+        return; /* recursive lock */
+
+    /* seq becomes odd before any record is modified */
+    epicsAtomicSetSizeT(&ls->seq, ls->seq+1);
+
+    if(!dbLockProfile)
+        return;
+
+    ls->stats.nLock++;
+    if(contended) {
+        ls->stats.nContend++;
+        ls->stats.waitTotal += wait;
+        if(wait > ls->stats.waitMax)
+            ls->stats.waitMax = wait;
+    }
+    ls->holder = prec;
+    ls->lockStart = epicsMonotonicGet();
+}
+
+/* Called with ls->lock held before each unlock */
+static void lockSetReleasing(lockSet *ls)
+{
+    epicsUInt64 hold;
+
+    assert(ls->depth>0);
+    if(--ls->depth)
+        return;
+
+    /* seq becomes even after all record modifications */
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetSizeT(&ls->seq, ls->seq+1);
+
+    if(!ls->lockStart)
+        return;
+
+    hold = epicsMonotonicGet() - ls->lockStart;
+    if(hold > ls->stats.holdMax) {
+        ls->stats.holdMax = hold;
+        ls->stats.holdMaxRec = ls->holder;
+    }
+    ls->lockStart = 0;
+}
+
 void dbScanLock(dbCommon *precord)
 {
-    int cnt;
+    int cnt, contended = 0;
+    epicsUInt64 wait = 0;
     lockRecord * const lr = precord->lset;
     lockSet *ls;
 
@@ -193,7 +289,7 @@ void dbScanLock(dbCommon *precord)
     assert(epicsAtomicGetIntT(&ls->refcount)>0);
 
 retry:
-    epicsMutexMustLock(ls->lock);
+    contended |= lockSetLock(ls, &wait);
 
     epicsSpinLock(lr->spin);
     if(ls!=lr->plockSet) {
@@ -221,6 +317,8 @@ retry:
     cnt = epicsAtomicDecrIntT(&ls->refcount);
     assert(cnt>0);
 
+    lockSetAcquired(ls, precord, contended, wait);
+
 #ifdef LOCKSET_DEBUG
     if(ls->owner) {
         assert(ls->owner==epicsThreadGetIdSelf());
@@ -234,6 +332,57 @@ retry:
 #endif
 }
 
+int dbLockCanReadOptimistic(const dbAddr *paddr, short dbrType,
+                            long options, const void *pfl)
+{
+    /* numeric scalars, which need no record support to convert */
+    return dbLockOptimisticGet && !pfl &&
+        paddr->field_type >= DBF_CHAR && paddr->field_type <= DBF_DOUBLE &&
+        paddr->no_elements == 1 &&
+        paddr->special != SPC_ATTRIBUTE &&
+        paddr->pfldDes->special != SPC_DBADDR &&
+        dbrType >= DBR_CHAR && dbrType <= DBR_ENUM &&
+        !(options & ~(DBR_STATUS | DBR_TIME));
+}
+
+long dbScanLockRead(dbCommon *precord, dbLockReadFn *readfn, void *arg)
+{
+    lockRecord * const lr = precord->lset;
+    int tries;
+    long status;
+
+    for(tries=0; tries<LOCKREAD_TRIES; tries++) {
+        lockSet *ls;
+        size_t seq;
+        int valid;
+
+        epicsSpinLock(lr->spin);
+        ls = lr->plockSet;
+        seq = epicsAtomicGetSizeT(&ls->seq);
+        epicsSpinUnlock(lr->spin);
+
+        if(seq&1)
+            break; /* locked, wait for the lock instead */
+
+        epicsAtomicReadMemoryBarrier();
+        status = readfn(arg);
+        epicsAtomicReadMemoryBarrier();
+
+        /* if the lockRecord has moved, then ls was locked meanwhile */
+        epicsSpinLock(lr->spin);
+        valid = ls==lr->plockSet && epicsAtomicGetSizeT(&ls->seq)==seq;
+        epicsSpinUnlock(lr->spin);
+
+        if(valid)
+            return status;
+    }
+
+    dbScanLock(precord);
+    status = readfn(arg);
+    dbScanUnlock(precord);
+    return status;
+}
+
 void dbScanUnlock(dbCommon *precord)
 {
     lockSet *ls = precord->lset->plockSet;
@@ -245,6 +394,7 @@ void dbScanUnlock(dbCommon *precord)
     if(ls->ownercount==0)
         ls->owner = NULL;
 #endif
+    lockSetReleasing(ls);
     epicsMutexUnlock(ls->lock);
     dbLockDecRef(ls);
 }
@@ -400,6 +550,8 @@ retry:
 
     for(i=0, plock=NULL; i<nlock; i++) {
         lockRecordRef *ref = &locker->refs[i];
+        epicsUInt64 wait = 0;
+        int contended;
 
         /* skip duplicates (same lockSet
          * referenced by more than one lockRecord).
@@ -409,7 +561,8 @@ retry:
             continue;
         plock = ref->plockSet;
 
-        epicsMutexMustLock(plock->lock);
+        contended = lockSetLock(plock, &wait);
+        lockSetAcquired(plock, ref->plr->precord, contended, wait);
         assert(plock->ownerlocker==NULL);
         plock->ownerlocker = locker;
         ellAdd(&locker->locked, &plock->lockernode);
@@ -465,6 +618,7 @@ void dbScanUnlockMany(dbLocker* locker)
             plock->owner = NULL;
 #endif
 
+        lockSetReleasing(plock);
         epicsMutexUnlock(plock->lock);
         /* release ref for locked list */
         dbLockDecRef(plock);
@@ -570,6 +724,7 @@ void dbLockCleanupRecords(dbBase *pdbbase)
 
         assert(ls->refcount==0);
         assert(ellCount(&ls->lockRecordList)==0);
+        assert(ellCount(&ls->mergeList)==0);
         epicsMutexDestroy(ls->lock);
         free(ls);
     }
@@ -636,6 +791,17 @@ void dbLockSetMerge(dbLocker *locker, dbCommon *pfirst, dbCommon *psecond)
      */
     assert(epicsAtomicGetIntT(&B->refcount)>=Nb+(locker?1:0));
 
+    /* when profiling, remember which links joined the records now in A */
+    ellConcat(&A->mergeList, &B->mergeList);
+    if(dbLockProfile) {
+        lockSetLink *plink = malloc(sizeof(*plink));
+        if(plink) {
+            plink->pfirst = pfirst;
+            plink->psecond = psecond;
+            ellAdd(&A->mergeList, &plink->node);
+        }
+    }
+
     /* update ref counters. for lockRecords */
     epicsAtomicAddIntT(&A->refcount, Nb);
     epicsAtomicAddIntT(&B->refcount, -Nb+1); /* drop all but one ref, see below */
@@ -657,6 +823,14 @@ void dbLockSetMerge(dbLocker *locker, dbCommon *pfirst, dbCommon *psecond)
         B->ownerlocker = NULL;
         epicsAtomicDecrIntT(&B->refcount);
 
+        /* any recursive locks of B will be released through A */
+        if(B->depth)
+            A->depth += B->depth - 1;
+        B->depth = 0;
+        B->lockStart = 0;
+        if(B->seq&1)
+            epicsAtomicSetSizeT(&B->seq, B->seq+1);
+
         epicsMutexUnlock(B->lock);
     }
 
@@ -740,7 +914,7 @@ void dbLockSetSplit(dbLocker *locker, dbCommon *pfirst, dbCommon *psecond)
                 if(plink->type!=DB_LINK)
                     continue;
 
-                chan = plink->value.pv_link.pvt;
+                chan = dbDbLinkChannel(plink);
                 lr = dbChannelRecord(chan)->lset;
                 assert(lr);
 
@@ -802,6 +976,9 @@ void dbLockSetSplit(dbLocker *locker, dbCommon *pfirst, dbCommon *psecond)
         splitset->ownerlocker = locker;
 
         assert(splitset->refcount==1);
+        splitset->depth = 1;
+        if(!(splitset->seq&1))
+            epicsAtomicSetSizeT(&splitset->seq, splitset->seq+1);
 
 #ifdef LOCKSET_DEBUG
         splitset->owner = ls->owner;
@@ -839,6 +1016,25 @@ void dbLockSetSplit(dbLocker *locker, dbCommon *pfirst, dbCommon *psecond)
 
         assert(splitset->refcount>=ellCount(&splitset->lockRecordList)+1);
 
+        /* move merging links with both ends in the new lockSet.
+         * Those which span both are no longer joining anything.
+         */
+        cur = ellFirst(&ls->mergeList);
+        while(cur) {
+            lockSetLink *plink = CONTAINER(cur, lockSetLink, node);
+            int first = plink->pfirst->lset->plockSet==splitset,
+                second = plink->psecond->lset->plockSet==splitset;
+
+            cur = ellNext(cur);
+            if(!first && !second)
+                continue;
+            ellDelete(&ls->mergeList, &plink->node);
+            if(first && second)
+                ellAdd(&splitset->mergeList, &plink->node);
+            else
+                free(plink);
+        }
+
         assert(psecond->lset->plockSet==splitset);
 
         /* must have refs from pfirst lockRecord,
@@ -914,11 +1110,11 @@ long dblsr(char *recordname,int level)
             printf("%s\n",precord->name);
             if(level<=1) continue;
             for(link=0; (link<pdbRecordType->no_links) ; link++) {
-                DBADDR  *pdbAddr;
+                dbChannel *chan;
                 pdbFldDes = pdbRecordType->papFldDes[pdbRecordType->link_ind[link]];
                 plink = (DBLINK *)((char *)precord + pdbFldDes->offset);
                 if(plink->type != DB_LINK) continue;
-                pdbAddr = (DBADDR *)(plink->value.pv_link.pvt);
+                chan = dbDbLinkChannel(plink);
                 printf("\t%s",pdbFldDes->name);
                 if(pdbFldDes->field_type==DBF_INLINK) {
                     printf("\t INLINK");
@@ -930,7 +1126,7 @@ long dblsr(char *recordname,int level)
                 printf(" %s %s",
                     ((plink->value.pv_link.pvlMask&pvlOptPP)?" PP":"NPP"),
                     msstring[plink->value.pv_link.pvlMask&pvlOptMsMode]);
-                printf(" %s\n",pdbAddr->precord->name);
+                printf(" %s\n",dbChannelRecord(chan)->name);
             }
         }
         if(recordname) break;
@@ -938,6 +1134,113 @@ long dblsr(char *recordname,int level)
     return 0;
 }
 
+static int lsccompare(const void *rawA, const void *rawB)
+{
+    const lockSet *A = *(const lockSet * const *)rawA,
+                  *B = *(const lockSet * const *)rawB;
+    /* most time spent waiting first */
+    if(A->stats.waitTotal != B->stats.waitTotal)
+        return A->stats.waitTotal > B->stats.waitTotal ? -1 : 1;
+    if(A->stats.nContend != B->stats.nContend)
+        return A->stats.nContend > B->stats.nContend ? -1 : 1;
+    if(A->stats.nLock != B->stats.nLock)
+        return A->stats.nLock > B->stats.nLock ? -1 : 1;
+    return 0;
+}
+
+static void dblscLinks(lockSet *plockSet)
+{
+    ELLNODE *cur;
+
+    epicsMutexMustLock(plockSet->lock);
+    for(cur = ellFirst(&plockSet->mergeList); cur; cur = ellNext(cur)) {
+        lockSetLink *pmerge = CONTAINER(cur, lockSetLink, node);
+        dbCommon *precord = pmerge->pfirst;
+        dbRecordType *pdbRecordType = precord->rdes;
+        int link;
+
+        /* name the link field(s) in pfirst which still target psecond */
+        for(link=0; link<pdbRecordType->no_links; link++) {
+            dbFldDes *pdbFldDes = pdbRecordType->papFldDes[pdbRecordType->link_ind[link]];
+            DBLINK *plink = (DBLINK *)((char *)precord + pdbFldDes->offset);
+
+            if(plink->type != DB_LINK ||
+               dbChannelRecord(dbDbLinkChannel(plink)) != pmerge->psecond)
+                continue;
+            printf("\t%s.%s -> %s\n", precord->name, pdbFldDes->name,
+                pmerge->psecond->name);
+        }
+    }
+    epicsMutexUnlock(plockSet->lock);
+}
+
+long dblsc(int count, int level)
+{
+    lockSet **sets;
+    int i, nsets = 0;
+    ELLNODE *cur;
+
+    epicsThreadOnce(&dbLockOnceInit, &dbLockOnce, NULL);
+
+    if(count <= 0)
+        count = 10;
+
+    epicsMutexMustLock(lockSetsGuard);
+    sets = malloc((ellCount(&lockSetsActive)+1)*sizeof(*sets));
+    if(!sets) {
+        epicsMutexUnlock(lockSetsGuard);
+        printf("Out of memory\n");
+        return 0;
+    }
+    for(cur = ellFirst(&lockSetsActive); cur; cur = ellNext(cur)) {
+        lockSet *plockSet = CONTAINER(cur, lockSet, node);
+        if(plockSet->stats.nLock)
+            sets[nsets++] = plockSet;
+    }
+    qsort(sets, nsets, sizeof(*sets), &lsccompare);
+    if(nsets > count)
+        nsets = count;
+    /* keep the top entries alive while printing without lockSetsGuard.
+     * Skip any which are concurrently being released.
+     */
+    for(i=0; i<nsets; i++) {
+        int cnt = epicsAtomicGetIntT(&sets[i]->refcount);
+        while(cnt > 0) {
+            int prev = epicsAtomicCmpAndSwapIntT(&sets[i]->refcount, cnt, cnt+1);
+            if(prev == cnt)
+                break;
+            cnt = prev;
+        }
+        if(cnt <= 0)
+            sets[i] = NULL;
+    }
+    epicsMutexUnlock(lockSetsGuard);
+
+    if(!dbLockProfile)
+        printf("Lock set profiling is disabled, set dbLockProfile=1 to enable\n");
+
+    for(i=0; i<nsets; i++) {
+        lockSet *plockSet = sets[i];
+        lockSetStats stats;
+
+        if(!plockSet)
+            continue;
+        stats = plockSet->stats;
+
+        printf("%2d Lock Set %lu %d members %lu locks %lu contended",
+            i+1, plockSet->id, ellCount(&plockSet->lockRecordList),
+            stats.nLock, stats.nContend);
+        printf(" wait %.3f ms (max %.3f ms) hold max %.3f ms by %s\n",
+            stats.waitTotal*1e-6, stats.waitMax*1e-6, stats.holdMax*1e-6,
+            stats.holdMaxRec ? stats.holdMaxRec->name : "-");
+        if(level>=1)
+            dblscLinks(plockSet);
+        dbLockDecRef(plockSet);
+    }
+    free(sets);
+    return 0;
+}
+
 long dbLockShowLocked(int level)
 {
     int     indListType;
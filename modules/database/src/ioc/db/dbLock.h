@@ -98,6 +98,14 @@ DBCORE_API long dblsr(char *recordname,int level);
 
 DBCORE_API long dbLockShowLocked(int level);
 
+/* Lock Set Contention report, requires dbLockProfile */
+DBCORE_API long dblsc(int count,int level);
+/* count = number of lock sets to show, ranked by time spent waiting */
+/* level = (0,1) (lock set statistics, + DB links which merged it) */
+
+DBCORE_API extern int dbLockProfile;
+DBCORE_API extern int dbLockOptimisticGet;
+
 /*KLUDGE to support field TPRO*/
 DBCORE_API int * dbLockSetAddrTrace(struct dbCommon *precord);
 
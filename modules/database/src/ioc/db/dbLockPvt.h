@@ -12,6 +12,7 @@
 #include "dbLock.h"
 #include "epicsMutex.h"
 #include "epicsSpin.h"
+#include "epicsTypes.h"
 
 /* Define to enable additional error checking */
 #undef LOCKSET_DEBUG
@@ -22,6 +23,25 @@
 /* Define to disable use of recomputeCnt optimization */
 #undef LOCKSET_NOCNT
 
+/* Contention statistics, collected while dbLockProfile is set.
+ * Times are in nanoseconds.
+ */
+typedef struct {
+    unsigned long       nLock;      /* (non-recursive) acquisitions */
+    unsigned long       nContend;   /* acquisitions which had to wait */
+    epicsUInt64         waitTotal;
+    epicsUInt64         waitMax;
+    epicsUInt64         holdMax;
+    struct dbCommon    *holdMaxRec; /* record locked during longest hold */
+} lockSetStats;
+
+/* A DB link which caused two lockSets to be merged */
+typedef struct {
+    ELLNODE             node;       /* in lockSet::mergeList */
+    struct dbCommon    *pfirst;     /* link from pfirst to psecond */
+    struct dbCommon    *psecond;
+} lockSetLink;
+
 /* except for refcount (and lock), all members of dbLockSet
  * are guarded by its lock.
  */
@@ -40,6 +60,16 @@ typedef struct dbLockSet {
     ELLNODE             lockernode;
 
     int                 trace; /*For field TPRO*/
+
+    /* sequence count for dbScanLockRead(), odd while locked.
+     * Only changed while lock is held.
+     */
+    size_t              seq;
+    unsigned            depth;      /* recursive lock count */
+    epicsUInt64         lockStart;  /* 0 unless this hold is being timed */
+    struct dbCommon    *holder;     /* record named in outermost lock */
+    lockSetStats        stats;
+    ELLLIST             mergeList;  /* holds lockSetLink::node */
 } lockSet;
 
 struct lockRecord;
@@ -88,6 +118,8 @@ struct dbLocker {
     lockRecordRef refs[DBLOCKER_NALLOC]; /* actual length is maxrefs */
 };
 
+struct dbAddr;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -106,6 +138,21 @@ void dbLockerPrepare(struct dbLocker *locker,
                      size_t nrecs);
 void dbLockerFinalize(dbLocker *);
 
+/* Non-zero if dbGet() from paddr with these arguments only copies
+ * plain values out of the record, so may be done with dbScanLockRead().
+ * Always zero unless dbLockOptimisticGet is set.
+ */
+int dbLockCanReadOptimistic(const struct dbAddr *paddr, short dbrType,
+                            long options, const void *pfl);
+
+/* Call readfn(arg) without locking precord, as long as no other thread
+ * locks its lock set meanwhile.  Otherwise, readfn is repeated, finally
+ * with precord locked.  So readfn may see inconsistent data, and must
+ * not follow pointers from the record, and must only write to arg.
+ */
+typedef long (dbLockReadFn)(void *arg);
+long dbScanLockRead(struct dbCommon *precord, dbLockReadFn *readfn, void *arg);
+
 void dbLockSetMerge(struct dbLocker *locker,
                     struct dbCommon *pfirst,
                     struct dbCommon *psecond);
@@ -34,6 +34,7 @@
 #include "epicsStdlib.h"
 #include "epicsString.h"
 #include "epicsThread.h"
+#include "epicsThreadPool.h"
 #include "epicsTime.h"
 #include "taskwd.h"
 
@@ -70,16 +71,35 @@ static void *exitOnce;
 
 
 /* All other scan types */
+
+/* Scanning walks an immutable array copy of the list, without holding
+ * the list lock.  A new array is built on the first scan after the list
+ * has been modified.  Each scan holds a reference, and the list holds one
+ * for its current array, so a replaced array is freed by the last scan
+ * still using it.
+ */
+typedef struct scan_entry{
+    struct dbCommon     *precord;
+    unsigned int        hash;
+} scan_entry;
+typedef struct scan_array{
+    int                 refcount;   /* use atomic */
+    int                 count;
+    scan_entry          entry[1];   /* actually count */
+} scan_array;
+
 typedef struct scan_list{
     epicsMutexId        lock;
     ELLLIST             list;
-    short               modified;/*has list been modified?*/
+    short               modified;/*has list changed since array was built?*/
+    scan_array          *array;
 } scan_list;
 /*scan_elements are allocated and the address stored in dbCommon.spvt*/
 typedef struct scan_element{
     ELLNODE             node;
     scan_list           *pscan_list;
     struct dbCommon     *precord;
+    unsigned int        hash;   /* of record name, selects periodic slice */
 } scan_element;
 
 
@@ -87,6 +107,23 @@ typedef struct scan_element{
 
 #define OVERRUN_REPORT_DELAY 10.0   /* Time between initial reports */
 #define OVERRUN_REPORT_MAX 3600.0   /* Maximum time between reports */
+
+/* Parallel periodic scanning, see scanParallelThreads().
+ * Each period the scan array is sorted into partitions by
+ * lock set, keeping the list order inside each partition.  Partitions
+ * are processed as jobs on a thread pool owned by the periodic list.
+ */
+#define PARTITIONS_PER_THREAD 4
+
+struct periodic_scan_list;
+
+typedef struct scan_partition {
+    struct periodic_scan_list *ppsl;
+    epicsJob            *job;
+    int                 first;  /* index into ppsl->sorted */
+    int                 count;
+} scan_partition;
+
 typedef struct periodic_scan_list {
     scan_list           scan_list;
     double              period;
@@ -94,8 +131,25 @@ typedef struct periodic_scan_list {
     unsigned long       overruns;
     volatile enum ctl   scanCtl;
     epicsEventId        loopEvent;
+    int                 nSlices;    /* see scanPeriodSlices() */
+    /* parallel mode only */
+    epicsThreadPool     *pool;
+    int                 nPart;
+    scan_partition      *parts;
+    int                 capacity;   /* of the arrays below */
+    struct dbCommon     **sorted;
+    unsigned int        *partOf;
 } periodic_scan_list;
 
+static int periodicParallelThreads = 0; /* parallel mode if > 0 */
+
+/* Phase-staggered periodic scanning, see scanPeriodSlices().
+ * A period with N slices wakes up N times per period, and each time
+ * processes the records whose name hash modulo N selects that slice.
+ */
+static int *periodSlices;   /* indexed by menuScan choice */
+static int nPeriodSlices;
+
 static int nPeriodic = 0;
 static periodic_scan_list **papPeriodic; /* pointer to array of pointers */
 static epicsThreadId *periodicTaskId;    /* array of thread ids */
@@ -146,7 +200,13 @@ static void ioscanInit(void);
 static void ioscanCallback(epicsCallback *pcallback);
 static void ioscanDestroy(void);
 static void printList(scan_list *psl, char *message);
+static scan_array* scanArrayGet(scan_list *psl);
+static void scanArrayRelease(scan_array *parr);
+static void scanRecord(struct dbCommon *precord, scan_list *psl);
 static void scanList(scan_list *psl);
+static void scanListSlice(scan_list *psl, unsigned int nSlices,
+    unsigned int slice);
+static void scanListParallel(periodic_scan_list *ppsl, unsigned int slice);
 static void buildScanLists(void);
 static void addToList(struct dbCommon *precord, scan_list *psl);
 static void deleteFromList(struct dbCommon *precord, scan_list *psl);
@@ -188,6 +248,10 @@ void scanCleanup(void)
     free(periodicTaskId);
     papPeriodic = NULL;
     periodicTaskId = NULL;
+
+    free(periodSlices);
+    periodSlices = NULL;
+    nPeriodSlices = 0;
 }
 
 long scanInit(void)
@@ -366,6 +430,70 @@ void scanDelete(struct dbCommon *precord)
     }
 }
 
+int scanParallelThreads(int count)
+{
+    if (papPeriodic) {
+        fprintf(stderr, "scanParallelThreads: dbScan already initialized\n");
+        return -1;
+    }
+    if (count < 0) {
+        count = epicsThreadGetCPUs() + count;
+        if (count < 1)
+            count = 1;
+    }
+    periodicParallelThreads = count;
+    return 0;
+}
+
+int scanPeriodSlices(const char *period, int slices)
+{
+    dbMenu *pmenu;
+    int i;
+
+    if (papPeriodic) {
+        fprintf(stderr, "scanPeriodSlices: dbScan already initialized\n");
+        return -1;
+    }
+    if (!pdbbase) {
+        fprintf(stderr, "scanPeriodSlices: pdbbase not set\n");
+        return -1;
+    }
+    pmenu = dbFindMenu(pdbbase, "menuScan");
+    if (!pmenu) {
+        fprintf(stderr, "scanPeriodSlices: menuScan not present\n");
+        return -1;
+    }
+    if (slices < 1)
+        slices = 1;
+
+    if (pmenu->nChoice > nPeriodSlices) {
+        int *pnew = realloc(periodSlices, pmenu->nChoice * sizeof(int));
+
+        if (!pnew) {
+            fprintf(stderr, "scanPeriodSlices: out of memory\n");
+            return -1;
+        }
+        for (i = nPeriodSlices; i < pmenu->nChoice; i++)
+            pnew[i] = 1;
+        periodSlices = pnew;
+        nPeriodSlices = pmenu->nChoice;
+    }
+
+    if (!period || !*period || strcmp(period, "*") == 0) {
+        for (i = SCAN_1ST_PERIODIC; i < pmenu->nChoice; i++)
+            periodSlices[i] = slices;
+        return 0;
+    }
+    for (i = SCAN_1ST_PERIODIC; i < pmenu->nChoice; i++) {
+        if (epicsStrCaseCmp(period, pmenu->papChoiceValue[i]) == 0) {
+            periodSlices[i] = slices;
+            return 0;
+        }
+    }
+    fprintf(stderr, "scanPeriodSlices: Unknown period \"%s\"\n", period);
+    return -1;
+}
+
 double scanPeriod(int scan) {
     periodic_scan_list *ppsl;
 
@@ -376,6 +504,30 @@ double scanPeriod(int scan) {
     return ppsl ? ppsl->period : 0.0;
 }
 
+static void printSlices(periodic_scan_list *ppsl)
+{
+    scan_list *psl = &ppsl->scan_list;
+    int *count = dbCalloc(ppsl->nSlices, sizeof(int));
+    scan_element *pse;
+    int i;
+
+    epicsMutexMustLock(psl->lock);
+    for (pse = (scan_element *)ellFirst(&psl->list); pse;
+         pse = (scan_element *)ellNext(&pse->node))
+        count[pse->hash % ppsl->nSlices]++;
+    epicsMutexUnlock(psl->lock);
+
+    printf("    Slice occupancy (%d slices of %g seconds):",
+        ppsl->nSlices, ppsl->period / ppsl->nSlices);
+    for (i = 0; i < ppsl->nSlices; i++) {
+        if (i % 10 == 0)
+            printf("\n   ");
+        printf(" %5d", count[i]);
+    }
+    printf("\n");
+    free(count);
+}
+
 int scanppl(double period)      /* print periodic scan list(s) */
 {
     dbMenu *pmenu = dbFindMenu(pdbbase, "menuScan");
@@ -404,6 +556,8 @@ int scanppl(double period)      /* print periodic scan list(s) */
         sprintf(message, "Records with SCAN = '%s' (%lu over-runs):",
             ppsl->name, ppsl->overruns);
         printList(&ppsl->scan_list, message);
+        if (ppsl->nSlices > 1 && ellCount(&ppsl->scan_list.list) > 0)
+            printSlices(ppsl);
     }
     return 0;
 }
@@ -578,6 +732,7 @@ static void ioscanDestroy(void)
         for (prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
             epicsMutexDestroy(piosh->iosl[prio].scan_list.lock);
             ellFree(&piosh->iosl[prio].scan_list.list);
+            scanArrayRelease(piosh->iosl[prio].scan_list.array);
         }
         free(piosh);
         piosh = pnext;
@@ -788,7 +943,10 @@ static void periodicTask(void *arg)
     double overtime = 0.0;
     double over_min = 0.0;
     double over_max = 0.0;
-    const double penalty = (ppsl->period >= 2) ? 1 : (ppsl->period / 2);
+    /* with slices, each wake-up has a fraction of the period */
+    const double interval = ppsl->period / ppsl->nSlices;
+    const double penalty = (interval >= 2) ? 1 : (interval / 2);
+    unsigned int slice = 0;
 
     taskwdInsert(0, NULL, NULL);
     epicsEventSignal(startStopEvent);
@@ -800,10 +958,16 @@ static void periodicTask(void *arg)
         double delay;
         epicsTimeStamp now;
 
-        if (ppsl->scanCtl == ctlRun)
-            scanList(&ppsl->scan_list);
+        if (ppsl->scanCtl == ctlRun) {
+            if (ppsl->pool)
+                scanListParallel(ppsl, slice);
+            else
+                scanListSlice(&ppsl->scan_list, ppsl->nSlices, slice);
+        }
+        if (++slice >= (unsigned int)ppsl->nSlices)
+            slice = 0;
 
-        epicsTimeAddSeconds(&next, ppsl->period);
+        epicsTimeAddSeconds(&next, interval);
         epicsTimeGetMonotonic(&now);
         delay = epicsTimeDiffInSeconds(&next, &now);
         if (delay <= 0.0) {
@@ -827,8 +991,8 @@ static void periodicTask(void *arg)
                     "\tScan processing averages %.3f seconds (%.3f .. %.3f).\n"
                     "\tOver-runs have now happened %u times in a row.\n"
                     "\tTo fix this, move some records to a slower scan rate.\n",
-                    ppsl->name, ppsl->period + overtime / overruns,
-                    ppsl->period + over_min, ppsl->period + over_max, overruns);
+                    ppsl->name, interval + overtime / overruns,
+                    interval + over_min, interval + over_max, overruns);
 
                 reported = now;
                 if (report_delay < (OVERRUN_REPORT_MAX / 2))
@@ -851,6 +1015,62 @@ static void periodicTask(void *arg)
 }
 
 
+static void scanPartitionJob(void *arg, epicsJobMode mode)
+{
+    scan_partition *ppart = (scan_partition *)arg;
+    periodic_scan_list *ppsl = ppart->ppsl;
+    struct dbCommon **pprec = &ppsl->sorted[ppart->first];
+    int i;
+
+    if (mode == epicsJobModeCleanup)
+        return;
+
+    for (i = 0; i < ppart->count; i++)
+        scanRecord(pprec[i], &ppsl->scan_list);
+}
+
+static void initParallel(periodic_scan_list *ppsl, int ind)
+{
+    epicsThreadPoolConfig conf;
+    int i;
+
+    epicsThreadPoolConfigDefaults(&conf);
+    conf.initialThreads = conf.maxThreads = periodicParallelThreads;
+    conf.workerPriority = epicsThreadPriorityScanLow + ind;
+    conf.workerStack = epicsThreadGetStackSize(epicsThreadStackBig);
+    ppsl->pool = epicsThreadPoolCreate(&conf);
+    if (!ppsl->pool) {
+        errlogPrintf("initPeriodic: Can't create thread pool for '%s', "
+            "scanning serially\n", ppsl->name);
+        return;
+    }
+
+    ppsl->nPart = periodicParallelThreads * PARTITIONS_PER_THREAD;
+    ppsl->parts = dbCalloc(ppsl->nPart, sizeof(scan_partition));
+    for (i = 0; i < ppsl->nPart; i++) {
+        ppsl->parts[i].ppsl = ppsl;
+        ppsl->parts[i].job = epicsJobCreate(ppsl->pool, scanPartitionJob,
+            &ppsl->parts[i]);
+        if (!ppsl->parts[i].job)
+            cantProceed("initPeriodic: epicsJobCreate failed\n");
+    }
+}
+
+static void deleteParallel(periodic_scan_list *ppsl)
+{
+    int i;
+
+    if (!ppsl->pool)
+        return;
+
+    for (i = 0; i < ppsl->nPart; i++)
+        epicsJobDestroy(ppsl->parts[i].job);
+    epicsThreadPoolDestroy(ppsl->pool);
+    free(ppsl->parts);
+    free(ppsl->sorted);
+    free(ppsl->partOf);
+}
+
 static void initPeriodic(void)
 {
     dbMenu *pmenu = dbFindMenu(pdbbase, "menuScan");
@@ -904,6 +1124,8 @@ static void initPeriodic(void)
         ppsl->name = choice;
         ppsl->scanCtl = ctlPause;
         ppsl->loopEvent = epicsEventMustCreate(epicsEventEmpty);
+        ppsl->nSlices = (i + SCAN_1ST_PERIODIC < nPeriodSlices) ?
+            periodSlices[i + SCAN_1ST_PERIODIC] : 1;
 
         number = ppsl->period / quantum;
         if ((ppsl->period < 2 * quantum) ||
@@ -912,6 +1134,9 @@ static void initPeriodic(void)
                 choice);
         }
 
+        if (periodicParallelThreads > 0)
+            initParallel(ppsl, i);
+
         papPeriodic[i] = ppsl;
     }
 }
@@ -924,7 +1149,9 @@ static void deletePeriodic(void)
         periodic_scan_list *ppsl = papPeriodic[i];
 
         if (!ppsl) continue;
+        deleteParallel(ppsl);
         ellFree(&ppsl->scan_list.list);
+        scanArrayRelease(ppsl->scan_list.array);
         epicsEventDestroy(ppsl->loopEvent);
         epicsMutexDestroy(ppsl->scan_list.lock);
         free(ppsl);
@@ -991,61 +1218,136 @@ static void printList(scan_list *psl, char *message)
 
 static void scanList(scan_list *psl)
 {
-    /* When reading this code remember that the call to dbProcess can result
-     * in the SCAN field being changed in an arbitrary number of records.
-     */
+    scanListSlice(psl, 1, 0);
+}
 
-    scan_element *pse;
-    scan_element *prev = NULL;
-    scan_element *next = NULL;
+static scan_array* scanArrayGet(scan_list *psl)
+{
+    scan_array *parr;
 
     epicsMutexMustLock(psl->lock);
-    psl->modified = FALSE;
-    pse = (scan_element *)ellFirst(&psl->list);
-    if (pse) next = (scan_element *)ellNext(&pse->node);
+    if (psl->modified) {
+        scan_array *pold = psl->array;
+        int count = ellCount(&psl->list);
+
+        parr = NULL;
+        if (count > 0) {
+            scan_element *pse;
+            int i = 0;
+
+            parr = dbCalloc(1, sizeof(scan_array) +
+                (count - 1) * sizeof(scan_entry));
+            parr->refcount = 1;
+            parr->count = count;
+            for (pse = (scan_element *)ellFirst(&psl->list); pse;
+                 pse = (scan_element *)ellNext(&pse->node)) {
+                parr->entry[i].precord = pse->precord;
+                parr->entry[i].hash = pse->hash;
+                i++;
+            }
+        }
+        psl->array = parr;
+        psl->modified = FALSE;
+        scanArrayRelease(pold);
+    }
+    parr = psl->array;
+    if (parr)
+        epicsAtomicIncrIntT(&parr->refcount);
     epicsMutexUnlock(psl->lock);
+    return parr;
+}
 
-    while (pse) {
-        struct dbCommon *precord = pse->precord;
+static void scanArrayRelease(scan_array *parr)
+{
+    if (parr && epicsAtomicDecrIntT(&parr->refcount) == 0)
+        free(parr);
+}
 
-        dbScanLock(precord);
+static void scanRecord(struct dbCommon *precord, scan_list *psl)
+{
+    scan_element *pse;
+
+    /* The call to dbProcess can result in the SCAN field being changed in
+     * an arbitrary number of records.  SCAN is only changed with the record
+     * locked, so this tells us whether the record left the list since the
+     * array was built.
+     */
+    dbScanLock(precord);
+    pse = precord->spvt;
+    if (pse && pse->pscan_list == psl)
         dbProcess(precord);
-        dbScanUnlock(precord);
+    dbScanUnlock(precord);
+}
 
-        epicsMutexMustLock(psl->lock);
-        if (!psl->modified) {
-            prev = pse;
-            pse = (scan_element *)ellNext(&pse->node);
-            if (pse) next = (scan_element *)ellNext(&pse->node);
-        } else if (pse->pscan_list == psl) {
-            /*This scan element is still in same scan list*/
-            prev = pse;
-            pse = (scan_element *)ellNext(&pse->node);
-            if (pse) next = (scan_element *)ellNext(&pse->node);
-            psl->modified = FALSE;
-        } else if (prev && prev->pscan_list == psl) {
-            /*Previous scan element is still in same scan list*/
-            pse = (scan_element *)ellNext(&prev->node);
-            if (pse) {
-                prev = (scan_element *)ellPrevious(&pse->node);
-                next = (scan_element *)ellNext(&pse->node);
-            }
-            psl->modified = FALSE;
-        } else if (next && next->pscan_list == psl) {
-            /*Next scan element is still in same scan list*/
-            pse = next;
-            prev = (scan_element *)ellPrevious(&pse->node);
-            next = (scan_element *)ellNext(&pse->node);
-            psl->modified = FALSE;
-        } else {
-            /*Too many changes. Just wait till next period*/
-            epicsMutexUnlock(psl->lock);
-            return;
-        }
-        epicsMutexUnlock(psl->lock);
+/* Process the records of psl with (hash % nSlices) == slice */
+static void scanListSlice(scan_list *psl, unsigned int nSlices,
+    unsigned int slice)
+{
+    scan_array *parr = scanArrayGet(psl);
+    int i;
+
+    if (!parr)
+        return;
+
+    for (i = 0; i < parr->count; i++) {
+        scan_entry *pent = &parr->entry[i];
+
+        if (nSlices <= 1 || pent->hash % nSlices == slice)
+            scanRecord(pent->precord, psl);
     }
+    scanArrayRelease(parr);
 }
-
+
+static void scanListParallel(periodic_scan_list *ppsl, unsigned int slice)
+{
+    scan_array *parr = scanArrayGet(&ppsl->scan_list);
+    int nPart = ppsl->nPart;
+    int n = 0;
+    int i;
+
+    if (!parr)
+        return;
+
+    if (parr->count > ppsl->capacity) {
+        ppsl->capacity = parr->count;
+        free(ppsl->sorted);
+        free(ppsl->partOf);
+        ppsl->sorted = dbCalloc(ppsl->capacity, sizeof(struct dbCommon *));
+        ppsl->partOf = dbCalloc(ppsl->capacity, sizeof(unsigned int));
+    }
+    for (i = 0; i < parr->count; i++) {
+        if (parr->entry[i].hash % ppsl->nSlices == slice)
+            ppsl->partOf[n++] = dbLockGetLockId(parr->entry[i].precord) % nPart;
+    }
+
+    /* Stable counting sort, so records of one lock set keep their order */
+    for (i = 0; i < nPart; i++)
+        ppsl->parts[i].count = 0;
+    for (i = 0; i < n; i++)
+        ppsl->parts[ppsl->partOf[i]].count++;
+    for (i = 0; i < nPart; i++)
+        ppsl->parts[i].first = i ? ppsl->parts[i-1].first + ppsl->parts[i-1].count : 0;
+    for (i = 0; i < nPart; i++)
+        ppsl->parts[i].count = 0;
+    for (i = 0, n = 0; i < parr->count; i++) {
+        scan_partition *ppart;
+
+        if (parr->entry[i].hash % ppsl->nSlices != slice)
+            continue;
+        ppart = &ppsl->parts[ppsl->partOf[n++]];
+        ppsl->sorted[ppart->first + ppart->count++] = parr->entry[i].precord;
+    }
+    scanArrayRelease(parr);
+
+    for (i = 0; i < nPart; i++) {
+        if (ppsl->parts[i].count == 0)
+            continue;
+        if (epicsJobQueue(ppsl->parts[i].job))
+            scanPartitionJob(&ppsl->parts[i], epicsJobModeRun);
+    }
+    epicsThreadPoolWait(ppsl->pool, -1.0);
+}
+
 static void buildScanLists(void)
 {
     dbRecordType *pdbRecordType;
@@ -1079,6 +1381,7 @@ static void addToList(struct dbCommon *precord, scan_list *psl)
         pse = dbCalloc(1, sizeof(scan_element));
         precord->spvt = pse;
         pse->precord = precord;
+        pse->hash = epicsStrHash(precord->name, 0);
     }
     pse->pscan_list = psl;
     ptemp = (scan_element *)ellLast(&psl->list);
@@ -62,6 +62,8 @@ DBCORE_API void post_event(int event);
 DBCORE_API void scanAdd(struct dbCommon *);
 DBCORE_API void scanDelete(struct dbCommon *);
 DBCORE_API double scanPeriod(int scan);
+DBCORE_API int scanParallelThreads(int count);
+DBCORE_API int scanPeriodSlices(const char *period, int slices);
 DBCORE_API int scanOnce(struct dbCommon *);
 DBCORE_API int scanOnceCallback(struct dbCommon *, once_complete cb, void *usr);
 DBCORE_API int scanOnceSetQueueSize(int size);
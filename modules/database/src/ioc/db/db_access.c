@@ -40,8 +40,10 @@
 #include "dbCommon.h"
 #include "dbEvent.h"
 #include "dbLock.h"
+#include "dbLockPvt.h"
 #include "dbNotify.h"
 #include "dbStaticLib.h"
+#include "db_convert.h"
 #include "recSup.h"
 
 
@@ -137,10 +139,10 @@ int dbChannel_get(struct dbChannel *chan,
     return result;
 }
 
-/* Performs the work of the public db_get_field API, but also returns the number
- * of elements actually copied to the buffer.  The caller is responsible for
- * zeroing the remaining part of the buffer. */
-int dbChannel_get_count(
+/* Convert the value of chan into the old DBR buffer_type.
+ * The caller must lock the record, or use a field log copy.
+ */
+static long getChannel(
     struct dbChannel *chan, int buffer_type,
     void *pbuffer, long *nRequest, void *pfl)
 {
@@ -154,8 +156,6 @@ int dbChannel_get_count(
     * in the dbAccess.c dbGet() and getOptions() routines.
     */
 
-    dbScanLock(dbChannelRecord(chan));
-
     switch(buffer_type) {
     case(oldDBR_STRING):
         status = dbChannelGet(chan, DBR_STRING, pbuffer, &zero, nRequest, pfl);
@@ -798,7 +798,72 @@ int dbChannel_get_count(
         break;
     }
 
-    dbScanUnlock(dbChannelRecord(chan));
+    return status;
+}
+
+typedef struct {
+    struct dbChannel *chan;
+    int buffer_type;
+    void *pbuffer;
+    long *nRequest;
+    long nRequestIn;
+} getChannelArgs;
+
+/* dbScanLockRead() callback, may be repeated */
+static long getChannelRead(void *raw)
+{
+    getChannelArgs *pargs = raw;
+
+    if (pargs->nRequest)
+        *pargs->nRequest = pargs->nRequestIn;
+    return getChannel(pargs->chan, pargs->buffer_type, pargs->pbuffer,
+        pargs->nRequest, NULL);
+}
+
+/* Performs the work of the public db_get_field API, but also returns the number
+ * of elements actually copied to the buffer.  The caller is responsible for
+ * zeroing the remaining part of the buffer. */
+int dbChannel_get_count(
+    struct dbChannel *chan, int buffer_type,
+    void *pbuffer, long *nRequest, void *pfl)
+{
+    db_field_log *plog = (db_field_log *) pfl;
+    long status;
+
+    /* An array copied into the field log, like a shared snapshot, is
+     * read without the record lock when the value, status and time
+     * stamp come from the field log and no conversion reads the record.
+     */
+    if (dbfl_has_copy(plog) && plog->type == dbfl_type_ref &&
+        plog->field_type != DBF_ENUM &&
+        buffer_type <= oldDBR_TIME_DOUBLE &&
+        buffer_type != oldDBR_STRING &&
+        buffer_type != oldDBR_STS_STRING &&
+        buffer_type != oldDBR_TIME_STRING) {
+        status = getChannel(chan, buffer_type, pbuffer, nRequest, pfl);
+    }
+    /* Plain, status and time requests for a numeric scalar may be
+     * read without waiting for the record lock.
+     */
+    else if (buffer_type >= 0 && buffer_type <= oldDBR_TIME_DOUBLE &&
+        dbLockCanReadOptimistic(&chan->addr,
+            dbDBRoldToDBFnew[buffer_type % (oldDBR_DOUBLE + 1)],
+            buffer_type > oldDBR_STS_DOUBLE ? DBR_STATUS | DBR_TIME :
+            buffer_type > oldDBR_DOUBLE ? DBR_STATUS : 0, pfl)) {
+        getChannelArgs args;
+
+        args.chan = chan;
+        args.buffer_type = buffer_type;
+        args.pbuffer = pbuffer;
+        args.nRequest = nRequest;
+        args.nRequestIn = nRequest ? *nRequest : 0;
+        status = dbScanLockRead(dbChannelRecord(chan), &getChannelRead, &args);
+    }
+    else {
+        dbScanLock(dbChannelRecord(chan));
+        status = getChannel(chan, buffer_type, pbuffer, nRequest, pfl);
+        dbScanUnlock(dbChannelRecord(chan));
+    }
 
     if (status) return -1;
     return 0;
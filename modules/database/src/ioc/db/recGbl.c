@@ -13,6 +13,8 @@
  *                       Andrew Johnson <anj@aps.anl.gov>
  */
 
+#define EPICS_PRIVATE_API
+
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
@@ -283,6 +285,8 @@ void recGblFwdLink(void *precord)
 {
     dbCommon *pdbc = precord;
 
+    /* Post monitors before any forward linked record is processed */
+    db_post_batch_flush(pdbc);
     dbScanFwdLink(&pdbc->flnk);
     /*Handle dbPutFieldNotify record completions*/
     if(pdbc->ppn) dbNotifyCompletion(pdbc);
@@ -167,8 +167,11 @@ typedef struct dbRecordType {
     /*The following are only available on run time system*/
     rset            *prset;
     int             rec_size;       /*record size in bytes          */
+    /*Appended to keep the offsets of the members above unchanged*/
+    struct dbFldHash *pfldHash;     /* perfect hash of field names  */
 }dbRecordType;
 
+struct dbFldHash;       /* Contents private to dbStaticLib code */
 struct dbPvd;           /* Contents private to dbPvdLib code */
 struct gphPvt;          /* Contents private to gpHashLib code */
 
@@ -778,6 +778,7 @@ static void dbRecordtypeBody(void)
             }
         }
     }
+    dbMakeFieldHash(pdbRecordType);
     /*Initialize lists*/
     ellInit(&pdbRecordType->attributeList);
     ellInit(&pdbRecordType->recList);
@@ -10,13 +10,31 @@
 
 /* dbPvdLib.c */
 
+/* The process variable directory is an open addressing hash table with
+ * linear probing.  When more than half of its slots are used a table of
+ * twice the size replaces it, and the entries of the old table are moved
+ * over a few at a time by later dbPvdAdd() calls.
+ *
+ * dbPvdFind() doesn't take any lock.  Entries are only ever copied from
+ * the old table to the new one, so a reader which searches both tables of
+ * a consistent pair (checked with the gen counter) can't miss a name.
+ * Replaced tables are kept until dbPvdFreeMem() for the same reason.
+ * Writers are serialized by a mutex.
+ *
+ * A Bloom filter over the names lets dbPvdFind() turn away most names
+ * which aren't here without probing the table, which is what most CA
+ * name searches are.  Its bits are never cleared, so it is rebuilt
+ * when it gets full, after many deletions, and by iocInit.
+ */
+
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 
 #include "dbDefs.h"
-#include "ellLib.h"
+#include "epicsAtomic.h"
 #include "epicsMutex.h"
 #include "epicsStdio.h"
 #include "epicsString.h"
@@ -25,22 +43,49 @@
 #include "dbStaticLib.h"
 #include "dbStaticPvt.h"
 
-typedef struct {
-    ELLLIST      list;
-    epicsMutexId lock;
-} dbPvdBucket;
-
-typedef struct dbPvd {
+typedef struct dbPvdTable {
+    struct dbPvdTable *retired; /* Next older table */
     unsigned int size;
     unsigned int mask;
-    dbPvdBucket **buckets;
+    PVDENTRY *slots[1];         /* [size], NULL or &tombstone if unused */
+} dbPvdTable;
+
+typedef struct dbPvdFilter {
+    struct dbPvdFilter *retired; /* Next older filter */
+    unsigned int capacity;      /* Names it was sized for */
+    unsigned int mask;          /* Number of bits - 1 */
+    size_t words[1];            /* [(mask + 1) / FILTER_WORD_BITS] */
+} dbPvdFilter;
+
+typedef struct dbPvd {
+    epicsMutexId lock;
+    int gen;                    /* Odd while table and old are changed */
+    dbPvdTable *table;
+    dbPvdTable *old;            /* Being moved into table, or NULL */
+    unsigned int moved;         /* Slots of old already moved */
+    unsigned int used;          /* Slots of table holding entries or tombstones */
+    unsigned int count;         /* Number of entries */
+    dbPvdFilter *filter;
+    unsigned int deleted;       /* Entries deleted since filter was built */
 } dbPvd;
 
+static PVDENTRY tombstone;
+
 unsigned int dbPvdHashTableSize = 0;
 
 #define MIN_SIZE 256
 #define DEFAULT_SIZE 512
-#define MAX_SIZE 65536
+#define MAX_SIZE (1u << 24)
+
+/* Old slots moved by each dbPvdAdd() */
+#define MOVE_STEP 16
+
+/* About 0.1% false positives with 5 probes at 16 bits per name */
+#define FILTER_PROBES 5
+#define FILTER_BITS_PER_NAME 16
+#define FILTER_MIN_NAMES 1024
+#define FILTER_MAX_BITS (1u << 28)
+#define FILTER_WORD_BITS (sizeof(size_t) * CHAR_BIT)
 
 
 int dbPvdTableSize(int size)
@@ -60,6 +105,193 @@ int dbPvdTableSize(int size)
     return 0;
 }
 
+static dbPvdTable *tableCreate(unsigned int size)
+{
+    dbPvdTable *ptab = dbCalloc(1,
+        sizeof(dbPvdTable) + (size - 1) * sizeof(PVDENTRY *));
+
+    ptab->size = size;
+    ptab->mask = size - 1;
+    return ptab;
+}
+
+static PVDENTRY *tableGet(dbPvdTable *ptab, unsigned int i)
+{
+    return epicsAtomicGetPtrT((EpicsAtomicPtrT *) &ptab->slots[i]);
+}
+
+static void tableSet(dbPvdTable *ptab, unsigned int i, PVDENTRY *ppvdNode)
+{
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *) &ptab->slots[i], ppvdNode);
+}
+
+static PVDENTRY *tableFind(dbPvdTable *ptab, unsigned int hash,
+    const char *name, size_t lenName)
+{
+    unsigned int i = hash & ptab->mask;
+    PVDENTRY *ppvdNode;
+
+    while ((ppvdNode = tableGet(ptab, i))) {
+        if (ppvdNode != &tombstone && ppvdNode->hash == hash) {
+            const char *recordname = ppvdNode->precnode->recordname;
+
+            if (strncmp(name, recordname, lenName) == 0 &&
+                recordname[lenName] == 0)
+                return ppvdNode;
+        }
+        i = (i + 1) & ptab->mask;
+    }
+    return NULL;
+}
+
+/* Returns 1 if a never used slot was taken */
+static int tableInsert(dbPvdTable *ptab, PVDENTRY *ppvdNode)
+{
+    unsigned int i = ppvdNode->hash & ptab->mask;
+    PVDENTRY *pslot;
+
+    while ((pslot = ptab->slots[i]) && pslot != &tombstone)
+        i = (i + 1) & ptab->mask;
+    tableSet(ptab, i, ppvdNode);
+    return pslot == NULL;
+}
+
+static void tableRemove(dbPvdTable *ptab, PVDENTRY *ppvdNode)
+{
+    unsigned int i = ppvdNode->hash & ptab->mask;
+    PVDENTRY *pslot;
+
+    while ((pslot = ptab->slots[i])) {
+        if (pslot == ppvdNode) {
+            tableSet(ptab, i, &tombstone);
+            return;
+        }
+        i = (i + 1) & ptab->mask;
+    }
+}
+
+/* Probe bit positions come from the table hash by double hashing */
+static unsigned int filterStep(unsigned int hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return hash | 1;
+}
+
+static int filterTest(const dbPvdFilter *pfilter, unsigned int hash)
+{
+    unsigned int step = filterStep(hash);
+    int i;
+
+    for (i = 0; i < FILTER_PROBES; i++, hash += step) {
+        unsigned int bit = hash & pfilter->mask;
+        size_t word = epicsAtomicGetSizeT(
+            (size_t *) &pfilter->words[bit / FILTER_WORD_BITS]);
+
+        if (!(word & ((size_t) 1 << (bit % FILTER_WORD_BITS))))
+            return 0;
+    }
+    return 1;
+}
+
+/* Writers only, holding the lock */
+static void filterAdd(dbPvdFilter *pfilter, unsigned int hash)
+{
+    unsigned int step = filterStep(hash);
+    int i;
+
+    for (i = 0; i < FILTER_PROBES; i++, hash += step) {
+        unsigned int bit = hash & pfilter->mask;
+        size_t *pword = &pfilter->words[bit / FILTER_WORD_BITS];
+
+        epicsAtomicSetSizeT(pword,
+            *pword | ((size_t) 1 << (bit % FILTER_WORD_BITS)));
+    }
+}
+
+static void filterAddTable(dbPvdFilter *pfilter, dbPvdTable *ptab)
+{
+    unsigned int h;
+
+    for (h = 0; h < ptab->size; h++) {
+        PVDENTRY *ppvdNode = ptab->slots[h];
+
+        if (ppvdNode && ppvdNode != &tombstone)
+            filterAdd(pfilter, ppvdNode->hash);
+    }
+}
+
+/* Replaces the filter with one sized for twice the current entries */
+static void filterRebuild(dbPvd *ppvd)
+{
+    unsigned int capacity = ppvd->count * 2;
+    unsigned int nbits = FILTER_WORD_BITS;
+    dbPvdFilter *pfilter;
+
+    if (capacity < FILTER_MIN_NAMES)
+        capacity = FILTER_MIN_NAMES;
+    while (nbits / FILTER_BITS_PER_NAME < capacity && nbits < FILTER_MAX_BITS)
+        nbits <<= 1;
+
+    pfilter = dbCalloc(1, sizeof(dbPvdFilter) +
+        (nbits / FILTER_WORD_BITS - 1) * sizeof(size_t));
+    pfilter->capacity = capacity;
+    pfilter->mask = nbits - 1;
+    filterAddTable(pfilter, ppvd->table);
+    if (ppvd->old)
+        filterAddTable(pfilter, ppvd->old);
+
+    /* Readers may still be using the old one */
+    pfilter->retired = ppvd->filter;
+    ppvd->deleted = 0;
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *) &ppvd->filter, pfilter);
+}
+
+/* Readers see table and old change together */
+static void pvdSwitch(dbPvd *ppvd, dbPvdTable *ptable, dbPvdTable *pold)
+{
+    epicsAtomicIncrIntT(&ppvd->gen);
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *) &ppvd->old, pold);
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *) &ppvd->table, ptable);
+    epicsAtomicIncrIntT(&ppvd->gen);
+}
+
+static void pvdMove(dbPvd *ppvd, unsigned int nslots)
+{
+    dbPvdTable *pold = ppvd->old;
+
+    if (!pold)
+        return;
+    while (nslots-- && ppvd->moved < pold->size) {
+        PVDENTRY *ppvdNode = pold->slots[ppvd->moved++];
+
+        /* Copied, the old table must keep it for readers */
+        if (ppvdNode && ppvdNode != &tombstone)
+            ppvd->used += tableInsert(ppvd->table, ppvdNode);
+    }
+    if (ppvd->moved == pold->size)
+        pvdSwitch(ppvd, ppvd->table, NULL);
+}
+
+static void pvdGrow(dbPvd *ppvd)
+{
+    dbPvdTable *ptable = ppvd->table;
+    unsigned int size = ptable->size;
+    dbPvdTable *pnew;
+
+    pvdMove(ppvd, ~0u);
+
+    /* Mostly tombstones just needs a rehash at the same size */
+    if (ppvd->count * 4 >= size)
+        size *= 2;
+    pnew = tableCreate(size);
+    pnew->retired = ptable;
+    ppvd->moved = 0;
+    ppvd->used = 0;
+    pvdSwitch(ppvd, pnew, ptable);
+}
+
 void dbPvdInitPvt(dbBase *pdbbase)
 {
     dbPvd *ppvd;
@@ -70,130 +302,160 @@ void dbPvdInitPvt(dbBase *pdbbase)
         dbPvdHashTableSize = DEFAULT_SIZE;
     }
 
-    ppvd = (dbPvd *)dbMalloc(sizeof(dbPvd));
-    ppvd->size    = dbPvdHashTableSize;
-    ppvd->mask    = dbPvdHashTableSize - 1;
-    ppvd->buckets = dbCalloc(ppvd->size, sizeof(dbPvdBucket *));
+    ppvd = dbCalloc(1, sizeof(dbPvd));
+    ppvd->lock = epicsMutexMustCreate();
+    ppvd->table = tableCreate(dbPvdHashTableSize);
+    filterRebuild(ppvd);
 
     pdbbase->ppvd = ppvd;
     return;
 }
 
-PVDENTRY *dbPvdFind(dbBase *pdbbase, const char *name, size_t lenName)
+int dbPvdMayContain(dbBase *pdbbase, const char *name, size_t lenName)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
-    PVDENTRY *ppvdNode;
+    dbPvdFilter *pfilter;
 
-    pbucket = ppvd->buckets[epicsMemHash(name, lenName, 0) & ppvd->mask];
-    if (pbucket == NULL) return NULL;
-
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        const char *recordname = ppvdNode->precnode->recordname;
+    if (!ppvd)
+        return 0;
+    pfilter = epicsAtomicGetPtrT((EpicsAtomicPtrT *) &ppvd->filter);
+    return filterTest(pfilter, epicsMemHash(name, lenName, 0));
+}
 
-        if (strncmp(name, recordname, lenName) == 0 &&
-            strlen(recordname) == lenName)
-            break;
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
-    }
-    epicsMutexUnlock(pbucket->lock);
+PVDENTRY *dbPvdFind(dbBase *pdbbase, const char *name, size_t lenName)
+{
+    dbPvd *ppvd = pdbbase->ppvd;
+    unsigned int hash = epicsMemHash(name, lenName, 0);
+    dbPvdTable *ptable, *pold;
+    PVDENTRY *ppvdNode;
+    int gen;
+
+    if (!filterTest(epicsAtomicGetPtrT((EpicsAtomicPtrT *) &ppvd->filter),
+            hash))
+        return NULL;
+
+    do {
+        while ((gen = epicsAtomicGetIntT(&ppvd->gen)) & 1)
+            ;
+        ptable = epicsAtomicGetPtrT((EpicsAtomicPtrT *) &ppvd->table);
+        pold = epicsAtomicGetPtrT((EpicsAtomicPtrT *) &ppvd->old);
+    } while (gen != epicsAtomicGetIntT(&ppvd->gen));
+
+    ppvdNode = tableFind(ptable, hash, name, lenName);
+    if (!ppvdNode && pold)
+        ppvdNode = tableFind(pold, hash, name, lenName);
     return ppvdNode;
 }
-
+
 PVDENTRY *dbPvdAdd(dbBase *pdbbase, dbRecordType *precordType,
     dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
     PVDENTRY *ppvdNode;
     char *name = precnode->recordname;
-    unsigned int h;
-
-    h = epicsStrHash(name, 0) & ppvd->mask;
-    pbucket = ppvd->buckets[h];
-    if (pbucket == NULL) {
-        pbucket = dbCalloc(1, sizeof(dbPvdBucket));
-        ellInit(&pbucket->list);
-        pbucket->lock = epicsMutexCreate();
-        ppvd->buckets[h] = pbucket;
-    }
-
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            epicsMutexUnlock(pbucket->lock);
-            return NULL;
-        }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
+    size_t lenName = strlen(name);
+    unsigned int hash = epicsMemHash(name, lenName, 0);
+
+    epicsMutexMustLock(ppvd->lock);
+    if (tableFind(ppvd->table, hash, name, lenName) ||
+        (ppvd->old && tableFind(ppvd->old, hash, name, lenName))) {
+        epicsMutexUnlock(ppvd->lock);
+        return NULL;
     }
     ppvdNode = dbCalloc(1, sizeof(PVDENTRY));
+    ppvdNode->hash = hash;
     ppvdNode->precordType = precordType;
     ppvdNode->precnode = precnode;
-    ellAdd(&pbucket->list, (ELLNODE *)ppvdNode);
-    epicsMutexUnlock(pbucket->lock);
+    ppvd->used += tableInsert(ppvd->table, ppvdNode);
+    ppvd->count++;
+    if (ppvd->count > ppvd->filter->capacity)
+        filterRebuild(ppvd);
+    else
+        filterAdd(ppvd->filter, hash);
+
+    pvdMove(ppvd, MOVE_STEP);
+    if (ppvd->used * 2 > ppvd->table->size)
+        pvdGrow(ppvd);
+    epicsMutexUnlock(ppvd->lock);
     return ppvdNode;
 }
 
 void dbPvdDelete(dbBase *pdbbase, dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
     PVDENTRY *ppvdNode;
     char *name = precnode->recordname;
-
-    pbucket = ppvd->buckets[epicsStrHash(name, 0) & ppvd->mask];
-    if (pbucket == NULL) return;
-
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (ppvdNode->precnode &&
-            ppvdNode->precnode->recordname &&
-            strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
-            free(ppvdNode);
-            break;
-        }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
+    size_t lenName;
+
+    if (!name) return;
+    lenName = strlen(name);
+
+    epicsMutexMustLock(ppvd->lock);
+    ppvdNode = dbPvdFind(pdbbase, name, lenName);
+    if (ppvdNode) {
+        tableRemove(ppvd->table, ppvdNode);
+        if (ppvd->old)
+            tableRemove(ppvd->old, ppvdNode);
+        ppvd->count--;
+        free(ppvdNode);
+        if (++ppvd->deleted > ppvd->filter->capacity / 4)
+            filterRebuild(ppvd);
     }
-    epicsMutexUnlock(pbucket->lock);
+    epicsMutexUnlock(ppvd->lock);
     return;
 }
 
 void dbPvdFreeMem(dbBase *pdbbase)
 {
     dbPvd *ppvd = pdbbase->ppvd;
+    dbPvdTable *ptab;
     unsigned int h;
 
     if (ppvd == NULL) return;
     pdbbase->ppvd = NULL;
 
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
+    epicsMutexMustLock(ppvd->lock);
+    pvdMove(ppvd, ~0u);
+    ptab = ppvd->table;
+    for (h = 0; h < ptab->size; h++) {
+        PVDENTRY *ppvdNode = ptab->slots[h];
 
-        if (pbucket == NULL) continue;
-        epicsMutexMustLock(pbucket->lock);
-        ppvd->buckets[h] = NULL;
-        while ((ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list))) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
+        if (ppvdNode && ppvdNode != &tombstone)
             free(ppvdNode);
-        }
-        epicsMutexUnlock(pbucket->lock);
-        epicsMutexDestroy(pbucket->lock);
-        free(pbucket);
     }
-    free(ppvd->buckets);
+    while (ptab) {
+        dbPvdTable *pnext = ptab->retired;
+
+        free(ptab);
+        ptab = pnext;
+    }
+    while (ppvd->filter) {
+        dbPvdFilter *pnext = ppvd->filter->retired;
+
+        free(ppvd->filter);
+        ppvd->filter = pnext;
+    }
+    epicsMutexUnlock(ppvd->lock);
+    epicsMutexDestroy(ppvd->lock);
     free(ppvd);
 }
 
+void dbPvdFilterRebuild(dbBase *pdbbase)
+{
+    dbPvd *ppvd = pdbbase->ppvd;
+
+    if (ppvd == NULL) return;
+
+    epicsMutexMustLock(ppvd->lock);
+    filterRebuild(ppvd);
+    epicsMutexUnlock(ppvd->lock);
+}
+
 void dbPvdDump(dbBase *pdbbase, int verbose)
 {
-    unsigned int empty = 0;
+    unsigned int empty = 0, tombstones = 0, maxProbe = 0;
     dbPvd *ppvd;
+    dbPvdTable *ptab;
     unsigned int h;
 
     if (!pdbbase) {
@@ -203,27 +465,35 @@ void dbPvdDump(dbBase *pdbbase, int verbose)
     ppvd = pdbbase->ppvd;
     if (ppvd == NULL) return;
 
-    printf("Process Variable Directory has %u buckets", ppvd->size);
+    epicsMutexMustLock(ppvd->lock);
+    ptab = ppvd->table;
+    printf("Process Variable Directory has %u records in %u slots",
+        ppvd->count, ptab->size);
+    if (ppvd->old)
+        printf(", %u of %u old slots moved", ppvd->moved, ppvd->old->size);
 
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
-        int i = 1;
+    for (h = 0; h < ptab->size; h++) {
+        PVDENTRY *ppvdNode = ptab->slots[h];
+        unsigned int probe;
 
-        if (pbucket == NULL) {
+        if (ppvdNode == NULL) {
             empty++;
             continue;
         }
-        epicsMutexMustLock(pbucket->lock);
-        ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-        printf("\n [%4u] %4d  ", h, ellCount(&pbucket->list));
-        while (ppvdNode && verbose) {
-            if (!(++i % 4))
-                printf("\n         ");
-            printf("  %s", ppvdNode->precnode->recordname);
-            ppvdNode = (PVDENTRY *) ellNext((ELLNODE*)ppvdNode);
+        if (ppvdNode == &tombstone) {
+            tombstones++;
+            continue;
         }
-        epicsMutexUnlock(pbucket->lock);
+        probe = (h - ppvdNode->hash) & ptab->mask;
+        if (probe > maxProbe)
+            maxProbe = probe;
+        if (verbose)
+            printf("\n [%6u] +%-3u %s", h, probe,
+                ppvdNode->precnode->recordname);
     }
-    printf("\n%u buckets empty.\n", empty);
+    printf("\n%u slots empty, %u deleted, longest probe %u.\n",
+        empty, tombstones, maxProbe);
+    printf("Name filter has %u bits for up to %u names.\n",
+        ppvd->filter->mask + 1, ppvd->filter->capacity);
+    epicsMutexUnlock(ppvd->lock);
 }
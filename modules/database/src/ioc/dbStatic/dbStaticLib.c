@@ -511,6 +511,7 @@ void dbFreeBase(dbBase *pdbbase)
         free((void *)pdbRecordType->link_ind);
         free((void *)pdbRecordType->papsortFldName);
         free((void *)pdbRecordType->sortFldInd);
+        dbFreeFieldHash(pdbRecordType);
         free((void *)pdbRecordType->papFldDes);
         free((void *)pdbRecordType);
         pdbRecordType = pdbRecordTypeNext;
@@ -1764,6 +1765,148 @@ long dbCopyRecord(DBENTRY *pdbentry,const char *newRecordName,int overWriteOK)
     return(dbFindRecord(pdbentry,newRecordName));
 }
 
+/* Perfect hash of the field names of a record type, built by hash and
+ * displace: each name hashes with seed 0 into a bucket, and every bucket
+ * has its own seed which places its names into distinct free slots.
+ * Finding a field needs two hashes and one string compare.
+ */
+typedef struct dbFldHash {
+    unsigned int nbuckets;
+    unsigned int mask;          /* Slots - 1, slots is a power of 2 */
+    unsigned short *seed;       /* [nbuckets] */
+    short *slot;                /* [mask + 1], index in papFldDes or -1 */
+} dbFldHash;
+
+#define FLDHASH_MAX_SEED 0xffff
+
+/* FNV-1a with a final mix.  epicsMemHash() is linear in its seed, so two
+ * names that collide for one seed may collide for all of them.
+ */
+static unsigned int fieldNameHash(const char *name, size_t len,
+    unsigned int seed)
+{
+    epicsUInt32 hash = 2166136261u ^ (seed * 0x9e3779b9u);
+
+    while (len--) {
+        hash ^= (unsigned char) *name++;
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bu;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+static dbFldHash * makeFieldHash(dbRecordType *precordType,
+    unsigned int nslots)
+{
+    int no_fields = precordType->no_fields;
+    dbFldHash *phash = dbCalloc(1, sizeof(dbFldHash));
+    unsigned int *bucketOf = dbCalloc(no_fields, sizeof(unsigned int));
+    unsigned int *bucketSize;
+    unsigned int *keySlot = dbCalloc(no_fields, sizeof(unsigned int));
+    short *keys = dbCalloc(no_fields, sizeof(short));
+    unsigned int maxSize = 0, size, b, i;
+    int ok = 1;
+
+    phash->nbuckets = no_fields / 2 + 1;
+    phash->mask = nslots - 1;
+    phash->seed = dbCalloc(phash->nbuckets, sizeof(unsigned short));
+    phash->slot = dbCalloc(nslots, sizeof(short));
+    for (i = 0; i < nslots; i++)
+        phash->slot[i] = -1;
+
+    bucketSize = dbCalloc(phash->nbuckets, sizeof(unsigned int));
+    for (i = 0; i < no_fields; i++) {
+        const char *name = precordType->papFldDes[i]->name;
+
+        b = fieldNameHash(name, strlen(name), 0) % phash->nbuckets;
+        bucketOf[i] = b;
+        if (++bucketSize[b] > maxSize)
+            maxSize = bucketSize[b];
+    }
+
+    /* Place the largest buckets first, while most slots are free */
+    for (size = maxSize; ok && size > 0; size--) {
+        for (b = 0; ok && b < phash->nbuckets; b++) {
+            unsigned int nkeys = 0, seed;
+
+            if (bucketSize[b] != size)
+                continue;
+            for (i = 0; i < no_fields; i++)
+                if (bucketOf[i] == b)
+                    keys[nkeys++] = i;
+
+            for (seed = 1; seed <= FLDHASH_MAX_SEED; seed++) {
+                unsigned int k, j;
+
+                for (k = 0; k < nkeys; k++) {
+                    const char *name = precordType->papFldDes[keys[k]]->name;
+
+                    keySlot[k] = fieldNameHash(name, strlen(name), seed)
+                        & phash->mask;
+                    if (phash->slot[keySlot[k]] >= 0)
+                        break;
+                    for (j = 0; j < k; j++)
+                        if (keySlot[j] == keySlot[k])
+                            break;
+                    if (j < k)
+                        break;
+                }
+                if (k == nkeys)
+                    break;
+            }
+            if (seed > FLDHASH_MAX_SEED) {
+                ok = 0;
+                break;
+            }
+            phash->seed[b] = seed;
+            for (i = 0; i < nkeys; i++)
+                phash->slot[keySlot[i]] = keys[i];
+        }
+    }
+
+    free(bucketSize);
+    free(keys);
+    free(keySlot);
+    free(bucketOf);
+    if (!ok) {
+        free(phash->seed);
+        free(phash->slot);
+        free(phash);
+        phash = NULL;
+    }
+    return phash;
+}
+
+void dbMakeFieldHash(dbRecordType *precordType)
+{
+    unsigned int nslots = 4;
+
+    dbFreeFieldHash(precordType);
+    if (precordType->no_fields <= 0)
+        return;
+    while (nslots < precordType->no_fields + precordType->no_fields / 4)
+        nslots <<= 1;
+
+    /* The binary search in dbFindFieldPart() is used if this fails */
+    precordType->pfldHash = makeFieldHash(precordType, nslots);
+    if (!precordType->pfldHash)
+        precordType->pfldHash = makeFieldHash(precordType, nslots * 2);
+}
+
+void dbFreeFieldHash(dbRecordType *precordType)
+{
+    dbFldHash *phash = precordType->pfldHash;
+
+    if (!phash)
+        return;
+    free(phash->seed);
+    free(phash->slot);
+    free(phash);
+    precordType->pfldHash = NULL;
+}
+
 long dbFindFieldPart(DBENTRY *pdbentry,const char **ppname)
 {
     dbRecordType *precordType = pdbentry->precordType;
@@ -1800,6 +1943,25 @@ long dbFindFieldPart(DBENTRY *pdbentry,const char **ppname)
         return dbGetFieldAddress(pdbentry);
     }
 
+    if (precordType->pfldHash) {
+        dbFldHash *phash = precordType->pfldHash;
+        unsigned int b = fieldNameHash(pname, nameLen, 0) % phash->nbuckets;
+        short ind = phash->slot[fieldNameHash(pname, nameLen, phash->seed[b])
+            & phash->mask];
+        dbFldDes *pflddes;
+
+        if (ind < 0)
+            return S_dbLib_fieldNotFound;
+        pflddes = precordType->papFldDes[ind];
+        if (strncmp(pflddes->name, pname, nameLen) != 0 ||
+            pflddes->name[nameLen] != 0)
+            return S_dbLib_fieldNotFound;
+        pdbentry->pflddes = pflddes;
+        pdbentry->indfield = ind;
+        *ppname = &pname[nameLen];
+        return dbGetFieldAddress(pdbentry);
+    }
+
     /* binary search through ordered field names */
     top = precordType->no_fields - 1;
     bottom = 0;
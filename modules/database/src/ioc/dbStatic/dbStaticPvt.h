@@ -28,6 +28,8 @@ dbDeviceMenu *dbGetDeviceMenu(DBENTRY *pdbentry);
 void dbFreeLinkContents(struct link *plink);
 void dbFreePath(DBBASE *pdbbase);
 int dbIsMacroOk(DBENTRY *pdbentry);
+void dbMakeFieldHash(dbRecordType *precordType);
+void dbFreeFieldHash(dbRecordType *precordType);
 
 /*The following routines have different versions for run-time no-run-time*/
 long dbAllocRecord(DBENTRY *pdbentry,const char *precordName);
@@ -105,7 +107,7 @@ typedef struct dbGuiGroup {
 /*The following are in dbPvdLib.c*/
 /*directory*/
 typedef struct{
-    ELLNODE         node;
+    unsigned int    hash;
     dbRecordType    *precordType;
     dbRecordNode    *precnode;
 }PVDENTRY;
@@ -113,6 +115,8 @@ DBCORE_API int dbPvdTableSize(int size);
 extern int dbStaticDebug;
 void dbPvdInitPvt(DBBASE *pdbbase);
 PVDENTRY *dbPvdFind(DBBASE *pdbbase,const char *name,size_t lenname);
+DBCORE_API int dbPvdMayContain(DBBASE *pdbbase,const char *name,size_t lenname);
+void dbPvdFilterRebuild(DBBASE *pdbbase);
 PVDENTRY *dbPvdAdd(DBBASE *pdbbase,dbRecordType *precordType,dbRecordNode *precnode);
 void dbPvdDelete(DBBASE *pdbbase,dbRecordNode *precnode);
 void dbPvdFreeMem(DBBASE *pdbbase);
@@ -163,6 +163,7 @@ static int iocBuild_2(void)
 
     iterateRecords(prepareLinks, NULL);
 
+    dbPvdFilterRebuild(pdbbase);
     dbLockInitRecords(pdbbase);
     initDatabase();
     dbBkptInit();
@@ -24,12 +24,14 @@
 #include <stdarg.h>
 #include <limits.h>
 
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsStdio.h"
 #include "epicsString.h"
 #include "epicsThread.h"
 #include "epicsTime.h"
+#include "epicsTimer.h"
 #include "errlog.h"
 #include "freeList.h"
 #include "osiPoolStatus.h"
@@ -425,7 +427,12 @@ static int tcp_echo_action ( caHdrLargeArray *mp,
 static int events_on_action ( caHdrLargeArray *mp,
                        void *pPayload, struct client *pClient )
 {
-    db_event_flow_ctrl_mode_off ( pClient->evuser );
+    SEND_LOCK ( pClient );
+    pClient->eventsOff = FALSE;
+    if ( ! pClient->rateLimited ) {
+        db_event_flow_ctrl_mode_off ( pClient->evuser );
+    }
+    SEND_UNLOCK ( pClient );
     return RSRV_OK;
 }
 
@@ -435,10 +442,85 @@ static int events_on_action ( caHdrLargeArray *mp,
 static int events_off_action ( caHdrLargeArray *mp,
                        void *pPayload, struct client *pClient )
 {
+    SEND_LOCK ( pClient );
+    pClient->eventsOff = TRUE;
     db_event_flow_ctrl_mode_on ( pClient->evuser );
+    SEND_UNLOCK ( pClient );
     return RSRV_OK;
 }
 
+/*
+ * rate_refill ()
+ *
+ * !! LOCK needs to applied by caller !!
+ *
+ * The budget fills at rsrvClientByteRate up to one second's worth
+ */
+static void rate_refill ( struct client *pClient )
+{
+    double rate = rsrvClientByteRate > 0 ? rsrvClientByteRate : 0.0;
+    epicsTimeStamp now;
+
+    epicsTimeGetCurrent ( &now );
+    pClient->rateCredit +=
+        rate * epicsTimeDiffInSeconds ( &now, &pClient->rateStamp );
+    if ( pClient->rateCredit > rate || rate == 0.0 ) {
+        pClient->rateCredit = rate;
+    }
+    pClient->rateStamp = now;
+}
+
+/*
+ * rsrv_rate_charge ()
+ *
+ * !! LOCK needs to applied by caller !!
+ *
+ * Once a client has sent more than its budget the event queue is put
+ * in flow control mode, so dbEvent keeps only the latest update of each
+ * subscription, until rsrv_rate_expire() finds the debt paid off.
+ */
+void rsrv_rate_charge ( struct client *pClient, ca_uint32_t nBytes )
+{
+    if ( ! pClient->rateTimer || rsrvClientByteRate <= 0 ) {
+        return;
+    }
+    rate_refill ( pClient );
+    pClient->rateCredit -= nBytes;
+    if ( pClient->rateCredit < 0.0 && ! pClient->rateLimited ) {
+        pClient->rateLimited = TRUE;
+        if ( ! pClient->eventsOff ) {
+            db_event_flow_ctrl_mode_on ( pClient->evuser );
+        }
+        epicsTimerStartDelay ( pClient->rateTimer,
+            -pClient->rateCredit / rsrvClientByteRate );
+    }
+}
+
+/*
+ * rsrv_rate_expire()
+ * (called by the rsrvTimerQueue thread)
+ */
+void rsrv_rate_expire ( void * pArg )
+{
+    struct client * pClient = pArg;
+
+    SEND_LOCK ( pClient );
+    if ( pClient->rateLimited && pClient->rateTimer ) {
+        rate_refill ( pClient );
+        if ( pClient->rateCredit < 0.0 ) {
+            epicsTimerStartDelay ( pClient->rateTimer,
+                -pClient->rateCredit / rsrvClientByteRate );
+        }
+        else {
+            pClient->rateLimited = FALSE;
+            if ( ! pClient->eventsOff ) {
+                db_event_flow_ctrl_mode_off ( pClient->evuser );
+            }
+        }
+    }
+    SEND_UNLOCK ( pClient );
+}
+
 /*
  * no_read_access_event()
  *
@@ -594,6 +676,14 @@ static void read_reply ( void *pArg, struct dbChannel *dbch,
         cas_commit_msg ( pClient, payload_size );
     }
 
+    /*
+     * Only subscription updates count against the byte rate budget,
+     * replies to gets can't be coalesced by flow control anyway.
+     */
+    if ( pevext->pdbev ) {
+        rsrv_rate_charge ( pClient, sizeof ( caHdr ) + payload_size );
+    }
+
     /*
      * Ensures timely response for events, but does queue
      * them up like db requests when the OPI does not keep up.
@@ -1452,7 +1542,12 @@ static void write_notify_reply ( struct client * pClient )
     /*
      * wakeup the TCP thread if it is waiting for a cb to complete
      */
-    epicsEventSignal ( pClient->blockSem );
+    if ( pClient->pooled ) {
+        casIoPoolResume ( pClient );
+    }
+    else {
+        epicsEventSignal ( pClient->blockSem );
+    }
 }
 
 /*
@@ -1691,7 +1786,19 @@ static int write_notify_action ( caHdrLargeArray *mp, void *pPayload,
         epicsMutexMustLock(client->putNotifyLock);
         while(pciu->pPutNotify->busy){
             epicsMutexUnlock(client->putNotifyLock);
-            status = epicsEventWaitWithTimeout(client->blockSem,60.0);
+            if ( client->pooled ) {
+                /*
+                 * don't hold up an I/O pool thread, this request
+                 * is dispatched again when the callback completes
+                 */
+                if ( casIoPoolPark ( client, 60.0 ) ) {
+                    return RSRV_OK;
+                }
+                status = epicsEventWaitTimeout;
+            }
+            else {
+                status = epicsEventWaitWithTimeout(client->blockSem,60.0);
+            }
             if ( status != epicsEventWaitOK ) {
                 char busyTmp;
                 void * asWritePvtTmp = 0;
@@ -2189,12 +2296,16 @@ static int search_reply_udp ( caHdrLargeArray *mp, void *pPayload, struct client
     }
     pName[mp->m_postsize-1] = '\0';
 
+    epicsAtomicIncrSizeT ( &rsrvSearchCount );
+
     /* Exit quickly if channel not on this node */
     if (dbChannelTest(pName)) {
         DLOG ( 2, ( "CAS: Lookup for channel \"%s\" failed\n", pName ) );
         return RSRV_OK;
     }
 
+    epicsAtomicIncrSizeT ( &rsrvSearchHits );
+
     /*
      * stop further use of server if memory becomes scarce
      */
@@ -2548,6 +2659,10 @@ int camessage ( struct client *client )
                     status = RSRV_ERROR;
                     break;
                 }
+                /* left in the buffer until casIoPoolResume() */
+                if ( client->recvParked ) {
+                    break;
+                }
             }
             else {
                 return bad_tcp_cmd_action ( &msg, pBody, client );
@@ -2555,6 +2670,14 @@ int camessage ( struct client *client )
         }
 
         client->recv.stk += msgsize;
+
+        /*
+         * the I/O pool reads no more requests from a client
+         * until it has taken the responses queued for it
+         */
+        if ( client->pooled && casSendBacklog ( client ) ) {
+            break;
+        }
     }
 
     return status;
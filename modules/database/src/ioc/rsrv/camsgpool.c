@@ -0,0 +1,712 @@
+/*************************************************************************\
+* Copyright (c) 2026 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* SPDX-License-Identifier: EPICS
+* EPICS Base is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  camsgpool.c
+ *
+ *  TCP clients when rsrvIoThreads is set: a fixed pool of threads
+ *  receives requests, sends responses and delivers the monitor updates
+ *  of all clients, instead of a camsgtask() thread and an event thread
+ *  for each client.  Every thread waits on the same epoll set.  Work for
+ *  a client, from its socket or from dbEvent, is done by one thread at
+ *  a time, see IO_ACTIVE.
+ *
+ *  Pool threads never wait for a client.  A put callback request which
+ *  finds the previous one still busy is parked, and dispatched again
+ *  when that completes.  While a client has more responses queued than
+ *  its socket takes, it is neither read from nor are its events
+ *  delivered, so dbEvent coalesces its updates as for a blocked event
+ *  thread, until the socket is writable again.  A client whose receive
+ *  runs out of network buffers isn't read from until a timer retries.
+ */
+
+#define EPICS_PRIVATE_API
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "dbDefs.h"
+#include "dbEvent.h"
+#include "epicsSignal.h"
+#include "epicsStdio.h"
+#include "epicsThread.h"
+#include "epicsTimer.h"
+#include "errlog.h"
+#include "osiSock.h"
+#include "taskwd.h"
+
+#include "rsrv.h"
+#include "server.h"
+
+#ifdef __linux__
+
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#define MAX_IO_THREADS 64
+
+/* Receives from one client per wakeup, then other clients get a turn */
+#define RECV_BATCH 8
+
+/* client::poolFlags */
+#define IO_QUEUED   0x01u   /* on ioReadyQ */
+#define IO_ACTIVE   0x02u   /* being served by a pool thread */
+#define IO_RECV     0x04u   /* socket readable, or a parked request resumed */
+#define IO_SEND     0x08u   /* socket writable */
+#define IO_EVENTS   0x10u   /* db_poll_events() has work */
+#define IO_EXPIRE   0x20u   /* a parked request may have timed out */
+#define IO_CLOSE    0x40u   /* socket error, or the server is paused */
+#define IO_RETRY    0x80u   /* receive again after running out of buffers */
+#define IO_WORK ( IO_RECV | IO_SEND | IO_EVENTS | IO_EXPIRE | IO_CLOSE | \
+                  IO_RETRY )
+
+static int ioEpollFd = -1;
+static int ioWakeFd = -1;
+static int nIoThreads;
+static epicsMutexId ioLock;
+static ELLLIST ioReadyQ = ELLLIST_INIT; /* client::poolNode */
+static epicsTimerQueueId ioTimerQueue;
+
+/*
+ * Epoll events carry the socket and a generation count rather than a
+ * client pointer, as the client may be destroyed by another thread
+ * before the event is looked at.
+ */
+static struct client **ioClients; /* by socket, guarded by ioLock */
+static unsigned ioClientsSize;
+static epicsUInt32 ioGeneration;
+
+static uint64_t ioKey ( const struct client *client )
+{
+    return ( ( uint64_t ) client->poolGen << 32 ) | ( epicsUInt32 ) client->sock;
+}
+
+/* ioLock must be held */
+static struct client * ioLookup ( uint64_t key )
+{
+    unsigned sock = ( epicsUInt32 ) key;
+    struct client *client;
+
+    if ( sock >= ioClientsSize ) {
+        return NULL;
+    }
+    client = ioClients[sock];
+    if ( client && client->poolGen != ( epicsUInt32 ) ( key >> 32 ) ) {
+        return NULL;
+    }
+    return client;
+}
+
+/*
+ * Have a pool thread serve the client, now unless one already does.
+ */
+static void ioSchedule ( struct client *client, unsigned flags )
+{
+    epicsMutexMustLock ( ioLock );
+    client->poolFlags |= flags;
+    if ( ! ( client->poolFlags & ( IO_QUEUED | IO_ACTIVE ) ) ) {
+        client->poolFlags |= IO_QUEUED;
+        ellAdd ( &ioReadyQ, &client->poolNode );
+        /* the eventfd stays readable while the queue isn't empty */
+        if ( ellCount ( &ioReadyQ ) == 1 ) {
+            uint64_t one = 1u;
+            if ( write ( ioWakeFd, &one, sizeof ( one ) ) < 0 ) {
+                errlogPrintf ( "CAS: I/O pool wakeup failed\n" );
+            }
+        }
+    }
+    epicsMutexUnlock ( ioLock );
+}
+
+static struct client * ioReadyGet ( void )
+{
+    struct client *client = NULL;
+    ELLNODE *node;
+
+    epicsMutexMustLock ( ioLock );
+    node = ellGet ( &ioReadyQ );
+    if ( node ) {
+        client = CONTAINER ( node, struct client, poolNode );
+    }
+    if ( ! ellCount ( &ioReadyQ ) ) {
+        uint64_t count;
+        if ( read ( ioWakeFd, &count, sizeof ( count ) ) < 0 && errno != EAGAIN ) {
+            errlogPrintf ( "CAS: I/O pool wakeup read failed\n" );
+        }
+    }
+    if ( client ) {
+        client->poolFlags &= ~IO_QUEUED;
+        client->poolFlags |= IO_ACTIVE;
+    }
+    epicsMutexUnlock ( ioLock );
+    return client;
+}
+
+/* EVENTWAKEFUNC, called with database locks held */
+static void ioEventWake ( void *arg )
+{
+    ioSchedule ( ( struct client * ) arg, IO_EVENTS );
+}
+
+/* parkTimer, see casIoPoolPark() */
+static void ioParkTimeout ( void *arg )
+{
+    ioSchedule ( ( struct client * ) arg, IO_EXPIRE );
+}
+
+/* recvTimer, see ioClientRecv() */
+static void ioRecvRetry ( void *arg )
+{
+    ioSchedule ( ( struct client * ) arg, IO_RETRY );
+}
+
+/*
+ * Returns true if the parked request has timed out.
+ */
+static int ioParkExpired ( struct client *client )
+{
+    epicsTimeStamp now;
+
+    if ( ! client->recvParked ) {
+        return FALSE;
+    }
+    epicsTimeGetCurrent ( &now );
+    if ( epicsTimeLessThan ( &now, &client->parkExpires ) ) {
+        /* the timer of an earlier park, which was canceled too late */
+        epicsTimerStartTime ( client->parkTimer, &client->parkExpires );
+        return FALSE;
+    }
+    client->recvParked = FALSE;
+    client->parkExpired = TRUE;
+    return TRUE;
+}
+
+static void ioClientDone ( struct client *client )
+{
+    LOCK_CLIENTQ;
+    ellDelete ( &clientQ, &client->node );
+    UNLOCK_CLIENTQ;
+
+    /* still IO_ACTIVE, so never queued again */
+    destroy_tcp_client ( client );
+}
+
+/*
+ * Read and dispatch what the client has sent, as camsgtask() would.
+ * Returns RSRV_ERROR when the client is to be disconnected.
+ */
+static int ioClientRecv ( struct client *client )
+{
+    int i;
+
+    /* requests left over when the client was parked or backlogged */
+    if ( client->recv.cnt ) {
+        client->recv.stk = 0;
+        if ( camsgProcess ( client, 0u ) != RSRV_OK ) {
+            return RSRV_ERROR;
+        }
+    }
+    client->parkExpired = FALSE;
+
+    for ( i = 0; i < RECV_BATCH; i++ ) {
+        long nchars;
+
+        if ( client->recvParked || client->recvDelayed ||
+             client->disconnect || casSendBacklog ( client ) ) {
+            break;
+        }
+
+        client->recv.stk = 0;
+        assert ( client->recv.maxstk >= client->recv.cnt );
+        nchars = recv ( client->sock, &client->recv.buf[client->recv.cnt],
+                (int) ( client->recv.maxstk - client->recv.cnt ),
+                MSG_DONTWAIT );
+        if ( nchars == 0 ) {
+            if ( CASDEBUG > 0 ) {
+                errlogPrintf ( "CAS: nill message disconnect\n" );
+            }
+            return RSRV_ERROR;
+        }
+        else if ( nchars < 0 ) {
+            int anerrno = SOCKERRNO;
+
+            if ( anerrno == SOCK_EWOULDBLOCK ) {
+                break;
+            }
+
+            if ( anerrno == SOCK_EINTR ) {
+                continue;
+            }
+
+            if ( anerrno == SOCK_ENOBUFS ) {
+                errlogPrintf (
+                    "CAS: Out of network buffers, retrying receive in 1 second\n" );
+                /* not read from until then, see ioClientServe() */
+                client->recvDelayed = TRUE;
+                epicsTimerStartDelay ( client->recvTimer, 1.0 );
+                break;
+            }
+
+            camsgRecvFailed ( anerrno );
+            return RSRV_ERROR;
+        }
+
+        if ( camsgProcess ( client, ( unsigned ) nchars ) != RSRV_OK ) {
+            return RSRV_ERROR;
+        }
+    }
+
+    return client->disconnect ? RSRV_ERROR : RSRV_OK;
+}
+
+/*
+ * Do the work scheduled for an IO_ACTIVE client until there is none
+ * left, then wait for its socket again.
+ */
+static void ioClientServe ( struct client *client )
+{
+    epicsThreadPrivateSet ( rsrvCurrentClient, client );
+
+    while ( TRUE ) {
+        struct epoll_event ev;
+        unsigned flags;
+        int backlog;
+
+        epicsMutexMustLock ( ioLock );
+        flags = client->poolFlags & IO_WORK;
+        client->poolFlags &= ~IO_WORK;
+        epicsMutexUnlock ( ioLock );
+
+        if ( ( flags & IO_CLOSE ) || castcp_ctl != ctlRun ||
+             client->disconnect ) {
+            break;
+        }
+
+        if ( ( flags & IO_EXPIRE ) && ioParkExpired ( client ) ) {
+            flags |= IO_RECV;
+        }
+        if ( flags & IO_RETRY ) {
+            client->recvDelayed = FALSE;
+            flags |= IO_RECV;
+        }
+
+        /* responses to a slow client wait for the socket, not the thread */
+        flags |= client->poolDeferred;
+        client->poolDeferred = 0u;
+        if ( casSendBacklog ( client ) ) {
+            client->poolDeferred = flags & ( IO_RECV | IO_EVENTS );
+            flags &= ~client->poolDeferred;
+        }
+
+        if ( flags & IO_EVENTS ) {
+            db_poll_events ( client->evuser );
+        }
+        if ( ( flags & IO_RECV ) && ! client->recvParked &&
+             ! client->recvDelayed ) {
+            if ( ioClientRecv ( client ) != RSRV_OK ) {
+                break;
+            }
+        }
+
+        cas_send_bs_msg ( client, TRUE );
+        if ( client->disconnect ) {
+            break;
+        }
+
+        backlog = casSendBacklog ( client );
+        if ( backlog && ( flags & IO_RECV ) ) {
+            /* ioClientRecv() may have stopped with requests unread */
+            client->poolDeferred |= IO_RECV;
+        }
+
+        ev.events = EPOLLONESHOT;
+        if ( ! client->recvParked && ! client->recvDelayed && ! backlog ) {
+            ev.events |= EPOLLIN;
+        }
+        if ( casSendQueued ( client ) ) {
+            ev.events |= EPOLLOUT;
+        }
+        ev.data.u64 = ioKey ( client );
+
+        epicsMutexMustLock ( ioLock );
+        if ( ! backlog ) {
+            client->poolFlags |= client->poolDeferred;
+            client->poolDeferred = 0u;
+        }
+        if ( client->poolFlags & IO_WORK ) {
+            epicsMutexUnlock ( ioLock );
+            continue;
+        }
+        if ( epoll_ctl ( ioEpollFd, EPOLL_CTL_MOD, client->sock, &ev ) ) {
+            epicsMutexUnlock ( ioLock );
+            errlogPrintf ( "CAS: Unable to rearm client socket\n" );
+            break;
+        }
+        client->poolFlags &= ~IO_ACTIVE;
+        epicsMutexUnlock ( ioLock );
+
+        epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+        return;
+    }
+
+    epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+    ioClientDone ( client );
+}
+
+static void ioThread ( void *pParm )
+{
+    taskwdInsert ( epicsThreadGetIdSelf (), NULL, NULL );
+    epicsSignalInstallSigAlarmIgnore ();
+    epicsSignalInstallSigPipeIgnore ();
+
+    while ( TRUE ) {
+        struct epoll_event ev;
+        struct client *client;
+        unsigned flags;
+        int status;
+
+        status = epoll_wait ( ioEpollFd, &ev, 1, -1 );
+        if ( status < 0 ) {
+            if ( errno != EINTR ) {
+                char sockErrBuf[64];
+
+                epicsSocketConvertErrnoToString (
+                    sockErrBuf, sizeof ( sockErrBuf ) );
+                errlogPrintf ( "CAS: epoll_wait " ERL_ERROR ": %s\n",
+                    sockErrBuf );
+                epicsThreadSleep ( 1.0 );
+            }
+            continue;
+        }
+        if ( status == 0 ) {
+            continue;
+        }
+
+        if ( ! ev.data.u64 ) {
+            client = ioReadyGet ();
+            if ( client ) {
+                ioClientServe ( client );
+            }
+            continue;
+        }
+
+        flags = 0u;
+        if ( ev.events & EPOLLIN ) {
+            flags |= IO_RECV;
+        }
+        if ( ev.events & EPOLLOUT ) {
+            flags |= IO_SEND;
+        }
+        if ( ev.events & ( EPOLLERR | EPOLLHUP ) ) {
+            flags |= IO_CLOSE;
+        }
+
+        epicsMutexMustLock ( ioLock );
+        client = ioLookup ( ev.data.u64 );
+        if ( ! client ) {
+            /* destroyed meanwhile */
+            epicsMutexUnlock ( ioLock );
+            continue;
+        }
+        client->poolFlags |= flags;
+        if ( client->poolFlags & ( IO_QUEUED | IO_ACTIVE ) ) {
+            /* whoever has it will do the work */
+            epicsMutexUnlock ( ioLock );
+            continue;
+        }
+        client->poolFlags |= IO_ACTIVE;
+        epicsMutexUnlock ( ioLock );
+
+        ioClientServe ( client );
+    }
+}
+
+int casIoPoolInit ( void )
+{
+    struct epoll_event ev;
+    int i, n = rsrvIoThreads;
+
+    if ( n <= 0 ) {
+        return 0;
+    }
+    if ( n > MAX_IO_THREADS ) {
+        n = MAX_IO_THREADS;
+    }
+
+    ioLock = epicsMutexMustCreate ();
+    ioTimerQueue = epicsTimerQueueAllocate ( 1,
+        epicsThreadPriorityCAServerLow );
+
+    ioEpollFd = epoll_create1 ( EPOLL_CLOEXEC );
+    ioWakeFd = eventfd ( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0u;
+    if ( ioEpollFd < 0 || ioWakeFd < 0 ||
+         epoll_ctl ( ioEpollFd, EPOLL_CTL_ADD, ioWakeFd, &ev ) ) {
+        char sockErrBuf[64];
+
+        epicsSocketConvertErrnoToString ( sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAS: epoll setup " ERL_ERROR ": %s, "
+            "using threads for each client\n", sockErrBuf );
+        n = 0;
+    }
+
+    for ( i = 0; i < n; i++ ) {
+        char name[20];
+
+        epicsSnprintf ( name, sizeof ( name ), "CAS-io%d", i );
+        if ( ! epicsThreadCreate ( name, epicsThreadPriorityCAServerLow,
+                epicsThreadGetStackSize ( epicsThreadStackBig ),
+                ioThread, NULL ) ) {
+            errlogPrintf ( "CAS: Unable to start thread %s\n", name );
+            break;
+        }
+        nIoThreads++;
+    }
+    if ( ! nIoThreads ) {
+        if ( ioEpollFd >= 0 ) {
+            close ( ioEpollFd );
+            ioEpollFd = -1;
+        }
+        if ( ioWakeFd >= 0 ) {
+            close ( ioWakeFd );
+            ioWakeFd = -1;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+static void ioTimersDestroy ( struct client *client )
+{
+    if ( client->parkTimer ) {
+        epicsTimerQueueDestroyTimer ( ioTimerQueue, client->parkTimer );
+        client->parkTimer = NULL;
+    }
+    if ( client->recvTimer ) {
+        epicsTimerQueueDestroyTimer ( ioTimerQueue, client->recvTimer );
+        client->recvTimer = NULL;
+    }
+}
+
+/*
+ * Deliver the events of a new client from the pool, instead of
+ * starting an event thread for it.
+ * Returns non-zero if the pool isn't running.
+ */
+int casIoPoolStartEvents ( struct client *client )
+{
+    if ( ! nIoThreads || ! ioTimerQueue ) {
+        return -1;
+    }
+
+    client->parkTimer = epicsTimerQueueCreateTimer ( ioTimerQueue,
+        ioParkTimeout, client );
+    client->recvTimer = epicsTimerQueueCreateTimer ( ioTimerQueue,
+        ioRecvRetry, client );
+    if ( ! client->parkTimer || ! client->recvTimer ||
+         db_start_events_polled ( client->evuser, ioEventWake, client )
+            != DB_EVENT_OK ) {
+        ioTimersDestroy ( client );
+        return -1;
+    }
+    client->pooled = TRUE;
+    return 0;
+}
+
+/*
+ * Serve a new client, already on the clientQ, from the pool.
+ * Returns non-zero on failure.
+ */
+int casIoPoolAdd ( struct client *client )
+{
+    unsigned sock = ( unsigned ) client->sock;
+    struct epoll_event ev;
+
+    epicsMutexMustLock ( ioLock );
+    if ( sock >= ioClientsSize ) {
+        unsigned size = ioClientsSize ? ioClientsSize : 64u;
+        struct client **pNew;
+
+        while ( size <= sock ) {
+            size *= 2u;
+        }
+        pNew = realloc ( ioClients, size * sizeof ( *ioClients ) );
+        if ( ! pNew ) {
+            epicsMutexUnlock ( ioLock );
+            errlogPrintf ( "CAS: Out of memory for the I/O pool\n" );
+            return -1;
+        }
+        memset ( pNew + ioClientsSize, 0,
+            ( size - ioClientsSize ) * sizeof ( *ioClients ) );
+        ioClients = pNew;
+        ioClientsSize = size;
+    }
+    /* zero identifies the wakeup eventfd */
+    if ( ! ++ioGeneration ) {
+        ++ioGeneration;
+    }
+    client->poolGen = ioGeneration;
+    ioClients[sock] = client;
+    epicsMutexUnlock ( ioLock );
+
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.u64 = ioKey ( client );
+    if ( epoll_ctl ( ioEpollFd, EPOLL_CTL_ADD, client->sock, &ev ) ) {
+        char sockErrBuf[64];
+
+        epicsSocketConvertErrnoToString ( sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAS: epoll_ctl " ERL_ERROR ": %s\n", sockErrBuf );
+        epicsMutexMustLock ( ioLock );
+        ioClients[sock] = NULL;
+        epicsMutexUnlock ( ioLock );
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Called by destroy_tcp_client()
+ */
+void casIoPoolRemove ( struct client *client )
+{
+    unsigned sock;
+
+    epicsMutexMustLock ( ioLock );
+    if ( client->sock != INVALID_SOCKET ) {
+        epoll_ctl ( ioEpollFd, EPOLL_CTL_DEL, client->sock, NULL );
+        sock = ( unsigned ) client->sock;
+    }
+    else {
+        /* a failed send closed it, look for the entry */
+        for ( sock = 0u; sock < ioClientsSize; sock++ ) {
+            if ( ioClients[sock] == client ) {
+                break;
+            }
+        }
+    }
+    if ( sock < ioClientsSize && ioClients[sock] == client ) {
+        ioClients[sock] = NULL;
+    }
+    epicsMutexUnlock ( ioLock );
+    ioTimersDestroy ( client );
+}
+
+/*
+ * Called while dispatching a request which would have to wait.  Returns
+ * true if the request is to be dispatched again on casIoPoolResume(),
+ * false once the request has been parked for timeout seconds.
+ */
+int casIoPoolPark ( struct client *client, double timeout )
+{
+    if ( client->parkExpired ) {
+        client->parkExpired = FALSE;
+        return FALSE;
+    }
+    epicsTimeGetCurrent ( &client->parkExpires );
+    epicsTimeAddSeconds ( &client->parkExpires, timeout );
+    epicsTimerStartTime ( client->parkTimer, &client->parkExpires );
+    client->recvParked = TRUE;
+    return TRUE;
+}
+
+/*
+ * Whatever the parked request waited for happened
+ */
+void casIoPoolResume ( struct client *client )
+{
+    if ( client->recvParked ) {
+        client->recvParked = FALSE;
+        epicsTimerCancel ( client->parkTimer );
+        ioSchedule ( client, IO_RECV );
+    }
+}
+
+/*
+ * Disconnect all pooled clients, called when the server is paused
+ */
+void casIoPoolStop ( void )
+{
+    struct client *client;
+
+    if ( ! nIoThreads ) {
+        return;
+    }
+
+    /* clients leave the clientQ before they are destroyed */
+    LOCK_CLIENTQ;
+    for ( client = ( struct client * ) ellFirst ( &clientQ ); client;
+          client = ( struct client * ) ellNext ( &client->node ) ) {
+        if ( client->pooled ) {
+            ioSchedule ( client, IO_CLOSE );
+        }
+    }
+    UNLOCK_CLIENTQ;
+}
+
+void casIoPoolShow ( unsigned level )
+{
+    if ( nIoThreads ) {
+        int nReady;
+
+        epicsMutexMustLock ( ioLock );
+        nReady = ellCount ( &ioReadyQ );
+        epicsMutexUnlock ( ioLock );
+
+        printf ( "TCP clients served by %d I/O thread%s, %d waiting\n",
+            nIoThreads, nIoThreads == 1 ? "" : "s", nReady );
+    }
+}
+
+#else /* __linux__ */
+
+int casIoPoolInit ( void )
+{
+    if ( rsrvIoThreads > 0 ) {
+        errlogPrintf ( "CAS: rsrvIoThreads isn't supported on this OS, "
+            "using a thread per client\n" );
+    }
+    return -1;
+}
+
+int casIoPoolStartEvents ( struct client *client )
+{
+    return -1;
+}
+
+int casIoPoolAdd ( struct client *client )
+{
+    return -1;
+}
+
+void casIoPoolRemove ( struct client *client )
+{
+}
+
+int casIoPoolPark ( struct client *client, double timeout )
+{
+    return FALSE;
+}
+
+void casIoPoolResume ( struct client *client )
+{
+}
+
+void casIoPoolStop ( void )
+{
+}
+
+void casIoPoolShow ( unsigned level )
+{
+}
+
+#endif /* __linux__ */
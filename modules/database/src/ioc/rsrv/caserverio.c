@@ -25,6 +25,7 @@
 #include "epicsSignal.h"
 #include "epicsTime.h"
 #include "errlog.h"
+#include "freeList.h"
 #include "osiSock.h"
 
 #include "caerr.h"
@@ -32,11 +33,221 @@
 
 #include "server.h"
 
+#if defined(_WIN32) || defined(vxWorks)
+#   define CAS_SEND_SEGMENTS 1
+#else
+#   include <sys/uio.h>
+#   define CAS_HAVE_SENDMSG
+#   define CAS_SEND_SEGMENTS 64
+#endif
+
+/* Bytes of full send buffers queued before building a response waits */
+#define CAS_SEND_QUEUE_MAX \
+    ( rsrvSizeofLargeBufTCP > 4 * MAX_TCP ? rsrvSizeofLargeBufTCP : 4 * MAX_TCP )
+
+/*
+ *  casSendDiscard()
+ *
+ *  Drop everything waiting to be sent, send lock must be held
+ */
+void casSendDiscard ( struct client *pclient )
+{
+    struct send_chunk *pChunk;
+
+    while ( ( pChunk = (struct send_chunk *) ellGet ( &pclient->sendQ ) ) ) {
+        casFreeBufferTCP ( pChunk->buf, pChunk->type );
+        freeListFree ( rsrvSendChunkFreeList, pChunk );
+    }
+    pclient->sendQBytes = 0u;
+    pclient->send.stk = 0u;
+    pclient->send.cnt = 0u;
+}
+
+/*
+ *  casSendSome()
+ *
+ *  One send of the queued buffers followed by the current one, as a
+ *  single gather write where that is available.  Bytes written are
+ *  released from the queue, a partial write just advances the offsets.
+ *  Returns the send() status.
+ */
+static int casSendSome ( struct client *pclient, int dontWait )
+{
+#ifdef CAS_HAVE_SENDMSG
+    struct iovec iov[CAS_SEND_SEGMENTS];
+    struct msghdr msg;
+#endif
+    struct send_chunk *pChunk = (struct send_chunk *) ellFirst ( &pclient->sendQ );
+    char *pSeg[CAS_SEND_SEGMENTS];
+    unsigned segLen[CAS_SEND_SEGMENTS];
+    unsigned nSeg = 0, done;
+    int flags = 0;
+    int status;
+
+    while ( pChunk && nSeg < CAS_SEND_SEGMENTS ) {
+        pSeg[nSeg] = &pChunk->buf[pChunk->sent];
+        segLen[nSeg++] = pChunk->stk - pChunk->sent;
+        pChunk = (struct send_chunk *) ellNext ( &pChunk->node );
+    }
+    if ( nSeg < CAS_SEND_SEGMENTS && pclient->send.stk > pclient->send.cnt ) {
+        pSeg[nSeg] = &pclient->send.buf[pclient->send.cnt];
+        segLen[nSeg++] = pclient->send.stk - pclient->send.cnt;
+    }
+    if ( ! nSeg ) {
+        return 0;
+    }
+
+#ifdef MSG_DONTWAIT
+    if ( dontWait ) {
+        flags = MSG_DONTWAIT;
+    }
+#endif
+#ifdef CAS_HAVE_SENDMSG
+    memset ( &msg, 0, sizeof ( msg ) );
+    for ( done = 0; done < nSeg; done++ ) {
+        iov[done].iov_base = pSeg[done];
+        iov[done].iov_len = segLen[done];
+    }
+    msg.msg_iov = iov;
+    msg.msg_iovlen = nSeg;
+    status = sendmsg ( pclient->sock, &msg, flags );
+#else
+    status = send ( pclient->sock, pSeg[0], segLen[0], flags );
+#endif
+    if ( status <= 0 ) {
+        return status;
+    }
+
+    done = (unsigned) status;
+    while ( done &&
+            ( pChunk = (struct send_chunk *) ellFirst ( &pclient->sendQ ) ) ) {
+        unsigned left = pChunk->stk - pChunk->sent;
+
+        if ( done < left ) {
+            pChunk->sent += done;
+            pclient->sendQBytes -= done;
+            return status;
+        }
+        done -= left;
+        pclient->sendQBytes -= left;
+        ellDelete ( &pclient->sendQ, &pChunk->node );
+        casFreeBufferTCP ( pChunk->buf, pChunk->type );
+        freeListFree ( rsrvSendChunkFreeList, pChunk );
+    }
+    pclient->send.cnt += done;
+    if ( pclient->send.cnt >= pclient->send.stk ) {
+        pclient->send.stk = 0u;
+        pclient->send.cnt = 0u;
+    }
+    return status;
+}
+
+static int casSendPending ( struct client *pclient )
+{
+    return ellCount ( &pclient->sendQ ) ||
+        pclient->send.stk > pclient->send.cnt;
+}
+
+/*
+ *  casSendQueued()
+ *
+ *  Bytes waiting to be sent
+ */
+unsigned casSendQueued ( struct client *pclient )
+{
+    unsigned nBytes;
+
+    SEND_LOCK ( pclient );
+    nBytes = pclient->sendQBytes + pclient->send.stk - pclient->send.cnt;
+    SEND_UNLOCK ( pclient );
+    return nBytes;
+}
+
+/*
+ *  casSendBacklog()
+ *
+ *  True when more is waiting to be sent than casSendMakeRoom() would
+ *  queue without waiting for the client
+ */
+int casSendBacklog ( struct client *pclient )
+{
+    return casSendQueued ( pclient ) > CAS_SEND_QUEUE_MAX;
+}
+
+/*
+ *  casSendFailed()
+ *
+ *  Mark the client disconnected after a send error, and wake up its
+ *  receive thread.
+ */
+static void casSendFailed ( struct client *pclient, int anerrno )
+{
+    int causeWasSocketHangup = 0;
+    char buf[64];
+
+    ipAddrToDottedIP ( &pclient->addr, buf, sizeof(buf) );
+
+    if (
+        anerrno == SOCK_ECONNABORTED ||
+        anerrno == SOCK_ECONNRESET ||
+        anerrno == SOCK_EPIPE ||
+        anerrno == SOCK_ETIMEDOUT ) {
+        causeWasSocketHangup = 1;
+    }
+    else {
+        char sockErrBuf[64];
+        epicsSocketConvertErrorToString (
+            sockErrBuf, sizeof ( sockErrBuf ), anerrno );
+        errlogPrintf ( "CAS: TCP send to %s failed: %s\n",
+            buf, sockErrBuf);
+    }
+    pclient->disconnect = TRUE;
+    casSendDiscard ( pclient );
+
+    /*
+     * wakeup the receive thread
+     */
+    if ( ! causeWasSocketHangup ) {
+        enum epicsSocketSystemCallInterruptMechanismQueryInfo info  =
+            epicsSocketSystemCallInterruptMechanismQuery ();
+        switch ( info ) {
+        case esscimqi_socketCloseRequired:
+            if ( pclient->sock != INVALID_SOCKET ) {
+                epicsSocketDestroy ( pclient->sock );
+                pclient->sock = INVALID_SOCKET;
+            }
+            break;
+        case esscimqi_socketBothShutdownRequired:
+            {
+                int status = shutdown ( pclient->sock, SHUT_RDWR );
+                if ( status ) {
+                    char sockErrBuf[64];
+                    epicsSocketConvertErrnoToString (
+                        sockErrBuf, sizeof ( sockErrBuf ) );
+                    errlogPrintf ("CAS: Socket shutdown " ERL_ERROR ": %s\n",
+                        sockErrBuf );
+                }
+            }
+            break;
+        case esscimqi_socketSigAlarmRequired:
+            if ( pclient->tid ) {
+                epicsSignalRaiseSigAlarm ( pclient->tid );
+            }
+            break;
+        default:
+            break;
+        };
+    }
+}
+
 /*
  *  cas_send_bs_msg()
  *
  *  (channel access server send message)
  *
+ *  Sends everything queued for the client, waiting if necessary.
+ *  Clients of the I/O pool only send what the socket takes without
+ *  waiting, the pool sends the rest once it is writable.
  *
  * Set lock_needed=1 unless SEND_LOCK() is held by caller
  */
@@ -48,8 +259,9 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
         SEND_LOCK ( pclient );
     }
 
-    if ( CASDEBUG > 2 && pclient->send.stk ) {
-        errlogPrintf ( "CAS: Sending a message of %d bytes\n", pclient->send.stk );
+    if ( CASDEBUG > 2 && casSendPending ( pclient ) ) {
+        errlogPrintf ( "CAS: Sending a message of %u bytes\n",
+            pclient->sendQBytes + pclient->send.stk - pclient->send.cnt );
     }
 
     if ( pclient->disconnect ) {
@@ -57,35 +269,24 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
             errlogPrintf ( "CAS: msg Discard for sock %d addr %x\n",
                 (int)pclient->sock, (unsigned) pclient->addr.sin_addr.s_addr );
         }
-        pclient->send.stk = 0u;
+        casSendDiscard ( pclient );
         if(lock_needed)
             SEND_UNLOCK(pclient);
         return;
     }
 
-    while ( pclient->send.stk && ! pclient->disconnect ) {
-        status = send ( pclient->sock, pclient->send.buf, pclient->send.stk, 0 );
+    while ( casSendPending ( pclient ) && ! pclient->disconnect ) {
+        status = casSendSome ( pclient, pclient->pooled );
         if ( status >= 0 ) {
-            unsigned transferSize = (unsigned) status;
-            if ( transferSize >= pclient->send.stk ) {
-                pclient->send.stk = 0;
+            if ( ! casSendPending ( pclient ) ) {
                 epicsTimeGetCurrent ( &pclient->time_at_last_send );
-                break;
-            }
-            else {
-                unsigned bytesLeft = pclient->send.stk - transferSize;
-                memmove ( pclient->send.buf, &pclient->send.buf[transferSize],
-                    bytesLeft );
-                pclient->send.stk = bytesLeft;
             }
         }
         else {
-            int causeWasSocketHangup = 0;
             int anerrno = SOCKERRNO;
-            char buf[64];
 
             if ( pclient->disconnect ) {
-                pclient->send.stk = 0u;
+                casSendDiscard ( pclient );
                 break;
             }
 
@@ -93,65 +294,26 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
                 continue;
             }
 
+            if ( anerrno == SOCK_EWOULDBLOCK && pclient->pooled ) {
+                break;
+            }
+
             if ( anerrno == SOCK_ENOBUFS ) {
                 errlogPrintf (
-                    "CAS: Out of network buffers, retrying send in 15 seconds\n" );
-                epicsThreadSleep ( 15.0 );
+                    "CAS: Out of network buffers, retrying send in 1 second\n" );
+                /* Let others queue responses meanwhile, if we can */
+                if ( lock_needed ) {
+                    SEND_UNLOCK ( pclient );
+                }
+                epicsThreadSleep ( 1.0 );
+                if ( lock_needed ) {
+                    SEND_LOCK ( pclient );
+                }
                 continue;
             }
 
-            ipAddrToDottedIP ( &pclient->addr, buf, sizeof(buf) );
-
-            if (
-                anerrno == SOCK_ECONNABORTED ||
-                anerrno == SOCK_ECONNRESET ||
-                anerrno == SOCK_EPIPE ||
-                anerrno == SOCK_ETIMEDOUT ) {
-                causeWasSocketHangup = 1;
-            }
-            else {
-                char sockErrBuf[64];
-                epicsSocketConvertErrnoToString (
-                    sockErrBuf, sizeof ( sockErrBuf ) );
-                errlogPrintf ( "CAS: TCP send to %s failed: %s\n",
-                    buf, sockErrBuf);
-            }
-            pclient->disconnect = TRUE;
-            pclient->send.stk = 0u;
-
-            /*
-             * wakeup the receive thread
-             */
-            if ( ! causeWasSocketHangup ) {
-                enum epicsSocketSystemCallInterruptMechanismQueryInfo info  =
-                    epicsSocketSystemCallInterruptMechanismQuery ();
-                switch ( info ) {
-                case esscimqi_socketCloseRequired:
-                    if ( pclient->sock != INVALID_SOCKET ) {
-                        epicsSocketDestroy ( pclient->sock );
-                        pclient->sock = INVALID_SOCKET;
-                    }
-                    break;
-                case esscimqi_socketBothShutdownRequired:
-                    {
-                        int status = shutdown ( pclient->sock, SHUT_RDWR );
-                        if ( status ) {
-                            char sockErrBuf[64];
-                            epicsSocketConvertErrnoToString (
-                                sockErrBuf, sizeof ( sockErrBuf ) );
-                            errlogPrintf ("CAS: Socket shutdown " ERL_ERROR ": %s\n",
-                                sockErrBuf );
-                        }
-                    }
-                    break;
-                case esscimqi_socketSigAlarmRequired:
-                    epicsSignalRaiseSigAlarm ( pclient->tid );
-                    break;
-                default:
-                    break;
-                };
-                break;
-            }
+            casSendFailed ( pclient, anerrno );
+            break;
         }
     }
 
@@ -164,6 +326,90 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
     return;
 }
 
+/*
+ *  casSendMakeRoom()
+ *
+ *  Make room for a TCP response of msgSize bytes, send lock must be held.
+ *  Sends what the socket will take without waiting, then queues the full
+ *  buffer and starts a new one.  Only waits for the client when too much
+ *  is queued already.  Clients of the I/O pool never wait here, instead
+ *  the pool stops serving them until the socket takes more.
+ */
+static void casSendMakeRoom ( struct client *pclient, unsigned msgSize )
+{
+    char *newbuf;
+
+    if ( casSendSome ( pclient, TRUE ) < 0 ) {
+        int anerrno = SOCKERRNO;
+
+        if ( anerrno != SOCK_EWOULDBLOCK && anerrno != SOCK_EINTR &&
+             anerrno != SOCK_ENOBUFS ) {
+            casSendFailed ( pclient, anerrno );
+            return;
+        }
+    }
+    if ( pclient->send.stk <= pclient->send.maxstk - msgSize ) {
+        return;
+    }
+
+    newbuf = NULL;
+    if ( pclient->sendQBytes + pclient->send.stk - pclient->send.cnt <=
+            CAS_SEND_QUEUE_MAX || pclient->pooled ) {
+        newbuf = (char *) freeListMalloc ( rsrvSmallBufFreeListTCP );
+    }
+    if ( newbuf ) {
+        struct send_chunk *pChunk = freeListMalloc ( rsrvSendChunkFreeList );
+
+        if ( pChunk ) {
+            pChunk->buf = pclient->send.buf;
+            pChunk->type = pclient->send.type;
+            pChunk->sent = pclient->send.cnt;
+            pChunk->stk = pclient->send.stk;
+            ellAdd ( &pclient->sendQ, &pChunk->node );
+            pclient->sendQBytes += pChunk->stk - pChunk->sent;
+
+            pclient->send.buf = newbuf;
+            pclient->send.type = mbtSmallTCP;
+            pclient->send.maxstk = MAX_TCP;
+            pclient->send.stk = 0u;
+            pclient->send.cnt = 0u;
+            if ( msgSize > MAX_TCP ) {
+                casExpandSendBuffer ( pclient, msgSize );
+            }
+            return;
+        }
+        freeListFree ( rsrvSmallBufFreeListTCP, newbuf );
+    }
+    cas_send_bs_msg ( pclient, FALSE );
+}
+
+/*
+ *  cas_frame_dg_msg()
+ *
+ *  send lock must be on while in this routine
+ *
+ *  Finishes the version message at the front of the udp message
+ *  and returns the start and size of the datagram to send
+ */
+static unsigned cas_frame_dg_msg ( struct client * pclient, char ** ppDG )
+{
+    unsigned sizeDG = pclient->send.stk;
+    char * pDG = pclient->send.buf;
+    caHdr * pMsg = ( caHdr * ) pDG;
+
+    assert ( ntohs ( pMsg->m_cmmd ) == CA_PROTO_VERSION );
+    if ( CA_V411 ( pclient->minor_version_number ) ) {
+        pMsg->m_cid = htonl ( pclient->seqNoOfReq );
+        pMsg->m_dataType = htons ( sequenceNoIsValid );
+    }
+    else {
+        pDG += sizeof (caHdr);
+        sizeDG -= sizeof (caHdr);
+    }
+    *ppDG = pDG;
+    return sizeDG;
+}
+
 /*
  *  cas_send_dg_msg()
  *
@@ -174,7 +420,6 @@ void cas_send_dg_msg ( struct client * pclient )
     int status;
     int sizeDG;
     char * pDG;
-    caHdr * pMsg;
 
     if ( CASDEBUG > 2 && pclient->send.stk ) {
         errlogPrintf ( "CAS: Sending a udp message of %d bytes\n", pclient->send.stk );
@@ -187,18 +432,7 @@ void cas_send_dg_msg ( struct client * pclient )
         return;
     }
 
-    pDG = pclient->send.buf;
-    pMsg = ( caHdr * ) pDG;
-    sizeDG = pclient->send.stk;
-    assert ( ntohs ( pMsg->m_cmmd ) == CA_PROTO_VERSION );
-    if ( CA_V411 ( pclient->minor_version_number ) ) {
-        pMsg->m_cid = htonl ( pclient->seqNoOfReq );
-        pMsg->m_dataType = htons ( sequenceNoIsValid );
-    }
-    else {
-        pDG += sizeof (caHdr);
-        sizeDG -= sizeof (caHdr);
-    }
+    sizeDG = (int) cas_frame_dg_msg ( pclient, &pDG );
 
     status = sendto ( pclient->sock, pDG, sizeDG, 0,
        (struct sockaddr *)&pclient->addr, sizeof(pclient->addr) );
@@ -235,6 +469,36 @@ void cas_send_dg_msg ( struct client * pclient )
     return;
 }
 
+/*
+ *  cas_copy_dg_msg()
+ *
+ *  Like cas_send_dg_msg(), but the udp message is copied to pBuf,
+ *  which has room for MAX_UDP_SEND bytes, so that the caller can send
+ *  several of them at once.  Returns the size of the datagram, zero
+ *  when there is nothing to send.
+ */
+unsigned cas_copy_dg_msg ( struct client * pclient, char * pBuf )
+{
+    unsigned sizeDG = 0u;
+    char * pDG;
+
+    SEND_LOCK ( pclient );
+
+    if ( pclient->send.stk > sizeof (caHdr) ) {
+        sizeDG = cas_frame_dg_msg ( pclient, &pDG );
+        assert ( sizeDG <= MAX_UDP_SEND );
+        memcpy ( pBuf, pDG, sizeDG );
+        epicsTimeGetCurrent ( &pclient->time_at_last_send );
+
+        pclient->send.stk = 0u;
+        rsrv_version_reply ( pclient );
+    }
+
+    SEND_UNLOCK(pclient);
+
+    return sizeDG;
+}
+
 /*
  *
  *  cas_copy_in_header()
@@ -279,11 +543,19 @@ int cas_copy_in_header (
 
     if ( pclient->send.stk > pclient->send.maxstk - msgSize ) {
         if ( pclient->disconnect ) {
-            pclient->send.stk = 0;
+            if ( pclient->proto == IPPROTO_TCP ) {
+                casSendDiscard ( pclient );
+            }
+            else {
+                pclient->send.stk = 0;
+            }
         }
         else{
             if ( pclient->proto == IPPROTO_TCP) {
-                cas_send_bs_msg ( pclient, FALSE );
+                casSendMakeRoom ( pclient, msgSize );
+                if ( msgSize > pclient->send.maxstk - pclient->send.stk ) {
+                    return ECA_TOLARGE;
+                }
             }
             else if ( pclient->proto == IPPROTO_UDP ) {
                 cas_send_dg_msg ( pclient );
@@ -23,11 +23,13 @@
 #include <errno.h>
 
 #include "addrList.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsSignal.h"
 #include "epicsStdio.h"
 #include "epicsTime.h"
+#include "epicsTimer.h"
 #include "errlog.h"
 #include "freeList.h"
 #include "osiPoolStatus.h"
@@ -49,6 +51,10 @@
 
 epicsThreadPrivateId rsrvCurrentClient;
 
+/* UDP name search counts at the previous casr() report */
+static epicsTimeStamp searchStatsStamp;
+static size_t searchStatsCount;
+
 /*
  *
  *  req_server()
@@ -106,6 +112,17 @@ static void req_server (void *pParm)
             ellAdd ( &clientQ, &pClient->node );
             UNLOCK_CLIENTQ;
 
+            if ( pClient->pooled ) {
+                if ( casIoPoolAdd ( pClient ) ) {
+                    LOCK_CLIENTQ;
+                    ellDelete ( &clientQ, &pClient->node );
+                    UNLOCK_CLIENTQ;
+                    destroy_tcp_client ( pClient );
+                    epicsThreadSleep ( 15.0 );
+                }
+                continue;
+            }
+
             id = epicsThreadCreate ( "CAS-client", epicsThreadPriorityCAServerLow,
                     epicsThreadGetStackSize ( epicsThreadStackBig ),
                     camsgtask, pClient );
@@ -478,6 +495,7 @@ void rsrv_init (void)
     freeListInitPvt ( &rsrvChanFreeList, sizeof(struct channel_in_use), 512 );
     freeListInitPvt ( &rsrvEventFreeList, sizeof(struct event_ext), 512 );
     freeListInitPvt ( &rsrvSmallBufFreeListTCP, MAX_TCP, 16 );
+    freeListInitPvt ( &rsrvSendChunkFreeList, sizeof(struct send_chunk), 16 );
     initializePutNotifyFreeList ();
 
     epicsSignalInstallSigPipeIgnore ();
@@ -545,14 +563,24 @@ void rsrv_init (void)
     beacon_startStopEvent = epicsEventMustCreate(epicsEventEmpty);
     castcp_ctl = ctlPause;
 
+    epicsTimeGetCurrent ( &searchStatsStamp );
+
+    casIoPoolInit ();
+
+    if ( rsrvClientByteRate > 0 ) {
+        rsrvTimerQueue = epicsTimerQueueAllocate ( 1,
+            epicsThreadPriorityCAServerLow );
+    }
+
     /* Thread priorities
      * Now starting per interface
      *  TCP Listener: epicsThreadPriorityCAServerLow-2
      *  Name receiver: epicsThreadPriorityCAServerLow-4
      * Now starting global
      *  Beacon sender: epicsThreadPriorityCAServerLow-3
-     * Started later per TCP client
-     *  TCP receiver: epicsThreadPriorityCAServerLow
+     *  TCP I/O pool (if rsrvIoThreads): epicsThreadPriorityCAServerLow
+     * Started later per TCP client, unless rsrvIoThreads
+     *  TCP receiver : epicsThreadPriorityCAServerLow
      *  TCP sender : epicsThreadPriorityCAServerLow-1
      */
     {
@@ -772,6 +800,9 @@ void rsrv_pause (void)
     beacon_ctl = ctlPause;
     casudp_ctl = ctlPause;
     castcp_ctl = ctlPause;
+
+    /* camsgtask() notices with its next request, the I/O pool can't */
+    casIoPoolStop ();
 }
 
 static unsigned countChanListBytes (
@@ -844,6 +875,16 @@ static void log_one_client (struct client *client, unsigned level)
         client->priority,
         n, n == 1 ? "" : "s" );
 
+    if ( level >= 1u && client->proto == IPPROTO_TCP ) {
+        unsigned long nCoalesced =
+            client->evuser ? db_event_replaced ( client->evuser ) : 0ul;
+
+        printf ( "\tQueued response bytes = %u, %lu update%s coalesced%s\n",
+            client->sendQBytes + client->send.stk - client->send.cnt,
+            nCoalesced, nCoalesced == 1ul ? "" : "s",
+            client->rateLimited ? ", over byte rate budget" : "" );
+    }
+
     if ( level >= 3u ) {
         double         send_delay;
         double         recv_delay;
@@ -854,15 +895,26 @@ static void log_one_client (struct client *client, unsigned level)
         send_delay = epicsTimeDiffInSeconds(&current,&client->time_at_last_send);
         recv_delay = epicsTimeDiffInSeconds(&current,&client->time_at_last_recv);
 
-        printf ("\tTask Id = %p, Socket FD = %d\n",
-            (void *) client->tid, (int)client->sock);
+        if ( client->tid ) {
+            printf ("\tTask Id = %p, Socket FD = %d\n",
+                (void *) client->tid, (int)client->sock);
+        }
+        else {
+            printf ("\tServed by the I/O threads, Socket FD = %d\n",
+                (int)client->sock);
+        }
         printf(
         "\t%.2f secs since last send, %.2f secs since last receive\n",
             send_delay, recv_delay);
         printf(
         "\tUnprocessed request bytes = %u, Undelivered response bytes = %u\n",
             client->recv.cnt - client->recv.stk,
-            client->send.stk );
+            client->sendQBytes + client->send.stk - client->send.cnt );
+        if ( ellCount ( &client->sendQ ) ) {
+            printf( "\t%d full send buffer%s queued\n",
+                ellCount ( &client->sendQ ),
+                ellCount ( &client->sendQ ) == 1 ? "" : "s" );
+        }
         printf(
         "\tState = %s%s%s\n",
             state[client->disconnect?1:0],
@@ -896,6 +948,28 @@ static void log_one_client (struct client *client, unsigned level)
     }
 }
 
+/*
+ *  show_search_stats()
+ */
+static void show_search_stats (void)
+{
+    size_t searches = epicsAtomicGetSizeT ( &rsrvSearchCount );
+    size_t hits = epicsAtomicGetSizeT ( &rsrvSearchHits );
+    epicsTimeStamp now;
+    double interval;
+
+    epicsTimeGetCurrent ( &now );
+    interval = epicsTimeDiffInSeconds ( &now, &searchStatsStamp );
+    printf ( "UDP name searches: %lu, %.1f/sec over the last %.0f sec, "
+        "%.1f%% found\n",
+        (unsigned long) searches,
+        interval > 0.0 ? ( searches - searchStatsCount ) / interval : 0.0,
+        interval,
+        searches ? 100.0 * hits / searches : 0.0 );
+    searchStatsStamp = now;
+    searchStatsCount = searches;
+}
+
 /*
  *  casr()
  */
@@ -934,6 +1008,9 @@ void casr (unsigned level)
 
     if (level>=1) {
         rsrv_iface_config *iface = (rsrv_iface_config *) ellFirst ( &servers );
+
+        casIoPoolShow ( level );
+        show_search_stats ();
         while (iface) {
             char    buf[40];
 
@@ -1064,35 +1141,12 @@ void destroy_client ( struct client *client )
     }
 
     if ( client->proto == IPPROTO_TCP ) {
+        casSendDiscard ( client );
         if ( client->send.buf ) {
-            if ( client->send.type == mbtSmallTCP ) {
-                freeListFree ( rsrvSmallBufFreeListTCP,  client->send.buf );
-            }
-            else if ( client->send.type == mbtLargeTCP ) {
-                if(rsrvLargeBufFreeListTCP)
-                    freeListFree ( rsrvLargeBufFreeListTCP,  client->send.buf );
-                else
-                    free(client->send.buf);
-            }
-            else {
-                errlogPrintf ( "CAS: Corrupt send buffer free list type code=%u during client cleanup?\n",
-                    client->send.type );
-            }
+            casFreeBufferTCP ( client->send.buf, client->send.type );
         }
         if ( client->recv.buf ) {
-            if ( client->recv.type == mbtSmallTCP ) {
-                freeListFree ( rsrvSmallBufFreeListTCP,  client->recv.buf );
-            }
-            else if ( client->recv.type == mbtLargeTCP ) {
-                if(rsrvLargeBufFreeListTCP)
-                    freeListFree ( rsrvLargeBufFreeListTCP,  client->recv.buf );
-                else
-                    free(client->recv.buf);
-            }
-            else {
-                errlogPrintf ( "CAS: Corrupt recv buffer free list type code=%u during client cleanup?\n",
-                    client->send.type );
-            }
+            casFreeBufferTCP ( client->recv.buf, client->recv.type );
         }
     }
     else if ( client->proto == IPPROTO_UDP ) {
@@ -1135,6 +1189,26 @@ void destroy_client ( struct client *client )
     freeListFree ( rsrvClientFreeList, client );
 }
 
+/*
+ * casFreeBufferTCP ()
+ */
+void casFreeBufferTCP ( char *buf, enum messageBufferType type )
+{
+    if ( type == mbtSmallTCP ) {
+        freeListFree ( rsrvSmallBufFreeListTCP,  buf );
+    }
+    else if ( type == mbtLargeTCP ) {
+        if(rsrvLargeBufFreeListTCP)
+            freeListFree ( rsrvLargeBufFreeListTCP,  buf );
+        else
+            free(buf);
+    }
+    else {
+        errlogPrintf ( "CAS: Corrupt buffer free list type code=%u during client cleanup?\n",
+            type );
+    }
+}
+
 static void destroyAllChannels (
     struct client * client, ELLLIST * pList )
 {
@@ -1201,6 +1275,10 @@ void destroy_tcp_client ( struct client *client )
         errlogPrintf ( "CAS: Connection %d Terminated\n", (int)client->sock );
     }
 
+    if ( client->pooled ) {
+        casIoPoolRemove ( client );
+    }
+
     if ( client->evuser ) {
         /*
          * turn off extra labor callbacks from the event thread
@@ -1214,6 +1292,17 @@ void destroy_tcp_client ( struct client *client )
         db_flush_extra_labor_event ( client->evuser );
     }
 
+    if ( client->rateTimer ) {
+        epicsTimerId timer;
+
+        /* rsrv_rate_expire() and read_reply() won't restart it now */
+        SEND_LOCK ( client );
+        timer = client->rateTimer;
+        client->rateTimer = NULL;
+        SEND_UNLOCK ( client );
+        epicsTimerQueueDestroyTimer ( rsrvTimerQueue, timer );
+    }
+
     destroyAllChannels ( client, & client->chanList );
     destroyAllChannels ( client, & client->chanPendingUpdateARList );
 
@@ -1271,6 +1360,8 @@ struct client * create_client ( SOCKET sock, int proto )
     ellInit ( & client->chanList );
     ellInit ( & client->chanPendingUpdateARList );
     ellInit ( & client->putNotifyQue );
+    ellInit ( & client->sendQ );
+    client->sendQBytes = 0u;
     memset ( (char *)&client->addr, 0, sizeof (client->addr) );
     client->tid = 0;
 
@@ -1300,6 +1391,10 @@ struct client * create_client ( SOCKET sock, int proto )
     client->recv.cnt = 0u;
     client->evuser = NULL;
     client->priority = CA_PROTO_PRIORITY_MIN;
+    client->rateTimer = NULL;
+    client->rateCredit = 0.0;
+    client->rateLimited = FALSE;
+    client->eventsOff = FALSE;
     client->disconnect = FALSE;
     epicsTimeGetCurrent ( &client->time_at_last_send );
     epicsTimeGetCurrent ( &client->time_at_last_recv );
@@ -1498,17 +1593,31 @@ struct client *create_tcp_client (SOCKET sock , const osiSockAddr *peerAddr)
         return NULL;
     }
 
-    {
+    if ( rsrvTimerQueue ) {
+        client->rateTimer = epicsTimerQueueCreateTimer ( rsrvTimerQueue,
+            rsrv_rate_expire, client );
+        if ( ! client->rateTimer ) {
+            errlogPrintf ( "CAS: unable to create the byte rate timer\n" );
+        }
+        client->rateCredit = rsrvClientByteRate;
+        epicsTimeGetCurrent ( &client->rateStamp );
+    }
+
+    /* the I/O pool threads deliver the events of its clients */
+    if ( casIoPoolStartEvents ( client ) == 0 ) {
+        status = DB_EVENT_OK;
+    }
+    else {
         epicsThreadBooleanStatus    tbs;
 
         tbs  = epicsThreadHighestPriorityLevelBelow ( epicsThreadPriorityCAServerLow, &priorityOfEvents );
         if ( tbs != epicsThreadBooleanStatusSuccess ) {
             priorityOfEvents = epicsThreadPriorityCAServerLow;
         }
-    }
 
-    status = db_start_events ( client->evuser, "CAS-event",
-                NULL, NULL, priorityOfEvents );
+        status = db_start_events ( client->evuser, "CAS-event",
+                    NULL, NULL, priorityOfEvents );
+    }
     if ( status != DB_EVENT_OK ) {
         errlogPrintf ( "CAS: unable to start the event facility\n" );
         destroy_tcp_client ( client );
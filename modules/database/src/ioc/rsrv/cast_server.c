@@ -45,12 +45,34 @@
 #include "freeList.h"
 #include "osiSock.h"
 #include "taskwd.h"
+#include "cantProceed.h"
 
 #include "rsrv.h"
 #include "server.h"
 
 #define TIMEOUT 60.0 /* sec */
 
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#   define CAS_HAVE_MMSG
+#   define UDP_BATCH 16 /* datagrams per recvmmsg() or sendmmsg() */
+#else
+#   define UDP_BATCH 1
+#endif
+
+/*
+ * Datagrams received together, or replies waiting to be sent together
+ */
+struct udp_batch {
+    unsigned            n;
+    char                *buf[UDP_BATCH];
+    unsigned            len[UDP_BATCH];
+    struct sockaddr_in  addr[UDP_BATCH];
+#ifdef CAS_HAVE_MMSG
+    struct mmsghdr      msg[UDP_BATCH];
+    struct iovec        iov[UDP_BATCH];
+#endif
+};
+
 /*
  * clean_addrq
  */
@@ -107,6 +129,154 @@ static void clean_addrq(struct client *client)
 
 }
 
+/*
+ * udp_recv_batch ()
+ *
+ * Waits for at least one datagram, returns the number received
+ * or -1 with SOCKERRNO set
+ */
+static int udp_recv_batch ( SOCKET sock, struct udp_batch *pBatch )
+{
+    int status;
+#ifdef CAS_HAVE_MMSG
+    unsigned i;
+
+    for ( i = 0u; i < UDP_BATCH; i++ ) {
+        struct msghdr *pHdr = &pBatch->msg[i].msg_hdr;
+
+        pBatch->iov[i].iov_base = pBatch->buf[i];
+        pBatch->iov[i].iov_len = MAX_UDP_RECV;
+        memset ( pHdr, 0, sizeof ( *pHdr ) );
+        pHdr->msg_name = &pBatch->addr[i];
+        pHdr->msg_namelen = sizeof ( pBatch->addr[i] );
+        pHdr->msg_iov = &pBatch->iov[i];
+        pHdr->msg_iovlen = 1;
+    }
+
+    status = recvmmsg ( sock, pBatch->msg, UDP_BATCH, MSG_WAITFORONE, NULL );
+    for ( i = 0u; status > 0 && i < (unsigned) status; i++ ) {
+        pBatch->len[i] = pBatch->msg[i].msg_len;
+    }
+#else
+    osiSocklen_t addrSize = sizeof ( pBatch->addr[0] );
+
+    status = recvfrom ( sock, pBatch->buf[0], MAX_UDP_RECV, 0,
+        (struct sockaddr *) &pBatch->addr[0], &addrSize );
+    if ( status >= 0 ) {
+        pBatch->len[0] = (unsigned) status;
+        status = 1;
+    }
+#endif
+    pBatch->n = status > 0 ? (unsigned) status : 0u;
+    return status;
+}
+
+/*
+ * udp_send_batch ()
+ *
+ * Sends the replies which were queued by udp_queue_reply()
+ */
+static void udp_send_batch ( SOCKET sock, struct udp_batch *pBatch )
+{
+    unsigned i = 0u;
+
+    while ( i < pBatch->n ) {
+        int status;
+#ifdef CAS_HAVE_MMSG
+        unsigned j;
+
+        for ( j = i; j < pBatch->n; j++ ) {
+            struct msghdr *pHdr = &pBatch->msg[j].msg_hdr;
+
+            pBatch->iov[j].iov_base = pBatch->buf[j];
+            pBatch->iov[j].iov_len = pBatch->len[j];
+            memset ( pHdr, 0, sizeof ( *pHdr ) );
+            pHdr->msg_name = &pBatch->addr[j];
+            pHdr->msg_namelen = sizeof ( pBatch->addr[j] );
+            pHdr->msg_iov = &pBatch->iov[j];
+            pHdr->msg_iovlen = 1;
+        }
+        status = sendmmsg ( sock, &pBatch->msg[i], pBatch->n - i, 0 );
+        if ( status > 0 ) {
+            i += (unsigned) status;
+            continue;
+        }
+#else
+        status = sendto ( sock, pBatch->buf[i], pBatch->len[i], 0,
+            (struct sockaddr *) &pBatch->addr[i], sizeof ( pBatch->addr[i] ) );
+        if ( status >= 0 ) {
+            i++;
+            continue;
+        }
+#endif
+        if ( SOCKERRNO != SOCK_EINTR ) {
+            char sockErrBuf[64];
+            char buf[40];
+
+            epicsSocketConvertErrnoToString (
+                sockErrBuf, sizeof ( sockErrBuf ) );
+            ipAddrToDottedIP ( &pBatch->addr[i], buf, sizeof(buf) );
+            errlogPrintf ( "CAS: UDP send to %s failed: %s\n",
+                buf, sockErrBuf );
+            i++; /* drop it */
+        }
+    }
+    pBatch->n = 0u;
+}
+
+/*
+ * udp_queue_reply ()
+ *
+ * Moves the reply built up for the current client address to the
+ * batch of replies, sending the batch first if it is full
+ */
+static void udp_queue_reply ( struct client *client, struct udp_batch *pBatch )
+{
+    unsigned n = pBatch->n;
+
+    if ( client->send.stk <= sizeof (caHdr) ) {
+        return;
+    }
+    if ( n == UDP_BATCH ) {
+        udp_send_batch ( client->sock, pBatch );
+        n = 0u;
+    }
+    pBatch->len[n] = cas_copy_dg_msg ( client, pBatch->buf[n] );
+    if ( pBatch->len[n] ) {
+        pBatch->addr[n] = client->addr;
+        pBatch->n = n + 1u;
+    }
+}
+
+/*
+ * udp_batch_order ()
+ *
+ * Orders the received datagrams so that those from the same address
+ * are handled one after the other and can share a reply datagram.
+ * Otherwise keeps the order in which they arrived.
+ */
+static void udp_batch_order ( const struct udp_batch *pBatch, unsigned *order )
+{
+    unsigned i, j, n = 0u;
+    char done[UDP_BATCH];
+
+    memset ( done, 0, sizeof ( done ) );
+    for ( i = 0u; i < pBatch->n; i++ ) {
+        if ( done[i] ) {
+            continue;
+        }
+        for ( j = i; j < pBatch->n; j++ ) {
+            if ( ! done[j] &&
+                    pBatch->addr[j].sin_addr.s_addr ==
+                        pBatch->addr[i].sin_addr.s_addr &&
+                    pBatch->addr[j].sin_port == pBatch->addr[i].sin_port ) {
+                done[j] = 1;
+                order[n++] = j;
+            }
+        }
+    }
+}
+
 /*
  * CAST_SERVER
  *
@@ -119,13 +289,12 @@ void cast_server(void *pParm)
     int                 status;
     int                 count=0;
     int                 mysocket=0;
-    struct sockaddr_in  new_recv_addr;
-    osiSocklen_t        recv_addr_size;
     osiSockIoctl_t      nchars;
     SOCKET              recv_sock, reply_sock;
     struct client      *client;
-
-    recv_addr_size = sizeof(new_recv_addr);
+    struct udp_batch   *recvBatch, *replyBatch;
+    unsigned            order[UDP_BATCH];
+    unsigned            i;
 
     reply_sock = conf->udp;
 
@@ -151,6 +320,20 @@ void cast_server(void *pParm)
     }
     client->udpRecv = recv_sock;
 
+    /*
+     * the first receive buffer is the client's own, the
+     * client is pointed at each datagram in turn
+     */
+    recvBatch = callocMustSucceed ( 1, sizeof ( *recvBatch ), "cast_server" );
+    replyBatch = callocMustSucceed ( 1, sizeof ( *replyBatch ), "cast_server" );
+    recvBatch->buf[0] = client->recv.buf;
+    for ( i = 1u; i < UDP_BATCH; i++ ) {
+        recvBatch->buf[i] = mallocMustSucceed ( MAX_UDP_RECV, "cast_server" );
+    }
+    for ( i = 0u; i < UDP_BATCH; i++ ) {
+        replyBatch->buf[i] = mallocMustSucceed ( MAX_UDP_SEND, "cast_server" );
+    }
+
     casAttachThreadToClient ( client );
 
     /*
@@ -164,13 +347,7 @@ void cast_server(void *pParm)
     epicsEventSignal(casudp_startStopEvent);
 
     while (TRUE) {
-        status = recvfrom (
-            recv_sock,
-            client->recv.buf,
-            client->recv.maxstk,
-            0,
-            (struct sockaddr *)&new_recv_addr,
-            &recv_addr_size);
+        status = udp_recv_batch ( recv_sock, recvBatch );
         if (status < 0) {
             if (SOCKERRNO != SOCK_EINTR) {
                 char sockErrBuf[64];
@@ -180,20 +357,26 @@ void cast_server(void *pParm)
                         sockErrBuf);
                 epicsThreadSleep(1.0);
             }
+        }
 
-        } else {
+        udp_batch_order ( recvBatch, order );
+
+        for ( i = 0u; i < recvBatch->n; i++ ) {
+            struct sockaddr_in *new_recv_addr = &recvBatch->addr[order[i]];
             size_t idx;
+
             for(idx=0; casIgnoreAddrs[idx]; idx++)
             {
-                if(new_recv_addr.sin_addr.s_addr==casIgnoreAddrs[idx]) {
-                    status = -1; /* ignore */
+                if(new_recv_addr->sin_addr.s_addr==casIgnoreAddrs[idx]) {
                     break;
                 }
             }
-        }
+            if (casIgnoreAddrs[idx] || casudp_ctl != ctlRun) {
+                continue;
+            }
 
-        if (status >= 0 && casudp_ctl == ctlRun) {
-            client->recv.cnt = (unsigned) status;
+            client->recv.buf = recvBatch->buf[order[i]];
+            client->recv.cnt = recvBatch->len[order[i]];
             client->recv.stk = 0ul;
             epicsTimeGetCurrent(&client->time_at_last_recv);
 
@@ -201,23 +384,23 @@ void cast_server(void *pParm)
             client->seqNoOfReq = 0;
 
             /*
-             * If we are talking to a new client flush to the old one
-             * in case we are holding UDP messages waiting to
-             * see if the next message is for this same client.
+             * If we are talking to a new client queue the reply to
+             * the old one in case we are holding UDP messages waiting
+             * to see if the next message is for this same client.
              */
             if (client->send.stk>sizeof(caHdr)) {
                 status = memcmp(&client->addr,
-                    &new_recv_addr, recv_addr_size);
+                    new_recv_addr, sizeof(*new_recv_addr));
                 if(status){
                     /*
                      * if the address is different
                      */
-                    cas_send_dg_msg(client);
-                    client->addr = new_recv_addr;
+                    udp_queue_reply(client, replyBatch);
+                    client->addr = *new_recv_addr;
                 }
             }
             else {
-                client->addr = new_recv_addr;
+                client->addr = *new_recv_addr;
             }
 
             if (CASDEBUG>1) {
@@ -267,6 +450,7 @@ void cast_server(void *pParm)
                 }
             }
         }
+        client->recv.buf = recvBatch->buf[0];
 
         /*
          * allow messages to batch up if more are coming
@@ -275,11 +459,10 @@ void cast_server(void *pParm)
         status = socket_ioctl(recv_sock, FIONREAD, &nchars);
         if (status<0) {
             errlogPrintf ("CA cast server: Unable to fetch N characters pending\n");
-            cas_send_dg_msg (client);
-            clean_addrq (client);
         }
-        else if (nchars == 0) {
-            cas_send_dg_msg (client);
+        if (status<0 || nchars == 0) {
+            udp_queue_reply (client, replyBatch);
+            udp_send_batch (reply_sock, replyBatch);
             clean_addrq (client);
         }
     }
@@ -38,4 +38,6 @@ void rsrvRegistrar(void)
 }
 
 epicsExportAddress(int, CASDEBUG);
+epicsExportAddress(int, rsrvIoThreads);
+epicsExportAddress(int, rsrvClientByteRate);
 epicsExportRegistrar(rsrvRegistrar);
@@ -27,8 +27,10 @@
 #include "caProto.h"
 #include "ellLib.h"
 #include "epicsTime.h"
+#include "epicsTimer.h"
 #include "epicsAssert.h"
 #include "osiSock.h"
+#include "dbCoreAPI.h"
 
 /* a modified ca header with capacity for large arrays */
 typedef struct caHdrLargeArray {
@@ -63,12 +65,31 @@ struct message_buffer {
   enum messageBufferType    type;
 };
 
+/*
+ * A full send buffer which is waiting to be written to the socket,
+ * queued on client::sendQ so that the next response can be built
+ * without waiting for a slow client.
+ */
+struct send_chunk {
+  ELLNODE                   node;
+  char                      *buf;
+  /*! bytes [sent, stk) remain to be sent */
+  unsigned                  sent;
+  unsigned                  stk;
+  enum messageBufferType    type;
+};
+
 extern epicsThreadPrivateId rsrvCurrentClient;
 
 typedef struct client {
   ELLNODE               node;
-  /*! guarded by SEND_LOCK()  aka. client::lock */
+  /*! guarded by SEND_LOCK()  aka. client::lock
+   * For TCP bytes [cnt, stk) are still to be sent, after the sendQ.
+   */
   struct message_buffer send;
+  /*! send_chunk::node, guarded by SEND_LOCK() */
+  ELLLIST               sendQ;
+  unsigned              sendQBytes;
   /*! accessed by receive thread w/o locks cf. camsgtask() */
   struct message_buffer recv;
   epicsMutexId          lock;
@@ -92,7 +113,27 @@ typedef struct client {
   ca_uint32_t           seqNoOfReq; /* for udp  */
   unsigned              recvBytesToDrain;
   unsigned              priority;
+  /*! byte rate budget, guarded by SEND_LOCK(), NULL timer if unlimited */
+  epicsTimerId          rateTimer;
+  epicsTimeStamp        rateStamp;
+  double                rateCredit; /* bytes, negative while over budget */
+  char                  rateLimited; /* updates coalesced by dbEvent */
+  char                  eventsOff; /* client sent CA_PROTO_EVENTS_OFF */
   char                  disconnect; /* disconnect detected */
+  /*! served by the I/O pool, see camsgpool.c */
+  char                  pooled;
+  /*! guarded by the I/O pool lock */
+  ELLNODE               poolNode;
+  unsigned              poolFlags;
+  epicsUInt32           poolGen; /* tells socket numbers apart once reused */
+  /*! only used by the pool thread serving the client */
+  unsigned              poolDeferred;
+  epicsTimerId          parkTimer;
+  epicsTimeStamp        parkExpires;
+  char                  recvParked; /* retry the current request later */
+  char                  parkExpired;
+  epicsTimerId          recvTimer;
+  char                  recvDelayed; /* out of network buffers */
 } client;
 
 /* Channel state shows which struct client list a
@@ -180,6 +221,9 @@ enum ctl {ctlInit, ctlRun, ctlPause, ctlExit};
 #endif
 
 GLBLTYPE int                CASDEBUG;
+GLBLTYPE int                rsrvIoThreads; /* 0: a receive thread per client */
+GLBLTYPE int                rsrvClientByteRate; /* monitor bytes/sec, 0: unlimited */
+GLBLTYPE epicsTimerQueueId  rsrvTimerQueue;
 GLBLTYPE unsigned short     ca_server_port, ca_udp_port, ca_beacon_port;
 GLBLTYPE ELLLIST            clientQ             GLBLTYPE_INIT(ELLLIST_INIT);
 GLBLTYPE ELLLIST            servers; /* rsrv_iface_config::node, read-only after rsrv_init() */
@@ -196,7 +240,9 @@ GLBLTYPE void               *rsrvSmallBufFreeListTCP;
 GLBLTYPE void               *rsrvLargeBufFreeListTCP;
 GLBLTYPE unsigned           rsrvSizeofLargeBufTCP;
 GLBLTYPE void               *rsrvPutNotifyFreeList;
+GLBLTYPE void               *rsrvSendChunkFreeList;
 GLBLTYPE unsigned           rsrvChannelCount; /* locked by clientQlock */
+GLBLTYPE size_t             rsrvSearchCount, rsrvSearchHits; /* UDP searches, epicsAtomic */
 
 GLBLTYPE epicsEventId       casudp_startStopEvent;
 GLBLTYPE epicsEventId       beacon_startStopEvent;
@@ -220,8 +266,19 @@ extern "C" {
 #endif
 
 void camsgtask (void *client);
+int camsgProcess ( struct client *client, unsigned nchars );
+void camsgRecvFailed ( int anerrno );
+int casIoPoolInit ( void );
+int casIoPoolStartEvents ( struct client *client );
+int casIoPoolAdd ( struct client *client );
+void casIoPoolRemove ( struct client *client );
+int casIoPoolPark ( struct client *client, double timeout );
+void casIoPoolResume ( struct client *client );
+void casIoPoolStop ( void );
+void casIoPoolShow ( unsigned level );
 void cas_send_bs_msg ( struct client *pclient, int lock_needed );
 void cas_send_dg_msg ( struct client *pclient );
+unsigned cas_copy_dg_msg ( struct client *pclient, char *pBuf );
 void rsrv_online_notify_task (void *);
 void cast_server (void *);
 struct client *create_client ( SOCKET sock, int proto );
@@ -231,6 +288,8 @@ void destroy_tcp_client ( struct client * );
 void casAttachThreadToClient ( struct client * );
 int camessage ( struct client *client );
 void rsrv_extra_labor ( void * pArg );
+void rsrv_rate_charge ( struct client *pClient, ca_uint32_t nBytes );
+void rsrv_rate_expire ( void * pArg );
 int rsrvCheckPut ( const struct channel_in_use *pciu );
 int rsrv_version_reply ( struct client *client );
 void rsrvFreePutNotify ( struct client *pClient,
@@ -247,6 +306,10 @@ void casExpandRecvBuffer ( struct client *pClient, ca_uint32_t size );
  * outgoing protocol maintenance
  */
 void casExpandSendBuffer ( struct client *pClient, ca_uint32_t size );
+void casFreeBufferTCP ( char *buf, enum messageBufferType type );
+void casSendDiscard ( struct client *pClient );
+unsigned casSendQueued ( struct client *pClient );
+int casSendBacklog ( struct client *pClient );
 int cas_copy_in_header (
     struct client *pClient, ca_uint16_t response, ca_uint32_t payloadSize,
     ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
@@ -9,8 +9,10 @@
 
 #include "cantProceed.h"
 #include "dbAddr.h"
+#include "dbAccessDefs.h"
 #include "dbConvert.h"
 #include "dbDefs.h"
+#include "dbStaticLib.h"
 #include "epicsTime.h"
 #include "epicsMath.h"
 #include "epicsAssert.h"
@@ -112,6 +114,89 @@ done:
     free(tdat.output);
 }
 
+/* Time one conversion direction for a pair of numeric types.
+ * Returns the number of elements converted per second.
+ */
+static double runPair(int put, short fieldType, short dbrType,
+                      size_t nelem, size_t niter)
+{
+    DBADDR addr;
+    epicsInt32 *init;
+    void *field, *buffer;
+    epicsTimeStamp start, stop;
+    double elapsed;
+    size_t i;
+
+    init = callocMustSucceed(nelem, sizeof(*init), "runPair");
+    field = callocMustSucceed(nelem, dbValueSize(fieldType), "runPair");
+    buffer = callocMustSucceed(nelem, dbValueSize(dbrType), "runPair");
+
+    for(i=0; i<nelem; i++)
+        init[i] = (epicsInt32)(i%100);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.no_elements = nelem;
+
+    /* fill the source with small values, in range for every type */
+    if(!put) {
+        addr.field_type = fieldType;
+        addr.field_size = dbValueSize(fieldType);
+        addr.pfield = field;
+        dbPutConvertRoutine[DBR_LONG][fieldType](&addr, init, nelem, nelem, 0);
+    } else {
+        addr.field_type = DBF_LONG;
+        addr.field_size = sizeof(*init);
+        addr.pfield = init;
+        dbGetConvertRoutine[DBF_LONG][dbrType](&addr, buffer, nelem, nelem, 0);
+    }
+
+    addr.field_type = fieldType;
+    addr.field_size = dbValueSize(fieldType);
+    addr.pfield = field;
+
+    epicsTimeGetCurrent(&start);
+    if(!put) {
+        GETCONVERTFUNC getter = dbGetConvertRoutine[fieldType][dbrType];
+        for(i=0; i<niter; i++)
+            getter(&addr, buffer, nelem, nelem, 0);
+    } else {
+        PUTCONVERTFUNC putter = dbPutConvertRoutine[dbrType][fieldType];
+        for(i=0; i<niter; i++)
+            putter(&addr, buffer, nelem, nelem, 0);
+    }
+    epicsTimeGetCurrent(&stop);
+    elapsed = epicsTimeDiffInSeconds(&stop, &start);
+
+    free(init);
+    free(field);
+    free(buffer);
+    return elapsed>0 ? (nelem*niter)/elapsed : 0.0;
+}
+
+/* Every numeric field type to every numeric request type, both ways */
+static void runMatrix(size_t nelem, size_t niter)
+{
+    int put;
+    short fieldType, dbrType;
+
+    testDiag("Convert %lu element arrays %lu times, in Melem/s",
+             (unsigned long)nelem, (unsigned long)niter);
+
+    for(put=0; put<2; put++) {
+        for(fieldType=DBF_CHAR; fieldType<=DBF_DOUBLE; fieldType++) {
+            for(dbrType=DBR_CHAR; dbrType<=DBR_DOUBLE; dbrType++) {
+                /* skip "DBF_", numeric DBF and DBR codes match */
+                testDiag("%s %-6s %s %-6s %8.1f",
+                         put ? "put" : "get",
+                         dbGetFieldTypeString(fieldType) + 4,
+                         put ? "<-" : "->",
+                         dbGetFieldTypeString(dbrType) + 4,
+                         runPair(put, fieldType, dbrType, nelem, niter)/1e6);
+            }
+        }
+    }
+}
+
 MAIN(benchdbConvert)
 {
     testPlan(0);
@@ -123,5 +208,6 @@ MAIN(benchdbConvert)
     runBench(100000, 100, 10);
     runBench(1000000, 10, 10);
     runBench(10000000, 1, 10);
+    runMatrix(10000, 1000);
     return testDone();
 }
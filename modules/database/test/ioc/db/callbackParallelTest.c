@@ -20,6 +20,7 @@
 
 #include "callback.h"
 #include "cantProceed.h"
+#include "epicsAtomic.h"
 #include "epicsThread.h"
 #include "epicsEvent.h"
 #include "epicsTime.h"
@@ -96,6 +97,69 @@ static void printStats(double *stats, const char* tag) {
             sqrt(stats[4]*stats[3]-pow(stats[2], 2.0))/stats[4]);
 }
 
+/*
+ * Check the alternative queue engines and batch mode: every request
+ * is run exactly once, and the queue statistics are still maintained.
+ */
+
+#define NQUEUED 1500
+
+static int queuedCount;
+static epicsEventId queuedDone;
+
+static void queuedCallback(epicsCallback *pCallback)
+{
+    if (epicsAtomicIncrIntT(&queuedCount) == NQUEUED)
+        epicsEventMustTrigger(queuedDone);
+}
+
+static void testQueueEngine(int noCpus, const char *engine, int batch)
+{
+    epicsCallback *pcb = callocMustSucceed(NQUEUED, sizeof(*pcb), "pcb");
+    callbackQueueStats stats;
+    int i, failed = 0;
+
+    testDiag("Starting %d parallel callback threads with \"%s\" engine, "
+        "batch size %d", noCpus, engine, batch);
+
+    testOk(callbackSetQueueEngine(engine) == 0 &&
+        callbackSetBatchSize(batch) == 0, "Configure callback queues");
+
+    queuedCount = 0;
+    queuedDone = epicsEventMustCreate(epicsEventEmpty);
+    callbackParallelThreads(noCpus, "");
+    callbackInit();
+
+    for (i = 0; i < NQUEUED; i++) {
+        callbackSetCallback(queuedCallback, &pcb[i]);
+        callbackSetPriority(i % NUM_CALLBACK_PRIORITIES, &pcb[i]);
+        if (callbackRequest(&pcb[i]))
+            failed++;
+    }
+    testOk(failed == 0, "%d requests failed", failed);
+
+    testOk(epicsEventWaitWithTimeout(queuedDone, 10.0) == epicsEventOK,
+        "All %d callbacks ran", NQUEUED);
+    epicsThreadSleep(0.1);
+    testOk(epicsAtomicGetIntT(&queuedCount) == NQUEUED,
+        "Callbacks ran exactly once (%d)", epicsAtomicGetIntT(&queuedCount));
+
+    testOk1(callbackQueueStatus(0, &stats) == 0);
+    for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
+        testOk(stats.numUsed[i] == 0 && stats.maxUsed[i] > 0 &&
+            stats.numOverflow[i] == 0,
+            "Priority %d used %d, high-water %d, overflows %d", i,
+            stats.numUsed[i], stats.maxUsed[i], stats.numOverflow[i]);
+    }
+
+    callbackStop();
+    callbackCleanup();
+    callbackSetQueueEngine("ring");
+    callbackSetBatchSize(1);
+    epicsEventDestroy(queuedDone);
+    free(pcb);
+}
+
 MAIN(callbackParallelTest)
 {
     myPvt *pcbt[NCALLBACKS];
@@ -111,7 +175,7 @@ MAIN(callbackParallelTest)
         for (j = 0; j < 5; j++)
             setupError[i][j] = timeError[i][j] = defaultError[j];
 
-    testPlan(2);
+    testPlan(27);
 
     testDiag("Starting %d parallel callback threads", noCpus);
 
@@ -206,5 +270,13 @@ MAIN(callbackParallelTest)
     callbackStop();
     callbackCleanup();
 
+    testOk(callbackSetQueueEngine("nonesuch") == -1, "Unknown engine rejected");
+    /* Always use several workers, so that they compete for requests */
+    if (noCpus < 4)
+        noCpus = 4;
+    testQueueEngine(noCpus, "steal", 1);
+    testQueueEngine(noCpus, "ring", 16);
+    testQueueEngine(noCpus, "steal", 16);
+
     return testDone();
 }
@@ -610,9 +610,144 @@ static void testCAC(void)
     free(buftarg2);
 }
 
+static unsigned long waitForFlush(unsigned long nFlush)
+{
+    dbCaFlushStats stats;
+    int i;
+
+    for (i = 0; i < 50; i++) {
+        dbCaGetFlushStats(-1, &stats);
+        if (stats.nFlush > nFlush)
+            break;
+        epicsThreadSleep(0.1);
+    }
+    return stats.nFlush;
+}
+
+static void testFlushBatch(void)
+{
+    xRecord *psrc;
+    DBLINK *psrclnk;
+    dbCaFlushStats before, after;
+    epicsInt32 temp;
+
+    testDiag("Batched CA link flushes");
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    testdbReadDatabase("dbCaLinkTest1.db", NULL, "TARGET=target CA");
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    psrc = (xRecord*)testdbRecordPtr("source");
+    psrclnk = &psrc->lnk;
+
+    testOk1(psrclnk->type==CA_LINK);
+    testdbCaWaitForUpdateCount(psrclnk, 1);
+
+    testDiag("Flush 0.1 seconds after a put");
+    dbCaFlushDelay = 100000;
+    dbCaSync();
+    dbCaGetFlushStats(-1, &before);
+
+    temp = 5;
+    dbScanLock((dbCommon*)psrc);
+    testOk1(dbPutLink(psrclnk, DBR_LONG, (void*)&temp, 1)==0);
+    dbScanUnlock((dbCommon*)psrc);
+
+    testOk1(waitForFlush(before.nFlush) > before.nFlush);
+    dbCaGetFlushStats(-1, &after);
+    testOk(after.latencyMax >= 0.05, "flush latency %.3f ms",
+        after.latencyMax * 1e3);
+
+    testDiag("Flush when dbCaFlushBytes is reached");
+    dbCaFlushDelay = 10000000;
+    dbCaFlushBytes = 1;
+    before = after;
+
+    temp = 6;
+    dbScanLock((dbCommon*)psrc);
+    dbPutLink(psrclnk, DBR_LONG, (void*)&temp, 1);
+    dbScanUnlock((dbCommon*)psrc);
+
+    testOk1(waitForFlush(before.nFlush) > before.nFlush);
+
+    testDiag("Reach dbCaFlushBytes twice for one link in a pass");
+    dbCaFlushDelay = 1000000;
+
+    /* connecting queues CA_GET_ATTRIBUTES and CA_MONITOR_NATIVE together */
+    testdbPutFieldOk("source.LNK", DBF_STRING, "target.I32 CA");
+    testOk1(psrclnk->type==CA_LINK);
+    testdbCaWaitForUpdateCount(psrclnk, 1);
+    dbCaGetFlushStats(-1, &after);
+    testOk(after.latencyMax < dbCaFlushDelay * 1e-6, "flush latency %.3f ms",
+        after.latencyMax * 1e3);
+
+    dbCaFlushDelay = 0;
+    dbCaFlushBytes = 0;
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
+static void testWorkers(void)
+{
+    xRecord *psrc, *ptarg;
+    dbCaFlushStats stats;
+    epicsInt32 temp;
+
+    testDiag("Links shared between several dbCa workers");
+    dbCaWorkers = 4;
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    testdbReadDatabase("dbCaLinkTest1.db", NULL, "TARGET=target CA");
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    psrc = (xRecord*)testdbRecordPtr("source");
+    ptarg = (xRecord*)testdbRecordPtr("target");
+
+    testOk1(dbCaGetWorkerCount()==4);
+
+    testdbPutFieldOk("source.INP", DBF_STRING, "target.I32 CA");
+    testOk1(psrc->lnk.type==CA_LINK && psrc->inp.type==CA_LINK);
+    testdbCaWaitForConnect(&psrc->lnk);
+    testdbCaWaitForConnect(&psrc->inp);
+
+    dbCaGetFlushStats(-1, &stats);
+    testOp("%d",stats.nChannels,==,2);
+
+    temp = 11;
+    putLink(&psrc->lnk, DBR_LONG, (void*)&temp, 1);
+    temp = 12;
+    putLink(&psrc->inp, DBR_LONG, (void*)&temp, 1);
+
+    dbScanLock((dbCommon*)ptarg);
+    testOk(ptarg->val==11 && ptarg->i32==12, "VAL %d, I32 %d",
+        ptarg->val, ptarg->i32);
+    dbScanUnlock((dbCommon*)ptarg);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+    dbCaWorkers = 1;
+}
+
 MAIN(dbCaLinkTest)
 {
-    testPlan(101);
+    testPlan(116);
     testNativeLink();
     testStringLink();
     testCP();
@@ -622,5 +757,7 @@ MAIN(dbCaLinkTest)
     testArrayLink(10,10);
     testreTargetTypeChange();
     testCAC();
+    testFlushBatch();
+    testWorkers();
     return testDone();
 }
@@ -14,6 +14,8 @@
  *          Ralph Lange <Ralph.Lange@bessy.de>
  */
 
+#define EPICS_PRIVATE_API
+
 #include "dbChannel.h"
 #include "dbStaticLib.h"
 #include "dbAccessDefs.h"
@@ -157,7 +159,7 @@ MAIN(testDbChannel)     /* dbChannelTest is an API routine... */
 {
     dbChannel *pch;
 
-    testPlan(76);
+    testPlan(89);
 
     testdbPrepare();
 
@@ -267,6 +269,46 @@ MAIN(testDbChannel)     /* dbChannelTest is an API routine... */
     e = e_start | e_start_map | e_abort;
     testOk1(!dbChannelCreate("x.{scalar:{}}"));
 
+    testDiag("Name lookup cache");
+    {
+        unsigned long hits, misses, hits0;
+        int count;
+        dbAddr addr;
+
+        dbChannelLookupCacheSize = 4;
+        dbChannelLookupCacheStats(&hits0, &misses, &count);
+
+        testOk1(!dbChannelTest("x.VAL"));
+        testOk1(!dbChannelTest("x.VAL"));
+        testOk(dbChannelTest("y"), "Nonexistent record");
+        testOk(dbChannelTest("y"), "Nonexistent record, name filtered");
+        dbChannelLookupCacheStats(&hits, &misses, &count);
+        testOk(hits == hits0 + 1, "1 cache hit (%lu)", hits - hits0);
+
+        pch = dbChannelCreate("x.NAME$");
+        if (pch) dbChannelDelete(pch);
+        pch = dbChannelCreate("x.NAME$");
+        testOk(pch && dbChannelFieldType(pch) == DBF_CHAR,
+            "Cached x.NAME$ is DBF_CHAR");
+        if (pch) dbChannelDelete(pch);
+
+        testOk1(!dbNameToAddr("x.NAME$", &addr) &&
+            addr.field_type == DBF_CHAR);
+
+        testOk1(!dbChannelTest("x.NAME"));
+        testOk1(!dbChannelTest("x.INP"));
+        dbChannelLookupCacheStats(&hits, &misses, &count);
+        testOk(count == 4, "Cache holds %d names", count);
+
+        /* A full cache evicts a name for each new one */
+        testOk1(!dbChannelTest("x.DESC"));
+        testOk1(!dbChannelTest("x.SCAN"));
+        dbChannelLookupCacheStats(&hits, &misses, &count);
+        testOk(count == 4, "Full cache still holds %d names", count);
+
+        dbChannelLookupCacheSize = 0;
+    }
+
     testIocShutdownOk();
     testdbCleanup();
 
@@ -17,6 +17,8 @@
 #include <dbAccess.h>
 #include <recGbl.h>
 #include <alarm.h>
+#include <dbLink.h>
+#include <caeventmask.h>
 
 #include "xRecord.h"
 
@@ -109,9 +111,51 @@ void checkAlarm(void)
     testOk1(strcmp(amsg, "a me")==0);
 }
 
+static
+void checkPlan(void)
+{
+    xRecord* target = (xRecord*)testdbRecordPtr("target");
+    xRecord* src = (xRecord*)testdbRecordPtr("src");
+    testMonitor* mon;
+    epicsFloat64 dval;
+    epicsEnum16 eval;
+    char sval[MAX_STRING_SIZE];
+
+    testDiag("checkPlan()");
+
+    testdbPutFieldOk("src.LNK", DBF_STRING, "target.F64");
+    mon = testMonitorCreate("target.F64", DBE_VALUE, 0);
+    testMonitorCount(mon, 1);
+
+    dbScanLock((dbCommon*)src);
+    dval = 4.5;
+    testOk1(0==dbPutLink(&src->lnk, DBR_DOUBLE, &dval, 1));
+    dval = 0.0;
+    testOk1(0==dbGetLink(&src->lnk, DBR_DOUBLE, &dval, NULL, NULL));
+    dbScanUnlock((dbCommon*)src);
+
+    testOk(dval==4.5, "read back %g", dval);
+    testOk1(target->f64==4.5);
+    testMonitorWait(mon);
+    testOk1(testMonitorCount(mon, 1)==1);
+    testMonitorDestroy(mon);
+
+    testDiag("Relink to a DBF_MENU field");
+    testdbPutFieldOk("src.LNK", DBF_STRING, "target.SFX");
+
+    dbScanLock((dbCommon*)src);
+    testOk1(0==dbGetLink(&src->lnk, DBR_STRING, sval, NULL, NULL));
+    eval = 0;
+    testOk1(0==dbPutLink(&src->lnk, DBR_ENUM, &eval, 1));
+    dbScanUnlock((dbCommon*)src);
+
+    testOk(strcmp(sval, "None")==0, "read '%s'", sval);
+    testdbGetFieldEqual("target.SFX", DBR_STRING, "Before");
+}
+
 MAIN(dbDbLinkTest)
 {
-    testPlan(18);
+    testPlan(29);
 
     testdbPrepare();
 
@@ -127,6 +171,7 @@ MAIN(dbDbLinkTest)
 
     checkTime();
     checkAlarm();
+    checkPlan();
 
     testIocShutdownOk();
 
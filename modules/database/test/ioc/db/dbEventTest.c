@@ -0,0 +1,609 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Tests for the event queues of the db event facility
+ */
+
+#include <string.h>
+
+#define EPICS_PRIVATE_API
+
+#include "epicsEvent.h"
+#include "epicsMutex.h"
+#include "epicsThread.h"
+#include "errlog.h"
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbCommon.h"
+#include "dbCommonPvt.h"
+#include "dbEvent.h"
+#include "dbLock.h"
+#include "db_field_log.h"
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+#include "xRecord.h"
+#include "arrRecord.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NSUB 50
+#define NEARLY 10
+#define DEPTH 8
+
+static struct subState {
+    dbEventSubscription sub;
+    unsigned count;
+    int bad;
+    epicsInt32 last;
+} subs[NSUB];
+
+static epicsMutexId lock;
+static epicsEventId done;
+static unsigned nDone;
+static epicsInt32 lastValue;
+static int lastRemaining;
+
+static void monitor(void *user_arg, struct dbChannel *chan,
+                    int eventsRemaining, struct db_field_log *pfl)
+{
+    struct subState *st = user_arg;
+    epicsInt32 val = pfl->u.v.field.dbf_long;
+
+    epicsMutexMustLock(lock);
+    /* values arrive in order, possibly with gaps from replacement */
+    if (st->count && val <= st->last)
+        st->bad = 1;
+    st->count++;
+    st->last = val;
+    lastRemaining = eventsRemaining;
+    if (val == lastValue && ++nDone == NSUB)
+        epicsEventMustTrigger(done);
+    epicsMutexUnlock(lock);
+}
+
+static void post(xRecord *prec, epicsInt32 val)
+{
+    dbScanLock((dbCommon*)prec);
+    prec->val = val;
+    db_post_events(prec, &prec->val, DBE_VALUE);
+    dbScanUnlock((dbCommon*)prec);
+}
+
+static void testDepth(void)
+{
+    xRecord *prec = (xRecord*)testdbRecordPtr("x");
+    struct dbChannel *chan = dbChannelCreate("x.VAL");
+    dbEventCtx ctx = db_init_events();
+    epicsInt32 val = 0;
+    unsigned i, nOk;
+
+    testDiag("Subscriptions with queue depth %u", DEPTH);
+
+    testOk1(!!chan && !dbChannelOpen(chan));
+    testOk1(!!ctx);
+    testOk1(db_event_set_queue_depth(ctx, DEPTH) == DB_EVENT_OK);
+
+    lock = epicsMutexMustCreate();
+    done = epicsEventMustCreate(epicsEventEmpty);
+    memset(subs, 0, sizeof(subs));
+    nDone = 0u;
+    lastValue = 11;
+
+    for (i = 0; i < NEARLY; i++) {
+        subs[i].sub = db_add_event(ctx, chan, monitor, &subs[i], DBE_VALUE);
+        db_event_enable(subs[i].sub);
+    }
+    testOk(db_event_set_queue_depth(ctx, 1) == DB_EVENT_ERROR,
+        "Depth can not change once subscribed");
+
+    /* queue some events before the queue has to grow */
+    for (; val < 3; val++)
+        post(prec, val);
+
+    for (; i < NSUB; i++) {
+        subs[i].sub = db_add_event(ctx, chan, monitor, &subs[i], DBE_VALUE);
+        db_event_enable(subs[i].sub);
+    }
+    for (; val <= lastValue; val++)
+        post(prec, val);
+
+    testOk1(db_start_events(ctx, "dbEventTest", NULL, NULL,
+        epicsThreadPriorityLow) == DB_EVENT_OK);
+    testOk(epicsEventWaitWithTimeout(done, 10.0) == epicsEventOK,
+        "All subscriptions received the last value");
+
+    epicsMutexMustLock(lock);
+    for (i = 0, nOk = 0; i < NSUB; i++)
+        nOk += subs[i].count == DEPTH && !subs[i].bad;
+    epicsMutexUnlock(lock);
+    testOk(nOk == NSUB, "%u of %u subscriptions received %u ordered values",
+        nOk, NSUB, DEPTH);
+    testOk1(subs[0].last == lastValue);
+    testOk1(subs[NSUB-1].last == lastValue);
+    testOk(lastRemaining == 0, "No events remaining after the last one");
+
+    for (i = 0; i < NSUB; i++)
+        db_cancel_event(subs[i].sub);
+    db_close_events(ctx);
+    dbChannelDelete(chan);
+    epicsEventDestroy(done);
+    epicsMutexDestroy(lock);
+}
+
+static unsigned nCancel;
+
+static void cancelMonitor(void *user_arg, struct dbChannel *chan,
+                          int eventsRemaining, struct db_field_log *pfl)
+{
+    dbEventSubscription *psub = user_arg;
+
+    /* cancel from the event task while more events for it are queued */
+    nCancel++;
+    db_cancel_event(*psub);
+    epicsEventMustTrigger(done);
+}
+
+static void testCancel(void)
+{
+    xRecord *prec = (xRecord*)testdbRecordPtr("x");
+    struct dbChannel *chan = dbChannelCreate("x.VAL");
+    dbEventCtx ctx = db_init_events();
+    dbEventSubscription sub;
+    epicsInt32 val;
+
+    testDiag("Cancel subscription with events pending");
+
+    testOk1(!!chan && !dbChannelOpen(chan));
+    testOk1(!!ctx && db_event_set_queue_depth(ctx, DEPTH) == DB_EVENT_OK);
+    done = epicsEventMustCreate(epicsEventEmpty);
+
+    sub = db_add_event(ctx, chan, cancelMonitor, &sub, DBE_VALUE);
+    db_event_enable(sub);
+    for (val = 0; val < 5; val++)
+        post(prec, val);
+
+    testOk1(db_start_events(ctx, "dbEventTest", NULL, NULL,
+        epicsThreadPriorityLow) == DB_EVENT_OK);
+    testOk1(epicsEventWaitWithTimeout(done, 10.0) == epicsEventOK);
+    /* joins the event task, so the rest of the batch has been handled */
+    db_close_events(ctx);
+    testOk(nCancel == 1, "Canceled subscription called %u times", nCancel);
+
+    dbChannelDelete(chan);
+    epicsEventDestroy(done);
+}
+
+static unsigned counts[6];
+
+static void countMonitor(void *user_arg, struct dbChannel *chan,
+                         int eventsRemaining, struct db_field_log *pfl)
+{
+    unsigned *pcount = user_arg;
+
+    epicsMutexMustLock(lock);
+    (*pcount)++;
+    epicsMutexUnlock(lock);
+    /* the last subscription is only posted to finish a step */
+    if (pcount == &counts[5])
+        epicsEventMustTrigger(done);
+}
+
+static void checkCounts(xRecord *prec, const unsigned *expect,
+                        const char *step)
+{
+    unsigned i;
+    int ok = 1;
+
+    /* events are delivered in order, so this one arrives last */
+    dbScanLock((dbCommon*)prec);
+    db_post_events(prec, &prec->u32, DBE_VALUE);
+    dbScanUnlock((dbCommon*)prec);
+    if (epicsEventWaitWithTimeout(done, 10.0) != epicsEventOK)
+        testAbort("Timeout waiting for events");
+
+    epicsMutexMustLock(lock);
+    for (i = 0; i < 5; i++) {
+        if (counts[i] != expect[i]) {
+            testDiag("subscription %u got %u events, expected %u",
+                i, counts[i], expect[i]);
+            ok = 0;
+        }
+        counts[i] = 0u;
+    }
+    epicsMutexUnlock(lock);
+    testOk(ok, "%s", step);
+}
+
+static void testFieldIndex(void)
+{
+    static const char * const names[] = {
+        "x.VAL", "x.VAL", "x.VAL", "x.I32", "x.I32", "x.U32"
+    };
+    static const unsigned postVal[] = {1, 1, 1, 0, 0};
+    static const unsigned postI32[] = {0, 0, 0, 1, 1};
+    static const unsigned postAll[] = {1, 1, 1, 1, 1};
+    static const unsigned postNone[] = {0, 0, 0, 0, 0};
+    static const unsigned postDisabled[] = {1, 0, 1, 0, 0};
+    xRecord *prec = (xRecord*)testdbRecordPtr("x");
+    struct dbChannel *chans[6];
+    dbEventSubscription subs[6];
+    dbEventCtx ctx = db_init_events();
+    unsigned i;
+
+    testDiag("Posting to the subscribers of one field");
+
+    lock = epicsMutexMustCreate();
+    done = epicsEventMustCreate(epicsEventEmpty);
+    memset(counts, 0, sizeof(counts));
+
+    testOk1(!!ctx && db_start_events(ctx, "dbEventTest", NULL, NULL,
+        epicsThreadPriorityLow) == DB_EVENT_OK);
+    for (i = 0; i < 6; i++) {
+        chans[i] = dbChannelCreate(names[i]);
+        if (!chans[i] || dbChannelOpen(chans[i]))
+            testAbort("Can't open %s", names[i]);
+        subs[i] = db_add_event(ctx, chans[i], countMonitor, &counts[i],
+            DBE_VALUE);
+        db_event_enable(subs[i]);
+    }
+
+    dbScanLock((dbCommon*)prec);
+    db_post_events(prec, &prec->val, DBE_VALUE);
+    dbScanUnlock((dbCommon*)prec);
+    checkCounts(prec, postVal, "Post VAL");
+
+    dbScanLock((dbCommon*)prec);
+    db_post_events(prec, &prec->i32, DBE_LOG);
+    db_post_events(prec, &prec->i64, DBE_VALUE);
+    dbScanUnlock((dbCommon*)prec);
+    checkCounts(prec, postNone, "Post unselected mask and unmonitored field");
+
+    dbScanLock((dbCommon*)prec);
+    db_post_events(prec, &prec->i32, DBE_VALUE);
+    dbScanUnlock((dbCommon*)prec);
+    checkCounts(prec, postI32, "Post I32");
+
+    dbScanLock((dbCommon*)prec);
+    db_post_events(prec, NULL, DBE_VALUE);
+    dbScanUnlock((dbCommon*)prec);
+    /* the post of all fields also reached the last subscription */
+    epicsEventMustWait(done);
+    checkCounts(prec, postAll, "Post all fields");
+
+    db_event_disable(subs[1]);
+    db_cancel_event(subs[3]);
+    db_cancel_event(subs[4]);
+    dbScanLock((dbCommon*)prec);
+    db_post_events(prec, &prec->val, DBE_VALUE);
+    db_post_events(prec, &prec->i32, DBE_VALUE);
+    dbScanUnlock((dbCommon*)prec);
+    checkCounts(prec, postDisabled, "Post after disable and cancel");
+
+    for (i = 0; i < 6; i++) {
+        if (i != 3 && i != 4)
+            db_cancel_event(subs[i]);
+    }
+    testOk1(dbRec2Pvt((dbCommon*)prec)->midx == NULL);
+
+    db_close_events(ctx);
+    for (i = 0; i < 6; i++)
+        dbChannelDelete(chans[i]);
+    epicsEventDestroy(done);
+    epicsMutexDestroy(lock);
+}
+
+static struct arrState {
+    unsigned count;
+    const void *field;
+    long nelem;
+    epicsInt32 value[4];
+    int copy;
+} arrs[3];
+
+static void arrMonitor(void *user_arg, struct dbChannel *chan,
+                       int eventsRemaining, struct db_field_log *pfl)
+{
+    struct arrState *st = user_arg;
+
+    epicsMutexMustLock(lock);
+    st->count++;
+    st->field = pfl->u.r.field;
+    st->nelem = pfl->no_elements;
+    st->copy = dbfl_has_copy(pfl);
+    if (pfl->no_elements == 4)
+        memcpy(st->value, pfl->u.r.field, sizeof(st->value));
+    if (++nDone == 3u)
+        epicsEventMustTrigger(done);
+    epicsMutexUnlock(lock);
+}
+
+static void testSnapshot(void)
+{
+    static const epicsInt32 expect[4] = {12, 13, 14, 15};
+    arrRecord *prec = (arrRecord*)testdbRecordPtr("i32");
+    epicsInt32 *pval = prec->bptr;
+    struct dbChannel *chan = dbChannelCreate("i32");
+    dbEventSubscription asubs[3];
+    dbEventCtx ctx = db_init_events();
+    unsigned i;
+
+    testDiag("Array subscribers sharing one snapshot");
+
+    testOk1(!!chan && !dbChannelOpen(chan));
+    testOk1(!!ctx);
+    lock = epicsMutexMustCreate();
+    done = epicsEventMustCreate(epicsEventEmpty);
+    memset(arrs, 0, sizeof(arrs));
+    nDone = 0u;
+
+    for (i = 0; i < 3; i++) {
+        asubs[i] = db_add_event(ctx, chan, arrMonitor, &arrs[i], DBE_VALUE);
+        db_event_enable(asubs[i]);
+    }
+
+    dbScanLock((dbCommon*)prec);
+    for (i = 0; i < 10; i++)
+        pval[i] = i;
+    prec->nord = 3;
+    db_post_events(prec, &prec->val, DBE_VALUE);
+    /* a newer snapshot replaces the one still queued */
+    for (i = 0; i < 10; i++)
+        pval[i] = 10 + i;
+    prec->nord = 4;
+    prec->off = 2;
+    db_post_events(prec, &prec->val, DBE_VALUE);
+    /* the record's array changes after the post */
+    pval[2] = -1;
+    prec->off = 0;
+    dbScanUnlock((dbCommon*)prec);
+
+    testOk1(db_start_events(ctx, "dbEventTest", NULL, NULL,
+        epicsThreadPriorityLow) == DB_EVENT_OK);
+    testOk1(epicsEventWaitWithTimeout(done, 10.0) == epicsEventOK);
+    for (i = 0; i < 3; i++)
+        db_cancel_event(asubs[i]);
+    db_close_events(ctx);
+
+    for (i = 0; i < 3; i++) {
+        testOk(arrs[i].count == 1 && arrs[i].copy && arrs[i].nelem == 4 &&
+            !memcmp(arrs[i].value, expect, sizeof(expect)),
+            "Subscription %u got one copy of the last array", i);
+    }
+    testOk(arrs[0].field == arrs[1].field && arrs[1].field == arrs[2].field &&
+        arrs[0].field != (void*)pval, "Copy was shared");
+
+    dbChannelDelete(chan);
+    epicsEventDestroy(done);
+    epicsMutexDestroy(lock);
+}
+
+static struct batchState {
+    unsigned count;
+    unsigned mask;
+} bstate[3];
+
+static void batchMonitor(void *user_arg, struct dbChannel *chan,
+                         int eventsRemaining, struct db_field_log *pfl)
+{
+    struct batchState *st = user_arg;
+
+    epicsMutexMustLock(lock);
+    st->count++;
+    st->mask |= pfl->mask;
+    epicsMutexUnlock(lock);
+    if (st == &bstate[2])
+        epicsEventMustTrigger(done);
+}
+
+static void batchProcess(xRecord *prec)
+{
+    db_post_events(prec, &prec->val, DBE_VALUE);
+    db_post_events(prec, &prec->i32, DBE_VALUE);
+    db_post_events(prec, &prec->val, DBE_LOG);
+    db_post_events(prec, &prec->val, DBE_ALARM);
+}
+
+static void testBatchCycle(xRecord *prec, int batch)
+{
+    /* three posts from batchProcess() and one from monitor() */
+    unsigned nVal = batch ? 1u : 4u;
+
+    testDiag("Process with dbEventPostBatch=%d", batch);
+
+    dbEventPostBatch = batch;
+    epicsMutexMustLock(lock);
+    memset(bstate, 0, sizeof(bstate));
+    epicsMutexUnlock(lock);
+
+    dbScanLock((dbCommon*)prec);
+    dbProcess((dbCommon*)prec);
+    /* not processing, so posted at once and delivered last */
+    db_post_events(prec, &prec->u32, DBE_VALUE);
+    dbScanUnlock((dbCommon*)prec);
+    if (epicsEventWaitWithTimeout(done, 10.0) != epicsEventOK)
+        testAbort("Timeout waiting for events");
+
+    epicsMutexMustLock(lock);
+    testOk(bstate[0].count == nVal, "VAL posted %u times, expected %u",
+        bstate[0].count, nVal);
+    testOk(bstate[0].mask == (DBE_VALUE|DBE_LOG|DBE_ALARM),
+        "VAL posted with mask %#x", bstate[0].mask);
+    testOk(bstate[1].count == 1u, "I32 posted %u times", bstate[1].count);
+    epicsMutexUnlock(lock);
+    dbEventPostBatch = 0;
+}
+
+static void testPostBatch(void)
+{
+    static const char * const names[] = {"x.VAL", "x.I32", "x.U32"};
+    xRecord *prec = (xRecord*)testdbRecordPtr("x");
+    struct dbChannel *chans[3];
+    dbEventSubscription bsubs[3];
+    dbEventCtx ctx = db_init_events();
+    unsigned i;
+
+    testDiag("Merging posts while a record is processed");
+
+    lock = epicsMutexMustCreate();
+    done = epicsEventMustCreate(epicsEventEmpty);
+    testOk1(!!ctx && db_start_events(ctx, "dbEventTest", NULL, NULL,
+        epicsThreadPriorityLow) == DB_EVENT_OK);
+    for (i = 0; i < 3; i++) {
+        chans[i] = dbChannelCreate(names[i]);
+        if (!chans[i] || dbChannelOpen(chans[i]))
+            testAbort("Can't open %s", names[i]);
+        bsubs[i] = db_add_event(ctx, chans[i], batchMonitor, &bstate[i],
+            DBE_VALUE|DBE_LOG|DBE_ALARM);
+        db_event_enable(bsubs[i]);
+    }
+    prec->clbk = batchProcess;
+
+    testBatchCycle(prec, 0);
+    testBatchCycle(prec, 1);
+
+    prec->clbk = NULL;
+    for (i = 0; i < 3; i++) {
+        db_cancel_event(bsubs[i]);
+        dbChannelDelete(chans[i]);
+    }
+    db_close_events(ctx);
+    epicsEventDestroy(done);
+    epicsMutexDestroy(lock);
+}
+
+static void replaceMonitor(void *user_arg, struct dbChannel *chan,
+                           int eventsRemaining, struct db_field_log *pfl)
+{
+}
+
+static void testReplaced(void)
+{
+    xRecord *prec = (xRecord*)testdbRecordPtr("x");
+    struct dbChannel *chan = dbChannelCreate("x.VAL");
+    dbEventCtx ctx = db_init_events();
+    dbEventSubscription sub;
+    int i;
+
+    testDiag("Updates replaced in flow control mode");
+
+    testOk1(!!chan && !dbChannelOpen(chan));
+    testOk1(!!ctx);
+
+    sub = db_add_event(ctx, chan, replaceMonitor, NULL, DBE_VALUE);
+    db_event_enable(sub);
+
+    /* the event task isn't running, so posts stay queued */
+    for (i = 0; i < 2; i++)
+        post(prec, i);
+    testOk(db_event_replaced(ctx) == 0, "No updates replaced normally");
+
+    db_event_flow_ctrl_mode_on(ctx);
+    for (i = 2; i < 5; i++)
+        post(prec, i);
+    testOk(db_event_replaced(ctx) == 3,
+        "Flow control replaced %lu updates", db_event_replaced(ctx));
+
+    db_event_flow_ctrl_mode_off(ctx);
+    for (i = 5; i < 7; i++)
+        post(prec, i);
+    testOk(db_event_replaced(ctx) == 3,
+        "No updates replaced once flow control is off");
+
+    testOk1(db_start_events(ctx, "dbEventTest", NULL, NULL,
+        epicsThreadPriorityLow) == DB_EVENT_OK);
+    db_cancel_event(sub);
+    db_close_events(ctx);
+    dbChannelDelete(chan);
+}
+
+static unsigned nWake;
+static unsigned nPolled;
+static epicsThreadId polledBy;
+
+static void pollWake(void *arg)
+{
+    nWake++;
+}
+
+static void pollMonitor(void *user_arg, struct dbChannel *chan,
+                        int eventsRemaining, struct db_field_log *pfl)
+{
+    nPolled++;
+    polledBy = epicsThreadGetIdSelf();
+}
+
+static void testPolled(void)
+{
+    xRecord *prec = (xRecord*)testdbRecordPtr("x");
+    struct dbChannel *chan = dbChannelCreate("x.VAL");
+    dbEventCtx ctx = db_init_events();
+    dbEventSubscription sub;
+    unsigned woken;
+    epicsInt32 val;
+
+    testDiag("Event context served by polling");
+
+    testOk1(!!chan && !dbChannelOpen(chan));
+    testOk1(!!ctx && db_event_set_queue_depth(ctx, DEPTH) == DB_EVENT_OK);
+    nWake = nPolled = 0u;
+    polledBy = NULL;
+
+    sub = db_add_event(ctx, chan, pollMonitor, NULL, DBE_VALUE);
+    db_event_enable(sub);
+    testOk1(db_start_events_polled(ctx, pollWake, NULL) == DB_EVENT_OK);
+    testOk1(db_start_events(ctx, "dbEventTest", NULL, NULL,
+        epicsThreadPriorityLow) == DB_EVENT_OK);
+
+    for (val = 0; val < 3; val++)
+        post(prec, val);
+    testOk(nWake > 0, "Posting called the wake function %u times", nWake);
+    epicsThreadSleep(0.1);
+    testOk(nPolled == 0, "No event task, nothing delivered before polling");
+
+    db_poll_events(ctx);
+    testOk(nPolled == 3, "Poll delivered %u of 3 values", nPolled);
+    testOk1(polledBy == epicsThreadGetIdSelf());
+
+    /* a queued event for a canceled subscription is dropped on close */
+    woken = nWake;
+    post(prec, val);
+    testOk1(nWake > woken);
+    db_cancel_event(sub);
+    db_close_events(ctx);
+    testOk(nPolled == 3, "Canceled subscription not called on close");
+
+    dbChannelDelete(chan);
+}
+
+MAIN(dbEventTest)
+{
+    testPlan(53);
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("xRecord.db", NULL, NULL);
+    testdbReadDatabase("dbChArrTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testDepth();
+    testCancel();
+    testFieldIndex();
+    testSnapshot();
+    testPostBatch();
+    testReplaced();
+    testPolled();
+
+    testIocShutdownOk();
+    testdbCleanup();
+
+    return testDone();
+}
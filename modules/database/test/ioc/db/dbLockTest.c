@@ -11,11 +11,14 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "epicsSpin.h"
 #include "epicsMutex.h"
 #include "dbCommon.h"
 #include "epicsThread.h"
+#include "epicsEvent.h"
+#include "epicsAtomic.h"
 
 #include "dbLockPvt.h"
 #include "dbStaticLib.h"
@@ -414,12 +417,237 @@ static void testLinkNOP(void)
     testdbCleanup();
 }
 
+typedef struct {
+    dbCommon *prec;
+    epicsEventId started;
+    epicsEventId done;
+} profileWaiter;
+
+static void profileWaitThread(void *raw)
+{
+    profileWaiter *pwait = raw;
+    epicsEventMustTrigger(pwait->started);
+    dbScanLock(pwait->prec);
+    dbScanUnlock(pwait->prec);
+    epicsEventMustTrigger(pwait->done);
+}
+
+static void testProfile(void)
+{
+    dbCommon *precA, *precB, *precC, *precD, *precE, *precG;
+    lockSet *lD;
+    lockSetLink *plink;
+    profileWaiter waiter;
+    testDiag("Test lock set contention profiling");
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbLockTest.db", NULL, NULL);
+
+    /* merging links are only remembered while profiling */
+    dbLockProfile = 1;
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    dbLockProfile = 0;
+
+    precA = testdbRecordPtr("reca");
+    precB = testdbRecordPtr("recb");
+    precC = testdbRecordPtr("recc");
+    precD = testdbRecordPtr("recd");
+    precE = testdbRecordPtr("rece");
+    precG = testdbRecordPtr("recg");
+    lD = precD->lset->plockSet;
+
+    /* recd -> rece -> recf */
+    testIntOk1(ellCount(&lD->mergeList), ==, 2);
+    testIntOk1(ellCount(&precA->lset->plockSet->mergeList), ==, 0);
+    testIntOk1(ellCount(&precB->lset->plockSet->mergeList), ==, 1);
+
+    memset(&lD->stats, 0, sizeof(lD->stats));
+    dbScanLock(precD);
+    testOk1(lD->stats.nLock==0);
+    dbScanUnlock(precD);
+
+    dbLockProfile = 1;
+
+    dbScanLock(precD);
+    dbScanLock(precE);
+    dbScanUnlock(precE);
+    epicsThreadSleep(0.01);
+    dbScanUnlock(precD);
+    testOk(lD->stats.nLock==1, "nLock %lu", lD->stats.nLock);
+    testOk1(lD->stats.nContend==0);
+    testOk1(lD->stats.holdMax>0);
+    testPtrOk1(lD->stats.holdMaxRec, ==, precD);
+    testIntOk1(lD->depth, ==, 0);
+
+    waiter.prec = precE;
+    waiter.started = epicsEventMustCreate(epicsEventEmpty);
+    waiter.done = epicsEventMustCreate(epicsEventEmpty);
+
+    dbScanLock(precD);
+    epicsThreadMustCreate("lockWaiter", epicsThreadPriorityMedium,
+                          epicsThreadGetStackSize(epicsThreadStackSmall),
+                          &profileWaitThread, &waiter);
+    epicsEventMustWait(waiter.started);
+    epicsThreadSleep(0.1);
+    dbScanUnlock(precD);
+    epicsEventMustWait(waiter.done);
+
+    testOk(lD->stats.nLock==3, "nLock %lu", lD->stats.nLock);
+    testOk(lD->stats.nContend==1, "nContend %lu", lD->stats.nContend);
+    testOk1(lD->stats.waitTotal>0);
+    testOk1(lD->stats.waitMax==lD->stats.waitTotal);
+    testPtrOk1(lD->stats.holdMaxRec, ==, precD);
+
+    epicsEventDestroy(waiter.started);
+    epicsEventDestroy(waiter.done);
+
+    /* a new link is remembered as the reason for the merge */
+    testdbPutFieldOk("reca.SDIS", DBR_STRING, "recg");
+    testPtrOk1(precA->lset->plockSet, ==, precG->lset->plockSet);
+    testIntOk1(ellCount(&precA->lset->plockSet->mergeList), ==, 1);
+    plink = (lockSetLink*)ellFirst(&precA->lset->plockSet->mergeList);
+    testOk1(plink && plink->pfirst==precA && plink->psecond==precG);
+
+    /* and forgotten once it is broken */
+    testdbPutFieldOk("recb.SDIS", DBR_STRING, "");
+    testPtrOk1(precB->lset->plockSet, !=, precC->lset->plockSet);
+    testIntOk1(ellCount(&precB->lset->plockSet->mergeList), ==, 0);
+    testIntOk1(ellCount(&precC->lset->plockSet->mergeList), ==, 0);
+
+    testOk1(dblsc(2, 1)==0);
+
+    dbLockProfile = 0;
+
+    /* without profiling a merge allocates nothing */
+    testdbPutFieldOk("recb.SDIS", DBR_STRING, "recc");
+    testPtrOk1(precB->lset->plockSet, ==, precC->lset->plockSet);
+    testIntOk1(ellCount(&precB->lset->plockSet->mergeList), ==, 0);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
+typedef struct {
+    DBADDR addr;
+    int stop;
+    epicsEventId done;
+} seqWriter;
+
+/* keep VAL and TIME equal, as record processing would */
+static void seqWriteThread(void *raw)
+{
+    seqWriter *pwrite = raw;
+    dbCommon *prec = pwrite->addr.precord;
+    epicsInt32 i = 0;
+
+    while(!epicsAtomicGetIntT(&pwrite->stop)) {
+        i++;
+        dbScanLock(prec);
+        prec->time.secPastEpoch = i;
+        dbPut(&pwrite->addr, DBR_LONG, &i, 1);
+        prec->time.nsec = i;
+        dbScanUnlock(prec);
+    }
+    epicsEventMustTrigger(pwrite->done);
+}
+
+static void testOptimisticGet(void)
+{
+    dbCommon *precA;
+    lockSet *lA;
+    size_t seq;
+    seqWriter writer;
+    struct {
+        DBRtime
+        epicsInt32 value;
+    } buf;
+    long options, nReq;
+    unsigned i, torn = 0;
+    testDiag("Test optimistic reads");
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbLockTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    precA = testdbRecordPtr("reca");
+    lA = precA->lset->plockSet;
+
+    testdbPutFieldOk("reca.VAL", DBR_LONG, 42);
+
+    seq = lA->seq;
+    testOk(!(seq&1), "seq %u even when unlocked", (unsigned)seq);
+    testdbGetFieldEqual("reca.VAL", DBR_LONG, 42);
+    testOk(lA->seq==seq+2, "seq %u locked for read", (unsigned)lA->seq);
+
+    dbLockOptimisticGet = 1;
+
+    seq = lA->seq;
+    testdbGetFieldEqual("reca.VAL", DBR_LONG, 42);
+    testdbGetFieldEqual("reca.VAL", DBR_DOUBLE, 42.0);
+    testOk(lA->seq==seq, "seq %u not locked for read", (unsigned)lA->seq);
+
+    /* not eligible */
+    testdbGetFieldEqual("reca.VAL", DBR_STRING, "42");
+    testdbGetFieldEqual("reca.NAME", DBR_STRING, "reca");
+    testOk(lA->seq==seq+4, "seq %u locked for read", (unsigned)lA->seq);
+
+    /* falls back to a recursive lock */
+    dbScanLock(precA);
+    testOk1(lA->seq&1);
+    testdbGetFieldEqual("reca.VAL", DBR_LONG, 42);
+    dbScanUnlock(precA);
+    testOk1(!(lA->seq&1));
+
+    testOk1(dbNameToAddr("reca.VAL", &writer.addr)==0);
+    writer.stop = 0;
+    writer.done = epicsEventMustCreate(epicsEventEmpty);
+
+    epicsThreadMustCreate("seqWriter", epicsThreadPriorityMedium,
+                          epicsThreadGetStackSize(epicsThreadStackSmall),
+                          &seqWriteThread, &writer);
+
+    for(i=0; i<20000; i++) {
+        options = DBR_TIME;
+        nReq = 1;
+        if(dbGetField(&writer.addr, DBR_LONG, &buf, &options, &nReq, NULL) ||
+           buf.time.secPastEpoch != (epicsUInt32)buf.value ||
+           buf.time.nsec != (epicsUInt32)buf.value)
+            torn++;
+    }
+
+    epicsAtomicSetIntT(&writer.stop, 1);
+    epicsEventMustWait(writer.done);
+    epicsEventDestroy(writer.done);
+
+    testOk(torn==0, "%u inconsistent reads", torn);
+
+    dbLockOptimisticGet = 0;
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
 MAIN(dbLockTest)
 {
 #ifdef LOCKSET_DEBUG
-    testPlan(100);
+    testPlan(141);
 #else
-    testPlan(88);
+    testPlan(129);
 #endif
     testSets();
     testSingleLock();
@@ -428,5 +656,7 @@ MAIN(dbLockTest)
     testLinkMake();
     testLinkChange();
     testLinkNOP();
+    testProfile();
+    testOptimisticGet();
     return testDone();
 }
@@ -10,17 +10,28 @@
  *  Author: Michael Davidsaver <mdavidsaver@bnl.gov>
  */
 
+#include <stdio.h>
 #include <string.h>
+#include <math.h>
 
 #include "dbScan.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
+#include "epicsMutex.h"
+#include "epicsString.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
 
 #include "dbUnitTest.h"
 #include "testMain.h"
 
 #include "dbAccess.h"
+#include "dbLock.h"
+#include "dbDefs.h"
 #include "errlog.h"
 
+#include "xRecord.h"
+
 void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
 
 static epicsEventId waiter;
@@ -66,9 +77,253 @@ static void testOnce(void)
     epicsEventDestroy(waiter);
 }
 
+static const char * const parallelRecs[] = {
+    "reca", "recb", "recc", "recd", "rece", "recf", "recg"
+};
+#define NPARALLEL NELEMENTS(parallelRecs)
+
+static int parallelCount[NPARALLEL];
+static int parallelBusy;    /* recd, rece and recf share a lock set */
+static int parallelBad;
+
+static void parallelClbk(xRecord *prec)
+{
+    size_t i;
+
+    for (i = 0; i < NPARALLEL; i++) {
+        if (strcmp(prec->name, parallelRecs[i]) == 0)
+            epicsAtomicIncrIntT(&parallelCount[i]);
+    }
+    if (strcmp(prec->name, "recd") >= 0 && strcmp(prec->name, "recf") <= 0) {
+        if (epicsAtomicIncrIntT(&parallelBusy) != 1)
+            epicsAtomicIncrIntT(&parallelBad);
+        epicsThreadSleep(0.001);
+        epicsAtomicDecrIntT(&parallelBusy);
+    }
+}
+
+static void testPeriodic(int threads, int slices)
+{
+    size_t i;
+
+    testDiag("check periodic scanning with %d threads and %d slices",
+        threads, slices);
+
+    memset(parallelCount, 0, sizeof(parallelCount));
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbLockTest.db", NULL, NULL);
+
+    testOk1(scanParallelThreads(threads) == 0);
+    testOk1(scanPeriodSlices(".1 second", slices) == 0);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testOk1(scanParallelThreads(threads) == -1);
+    testOk1(scanPeriodSlices(".1 second", slices) == -1);
+
+    for (i = 0; i < NPARALLEL; i++) {
+        xRecord *prec = (xRecord *)testdbRecordPtr(parallelRecs[i]);
+        char pv[32];
+
+        dbScanLock((dbCommon *)prec);
+        prec->clbk = parallelClbk;
+        dbScanUnlock((dbCommon *)prec);
+        sprintf(pv, "%s.SCAN", parallelRecs[i]);
+        testdbPutFieldOk(pv, DBF_STRING, ".1 second");
+    }
+
+    epicsThreadSleep(0.55);
+
+    /* stop scanning before taking the counts */
+    for (i = 0; i < NPARALLEL; i++) {
+        char pv[32];
+
+        sprintf(pv, "%s.SCAN", parallelRecs[i]);
+        testdbPutFieldOk(pv, DBF_STRING, "Passive");
+    }
+    for (i = 0; i < NPARALLEL; i++) {
+        int count = epicsAtomicGetIntT(&parallelCount[i]);
+        testOk(count >= 2, "%s processed %d times", parallelRecs[i], count);
+    }
+    testOk(epicsAtomicGetIntT(&parallelBad) == 0,
+        "Lock set processed serially (%d overlaps)",
+        epicsAtomicGetIntT(&parallelBad));
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+    scanParallelThreads(0);
+}
+
+static void testModify(void)
+{
+    xRecord *prec;
+    int i, count;
+
+    testDiag("check periodic scanning while scan lists are changed");
+
+    memset(parallelCount, 0, sizeof(parallelCount));
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbLockTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    prec = (xRecord *)testdbRecordPtr("recg");
+    dbScanLock((dbCommon *)prec);
+    prec->clbk = parallelClbk;
+    dbScanUnlock((dbCommon *)prec);
+    testdbPutFieldOk("recg.SCAN", DBF_STRING, ".1 second");
+
+    /* Churn the scan list around recg */
+    for (i = 0; i < 100; i++) {
+        dbCommon *pother = testdbRecordPtr(parallelRecs[i % 6]);
+        short scan = (i / 6) % 2 ? menuScanPassive : menuScan_1_second;
+
+        dbScanLock(pother);
+        scanDelete(pother);
+        pother->scan = scan;
+        scanAdd(pother);
+        dbScanUnlock(pother);
+        epicsThreadSleep(0.005);
+    }
+
+    testdbPutFieldOk("recg.SCAN", DBF_STRING, "Passive");
+    count = epicsAtomicGetIntT(&parallelCount[6]);
+    testOk(count >= 3, "recg processed %d times", count);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
+static epicsMutexId staggerLock;
+static epicsTimeStamp staggerTime[NPARALLEL];
+
+static void staggerClbk(xRecord *prec)
+{
+    size_t i;
+
+    for (i = 0; i < NPARALLEL; i++) {
+        if (strcmp(prec->name, parallelRecs[i]) == 0) {
+            epicsMutexMustLock(staggerLock);
+            epicsTimeGetMonotonic(&staggerTime[i]);
+            epicsMutexUnlock(staggerLock);
+        }
+    }
+}
+
+static void testStagger(void)
+{
+    const int slices = 4;
+    const double period = 0.5;
+    unsigned int slice[NPARALLEL];
+    int distinct = 0;
+    size_t i;
+
+    testDiag("check that slices stagger records within the period");
+
+    staggerLock = epicsMutexMustCreate();
+    memset(staggerTime, 0, sizeof(staggerTime));
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbLockTest.db", NULL, NULL);
+
+    testOk1(scanPeriodSlices(".5 second", slices) == 0);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    for (i = 0; i < NPARALLEL; i++) {
+        xRecord *prec = (xRecord *)testdbRecordPtr(parallelRecs[i]);
+        char pv[32];
+
+        /* same selection as dbScan */
+        slice[i] = epicsStrHash(parallelRecs[i], 0) % slices;
+        if (slice[i] != slice[0])
+            distinct = 1;
+
+        dbScanLock((dbCommon *)prec);
+        prec->clbk = staggerClbk;
+        dbScanUnlock((dbCommon *)prec);
+        sprintf(pv, "%s.SCAN", parallelRecs[i]);
+        testdbPutFieldOk(pv, DBF_STRING, ".5 second");
+    }
+    testOk(distinct, "Records fall in more than one slice");
+
+    epicsThreadSleep(1.2);
+
+    for (i = 0; i < NPARALLEL; i++) {
+        char pv[32];
+
+        sprintf(pv, "%s.SCAN", parallelRecs[i]);
+        testdbPutFieldOk(pv, DBF_STRING, "Passive");
+    }
+
+    /* Offsets from reca's processing match the slice differences */
+    epicsMutexMustLock(staggerLock);
+    for (i = 1; i < NPARALLEL; i++) {
+        double offset = fmod(epicsTimeDiffInSeconds(&staggerTime[i],
+            &staggerTime[0]), period);
+        double expect = ((slice[i] + slices - slice[0]) % slices) *
+            period / slices;
+        double error;
+
+        if (offset < 0.0)
+            offset += period;
+        error = fabs(offset - expect);
+        if (error > period / 2)
+            error = period - error;
+        testOk(error < period / slices / 2,
+            "%s in slice %u, %.3f sec after reca in slice %u",
+            parallelRecs[i], slice[i], offset, slice[0]);
+    }
+    epicsMutexUnlock(staggerLock);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+    epicsMutexDestroy(staggerLock);
+}
+
+static void testSliceConfig(void)
+{
+    testDiag("check scanPeriodSlices() arguments");
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+
+    testOk1(scanPeriodSlices("nonesuch", 4) == -1);
+    testOk1(scanPeriodSlices("*", 1) == 0);
+
+    testdbCleanup();
+}
+
 MAIN(dbScanTest)
 {
-    testPlan(3);
+    testPlan(108);
     testOnce();
+    testSliceConfig();
+    testPeriodic(2, 1);
+    testPeriodic(0, 4);
+    testPeriodic(2, 4);
+    testModify();
+    testStagger();
     return testDone();
 }
@@ -7,6 +7,7 @@
 #include <string.h>
 
 #include <errlog.h>
+#include <epicsStdio.h>
 #include <osiFileName.h>
 #include <dbAccess.h>
 #include <dbStaticLib.h>
@@ -303,6 +304,120 @@ static void testWrongAliasRecord(const char *filename)
            "Wrong alias record in %s is expected to fail", filename);
 }
 
+static void testFieldHash(const char *record)
+{
+    DBENTRY entry;
+    dbRecordType *prt;
+    struct dbFldHash *phash;
+    int nohash = 0, bad = 0, i;
+    static const char * const missing[] = {"VA", "VALX", "DESCR", "X", "_"};
+
+    testDiag("Field name hash for %s", record);
+
+    for (prt = (dbRecordType *)ellFirst(&pdbbase->recordTypeList); prt;
+         prt = (dbRecordType *)ellNext(&prt->node)) {
+        if (!prt->pfldHash) {
+            testDiag("recordtype(%s) has no field hash", prt->name);
+            nohash++;
+        }
+    }
+    testOk(nohash == 0, "All record types have a field hash");
+
+    dbInitEntry(pdbbase, &entry);
+    if (dbFindRecord(&entry, record)) {
+        testAbort("Unable to find record %s", record);
+    }
+    prt = entry.precordType;
+    phash = prt->pfldHash;
+    for (i = 0; i < prt->no_fields; i++) {
+        const char *name = prt->papFldDes[i]->name;
+        long status = dbFindField(&entry, name);
+
+        if (status || entry.indfield != i) {
+            testDiag("Field %s found as %d, status %ld",
+                name, entry.indfield, status);
+            bad++;
+        }
+        /* Same result through the binary search */
+        prt->pfldHash = NULL;
+        status = dbFindField(&entry, name);
+        prt->pfldHash = phash;
+        if (status || entry.indfield != i)
+            bad++;
+    }
+    testOk(bad == 0, "All %d fields of %s found", prt->no_fields, record);
+
+    for (i = 0; i < NELEMENTS(missing); i++)
+        testOk(dbFindField(&entry, missing[i]) == S_dbLib_fieldNotFound,
+            "Field %s not found", missing[i]);
+
+    dbFinishEntry(&entry);
+}
+
+static void testPvdGrow(int nrec)
+{
+    DBENTRY entry;
+    char name[32];
+    int i, created = 0, found = 0, deleted = 0, gone = 0, kept = 0;
+
+    testDiag("PV directory with %d more records", nrec);
+
+    dbInitEntry(pdbbase, &entry);
+    if (dbFindRecordType(&entry, "x"))
+        testAbort("Unable to find recordtype x");
+    for (i = 0; i < nrec; i++) {
+        epicsSnprintf(name, sizeof(name), "pvd:%d", i);
+        if (!dbCreateRecord(&entry, name))
+            created++;
+    }
+    testOk(created == nrec, "Created %d records", created);
+    testOk(dbCreateRecord(&entry, "pvd:0") != 0, "Duplicate name rejected");
+
+    for (i = 0; i < nrec; i++) {
+        epicsSnprintf(name, sizeof(name), "pvd:%d", i);
+        if (!dbFindRecord(&entry, name) &&
+            strcmp(dbGetRecordName(&entry), name) == 0)
+            found++;
+    }
+    testOk(found == nrec, "Found %d records", found);
+    testOk(dbFindRecord(&entry, "pvd:") != 0, "No record pvd:");
+
+    for (i = 0, found = 0; i < nrec; i++) {
+        epicsSnprintf(name, sizeof(name), "pvd:%d", i);
+        found += dbPvdMayContain(pdbbase, name, strlen(name));
+    }
+    testOk(found == nrec, "Name filter passes all %d records", found);
+    for (i = 0, found = 0; i < nrec; i++) {
+        epicsSnprintf(name, sizeof(name), "nopvd:%d", i);
+        found += dbPvdMayContain(pdbbase, name, strlen(name));
+    }
+    testOk(found * 100 < nrec, "Name filter passes %d of %d other names",
+        found, nrec);
+
+    for (i = 0; i < nrec; i += 2) {
+        epicsSnprintf(name, sizeof(name), "pvd:%d", i);
+        if (!dbFindRecord(&entry, name) && !dbDeleteRecord(&entry))
+            deleted++;
+    }
+    for (i = 0; i < nrec; i++) {
+        epicsSnprintf(name, sizeof(name), "pvd:%d", i);
+        if (dbFindRecord(&entry, name))
+            gone++;
+        else
+            kept++;
+    }
+    testOk(gone == deleted && kept == nrec - deleted,
+        "Deleted %d, %d left", gone, kept);
+
+    for (i = 1; i < nrec; i += 2) {
+        epicsSnprintf(name, sizeof(name), "pvd:%d", i);
+        if (!dbFindRecord(&entry, name))
+            dbDeleteRecord(&entry);
+    }
+    testOk1(!dbFindRecord(&entry, "testrec"));
+    dbFinishEntry(&entry);
+}
+
 void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
 
 MAIN(dbStaticTest)
@@ -310,7 +425,7 @@ MAIN(dbStaticTest)
     const char *ldir;
     FILE *fp = NULL;
 
-    testPlan(312);
+    testPlan(327);
     testdbPrepare();
 
     testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
@@ -340,6 +455,8 @@ MAIN(dbStaticTest)
     testRec2Entry("testalias");
     testRec2Entry("testalias2");
     testRec2Entry("testalias3");
+    testFieldHash("testrec");
+    testPvdGrow(5000);
 
     eltc(0);
     testIocInitOk();
@@ -24,6 +24,7 @@ int dbStateTest(void);
 int dbServerTest(void);
 int dbCaStatsTest(void);
 int dbShutdownTest(void);
+int dbEventTest(void);
 int dbScanTest(void);
 int scanIoTest(void);
 int dbLockTest(void);
@@ -47,6 +48,7 @@ void epicsRunDbTests(void)
     runTest(dbServerTest);
     runTest(dbCaStatsTest);
     runTest(dbShutdownTest);
+    runTest(dbEventTest);
     runTest(dbScanTest);
     runTest(scanIoTest);
     runTest(dbLockTest);
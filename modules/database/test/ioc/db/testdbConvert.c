@@ -9,6 +9,7 @@
 
 #include "cantProceed.h"
 #include "dbConvert.h"
+#include "dbConvertFastPvt.h"
 #include "dbDefs.h"
 #include "epicsAssert.h"
 
@@ -149,10 +150,102 @@ static void testBasicPut(void)
     free(scratch);
 }
 
+static void testConvertWrap(void)
+{
+    double dbuf[NELEMENTS(s_input)+1];
+    short sbuf[NELEMENTS(s_input)];
+    DBADDR addr;
+    long i;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.field_type = DBF_SHORT;
+    addr.field_size = sizeof(short);
+    addr.no_elements = s_input_len;
+    addr.pfield = (void*)s_input;
+
+    testDiag("Test dbGetConvertRoutine[DBF_SHORT][DBR_DOUBLE]");
+
+    for(i=0; i<(long)NELEMENTS(dbuf); i++)
+        dbuf[i] = 42.0;
+
+    dbGetConvertRoutine[DBF_SHORT][DBR_DOUBLE](&addr, dbuf, 4, s_input_len, 5);
+    testOk(dbuf[0]==s_input[5] && dbuf[1]==s_input[6],
+           "before wrap %g %g", dbuf[0], dbuf[1]);
+    testOk(dbuf[2]==s_input[0] && dbuf[3]==s_input[1],
+           "after wrap %g %g", dbuf[2], dbuf[3]);
+    testOk1(dbuf[4]==42.0);
+
+    dbGetConvertRoutine[DBF_SHORT][DBR_DOUBLE](&addr, dbuf, s_input_len, s_input_len, 0);
+    for(i=0; i<s_input_len; i++)
+        if(dbuf[i]!=s_input[i])
+            break;
+    testOk(i==s_input_len, "entire array, first mismatch at %ld", i);
+
+    testDiag("Test dbPutConvertRoutine[DBR_DOUBLE][DBF_SHORT]");
+
+    for(i=0; i<s_input_len; i++)
+        dbuf[i] = 10.0*i;
+    memset(sbuf, 0, sizeof(sbuf));
+    addr.pfield = sbuf;
+
+    dbPutConvertRoutine[DBR_DOUBLE][DBF_SHORT](&addr, dbuf, 4, s_input_len, 5);
+    testOk(sbuf[5]==0 && sbuf[6]==10, "before wrap %d %d", sbuf[5], sbuf[6]);
+    testOk(sbuf[0]==20 && sbuf[1]==30, "after wrap %d %d", sbuf[0], sbuf[1]);
+    testOk(sbuf[2]==0 && sbuf[4]==0, "untouched %d %d", sbuf[2], sbuf[4]);
+}
+
+static void testFastInline(void)
+{
+    static const epicsFloat64 d_input[] = {0.0, 1.5, 42.75, 255.0, 65535.25};
+    static const short dbfTypes[] = {DBF_CHAR, DBF_UCHAR, DBF_SHORT,
+        DBF_USHORT, DBF_LONG, DBF_ULONG, DBF_INT64, DBF_UINT64, DBF_FLOAT,
+        DBF_DOUBLE, DBF_ENUM, DBF_MENU, DBF_DEVICE};
+    DBADDR addr;
+    int nGet = 0, nPut = 0;
+    size_t i, j;
+
+    testDiag("Test inline dbFastGetConvert()/dbFastPutConvert()");
+
+    memset(&addr, 0, sizeof(addr));
+
+    for (i = 0; i < NELEMENTS(dbfTypes); i++) {
+        short dbfType = dbfTypes[i];
+        short dbrType = dbfType > DBF_ENUM ? DBR_ENUM : dbfType;
+
+        for (j = 0; j < NELEMENTS(d_input); j++) {
+            epicsUInt64 field = 0, inline1 = 0, table1 = 0;
+            epicsUInt64 inline2 = 0, table2 = 0;
+
+            /* DBR_DOUBLE -> field, then field -> DBR_DOUBLE and same type */
+            ((FASTCONVERTFUNC) dbFastPutConvertRoutine[DBR_DOUBLE][dbfType])
+                (&d_input[j], &table1, &addr);
+            dbFastPutConvert(DBR_DOUBLE, dbfType, &d_input[j], &inline1,
+                &addr);
+            nPut += memcmp(&inline1, &table1, sizeof(field)) == 0;
+
+            field = table1;
+            ((FASTCONVERTFUNC) dbFastGetConvertRoutine[dbfType][DBR_DOUBLE])
+                (&field, &table1, &addr);
+            dbFastGetConvert(dbfType, DBR_DOUBLE, &field, &inline1, &addr);
+            ((FASTCONVERTFUNC) dbFastGetConvertRoutine[dbfType][dbrType])
+                (&field, &table2, &addr);
+            dbFastGetConvert(dbfType, dbrType, &field, &inline2, &addr);
+            nGet += memcmp(&inline1, &table1, sizeof(field)) == 0 &&
+                memcmp(&inline2, &table2, sizeof(field)) == 0;
+        }
+    }
+    testOk(nPut == NELEMENTS(dbfTypes) * NELEMENTS(d_input),
+        "put results match table routines (%d)", nPut);
+    testOk(nGet == NELEMENTS(dbfTypes) * NELEMENTS(d_input),
+        "get results match table routines (%d)", nGet);
+}
+
 MAIN(testdbConvert)
 {
-    testPlan(15);
+    testPlan(24);
     testBasicGet();
     testBasicPut();
+    testConvertWrap();
+    testFastInline();
     return testDone();
 }
@@ -0,0 +1,180 @@
+#!/usr/bin/env perl
+
+use strict;
+use warnings;
+
+use if $^O eq 'MSWin32', "Win32::Process";
+use if $^O eq 'MSWin32', "Win32";
+
+use lib '@TOP@/lib/perl';
+
+use Test::More tests => 4;
+use EPICS::IOC;
+
+# Set to 1 to echo all IOC and client communications
+my $debug = 0;
+
+$ENV{HARNESS_ACTIVE} = 1 if scalar @ARGV && shift eq '-tap';
+
+# Keep traffic local and avoid duplicates over multiple interfaces
+$ENV{EPICS_CA_AUTO_ADDR_LIST} = 'NO';
+$ENV{EPICS_CA_ADDR_LIST} = 'localhost';
+$ENV{EPICS_CA_SERVER_PORT} = 55084;
+$ENV{EPICS_CAS_BEACON_PORT} = 55085;
+$ENV{EPICS_CAS_INTF_ADDR_LIST} = 'localhost';
+
+my $bin = '@TOP@/bin/@ARCH@';
+my $exe = ($^O =~ m/^(MSWin32|cygwin)$/x) ? '.exe' : '';
+my $prefix = "test-$$";
+
+my $ioc = EPICS::IOC->new();
+$ioc->debug($debug);
+
+$SIG{__DIE__} = $SIG{INT} = $SIG{QUIT} = sub {
+    $ioc->exit;
+    BAIL_OUT("Caught signal: $_[0]");
+};
+
+
+# Watchdog utilities
+
+sub kill_bail {
+    my $doing = shift;
+    return sub {
+        $ioc->exit;
+        BAIL_OUT("Timeout $doing");
+    }
+}
+
+sub watchdog (&$$) {
+    my ($code, $timeout, $fail) = @_;
+    my $bark = "Woof $$\n";
+    my $result;
+    eval {
+        local $SIG{__DIE__};
+        local $SIG{ALRM} = sub { die $bark };
+        alarm $timeout;
+        $result = &$code;
+        alarm 0;
+    };
+    if ($@) {
+        die if $@ ne $bark;
+        $result = &$fail;
+    }
+    return $result;
+}
+
+
+# Start the IOC with a byte rate budget for each CA client
+
+my $softIoc = "$bin/softIoc$exe";
+BAIL_OUT("Can't find a softIoc executable")
+    unless -x $softIoc;
+
+# A DBR_TIME_DOUBLE update is 40 bytes, so 80 bytes/sec allows 2 of the
+# 10 updates per second, plus one second's worth at the start
+my $rate = 80;
+
+watchdog {
+    $ioc->start($softIoc);
+    $ioc->cmd;  # Wait for command prompt
+    $ioc->cmd('var', 'rsrvClientByteRate', $rate);
+    $ioc->dbLoadRecords('../caRateLimit.db', "P=$prefix");
+    $ioc->iocInit;
+} 10, kill_bail('starting softIoc');
+
+my $pv = "$prefix:count";
+my $camonitor = "$bin/camonitor$exe";
+
+# Count the updates a client receives in $secs seconds
+sub updates {
+    my $secs = shift;
+    my $text = qx_for($secs, "$camonitor -w5 $pv");
+    return 0 unless defined $text;
+    return scalar grep(m/^ \Q$pv\E \s/x, split /\n/, $text);
+}
+
+SKIP: {
+    skip "camonitor not available", 4
+        unless -x $camonitor;
+
+    my $limited = updates(4);
+    note("Got $limited updates in 4 seconds at $rate bytes/sec");
+    cmp_ok($limited, '>=', 4, 'Updates keep arriving over budget');
+    cmp_ok($limited, '<=', 16, 'Budget limited the updates');
+
+    watchdog {
+        $ioc->cmd('var', 'rsrvClientByteRate', 0);
+    } 10, kill_bail('clearing rsrvClientByteRate');
+
+    my $unlimited = updates(4);
+    note("Got $unlimited updates in 4 seconds without a budget");
+    cmp_ok($unlimited, '>=', 30, 'All updates arrive without a budget');
+    cmp_ok($unlimited, '>', $limited + 10, 'Budget made the difference');
+}
+
+$ioc->exit;
+
+
+# Process timeout utilities
+
+sub system_timeout {
+    my ($timeout, $cmdline) = @_;
+    my $status;
+    if ($^O eq 'MSWin32') {
+        my $proc;
+        (my $app) = split ' ', $cmdline;
+        if (! Win32::Process::Create($proc, $app, $cmdline,
+            1, &Win32::Process::NORMAL_PRIORITY_CLASS, '.')) {
+            my $err = Win32::FormatMessage(Win32::GetLastError());
+            die "Can't create Process for '$cmdline': $err\n";
+        }
+        if (! $proc->Wait(1000 * $timeout)) {
+            $proc->Kill(1);
+            note("Timed out '$cmdline' after $timeout seconds\n");
+        }
+        my $status;
+        $proc->GetExitCode($status);
+        return $status;
+    }
+    else {
+        my $pid;
+        $status = watchdog {
+            $pid = fork();
+            die "Can't fork: $!\n"
+                unless defined $pid;
+            exec $cmdline
+                or die "Can't exec: $!\n"
+                unless $pid;
+            waitpid $pid, 0;
+            return $? >> 8;
+        } $timeout, sub {
+            kill 9, $pid if $pid;
+            note("Timed out '$cmdline' after $timeout seconds\n");
+            return -2;
+        };
+    }
+    return $status;
+}
+
+# Returns what a command printed, stopping it after $timeout seconds
+sub qx_for {
+    my ($timeout, $cmdline) = @_;
+    open(my $stdout, '>&STDOUT')
+        or die "Can't save STDOUT: $!\n";
+    my $outfile = "stdout-$$.txt";
+    unlink $outfile;
+    open STDOUT, '>', $outfile;
+    my $text;
+    system_timeout($timeout, $cmdline);
+    if (-r $outfile) {
+        open(my $file, '<', $outfile)
+            or die "Can't open $outfile: $!\n";
+        $text = join '', <$file>;
+        close $file;
+    }
+    open(STDOUT, '>&', $stdout)
+        or die "Can't restore STDOUT: $!\n";
+    unlink $outfile;
+    return $text;
+}